@@ -0,0 +1,209 @@
+#ifndef ESA_BENCH_H
+#define ESA_BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "esa_perf.h"
+
+
+/**
+ * @brief Minimal host benchmark harness for ESA (no external dependencies).
+ * Results are written as JSON, one object per benchmark case.
+ * 
+ */
+namespace bench
+{
+    using clock = std::chrono::steady_clock;
+
+
+    /**
+     * @brief Prevent the compiler from optimizing away a value.
+     * 
+     */
+    template<typename Type>
+    inline void keep(Type & value)
+    {
+        asm volatile("" : : "r"(&value) : "memory");
+    }
+
+
+    /**
+     * @brief Command line options shared by all benchmark executables.
+     * 
+     */
+    struct options
+    {
+        uint32_t max_entities = 65535;
+        uint32_t max_updaters = 32;
+        uint32_t repeat = 5;
+        double budget = 4e9; // maximum work units for cases with quadratic cost
+        std::string filter;
+        std::string out;
+        bool perf = false; // also read the hardware counters (Linux only)
+
+        /**
+         * @brief Read the options from the command line. `extra` lists the options of the program
+         * itself (e.g. `bench::parameters::usage()`), shown in the usage message.
+         * 
+         */
+        void parse(int argc, char ** argv, const std::string & extra = "")
+        {
+            for (int i = 1; i < argc; i++)
+            {
+                std::string arg = argv[i];
+                const char * value = i + 1 < argc ? argv[i + 1] : "";
+                if (arg == "--max-entities")
+                    max_entities = std::strtoul(value, nullptr, 10), i++;
+                else if (arg == "--max-updaters")
+                    max_updaters = std::strtoul(value, nullptr, 10), i++;
+                else if (arg == "--repeat")
+                    repeat = std::max(1ul, std::strtoul(value, nullptr, 10)), i++;
+                else if (arg == "--budget")
+                    budget = std::strtod(value, nullptr), i++;
+                else if (arg == "--filter")
+                    filter = value, i++;
+                else if (arg == "--out")
+                    out = value, i++;
+                else if (arg == "--perf")
+                    perf = true;
+                else
+                {
+                    std::fprintf(stderr, "usage: %s%s [--max-entities N] [--max-updaters N] [--repeat N] "
+                        "[--budget WORK] [--filter CASE] [--out FILE] [--perf]\n", argv[0], extra.c_str());
+                    std::exit(arg == "--help" ? 0 : 1);
+                }
+            }
+        }
+
+        [[nodiscard]] bool selected(const char * name) const
+        {
+            return filter.empty() || std::strstr(name, filter.c_str()) != nullptr;
+        }
+    };
+
+
+    /**
+     * @brief Timings of one benchmark case.
+     * 
+     */
+    struct result
+    {
+        std::string name;
+        uint32_t entities = 0;
+        uint32_t updaters = 0;
+        uint64_t ops = 0;
+        std::vector<double> samples; // nanoseconds per sample
+        std::string skipped;
+        perf_sample counters; // hardware counters for `ops` operations (with `--perf`)
+    };
+
+
+    /**
+     * @brief Time a function, in nanoseconds.
+     * 
+     */
+    template<typename Function>
+    [[nodiscard]] double time_ns(Function && f)
+    {
+        clock::time_point start = clock::now();
+        f();
+        return std::chrono::duration<double, std::nano>(clock::now() - start).count();
+    }
+
+
+    /**
+     * @brief Returns a percentile (`0`...`1`) of a set of samples.
+     * 
+     */
+    [[nodiscard]] inline double percentile(std::vector<double> v, double p)
+    {
+        if (v.empty())
+            return 0;
+        std::sort(v.begin(), v.end());
+        size_t i = static_cast<size_t>(p * (v.size() - 1) + 0.5);
+        return v[std::min(i, v.size() - 1)];
+    }
+
+
+    /**
+     * @brief Writes results as a JSON document.
+     * 
+     */
+    class json_writer
+    {
+        FILE * _file;
+        bool _first;
+
+        public:
+
+        json_writer(const options & opt, const char * suite)
+        {
+            _file = opt.out.empty() ? stdout : std::fopen(opt.out.c_str(), "w");
+            if (_file == nullptr)
+            {
+                std::fprintf(stderr, "cannot open %s\n", opt.out.c_str());
+                std::exit(1);
+            }
+            _first = true;
+            std::fprintf(_file, "{\n  \"suite\": \"%s\",\n  \"compiler\": \"%s\",\n  \"repeat\": %u,\n",
+                suite, __VERSION__, opt.repeat);
+            if (opt.perf)
+                std::fprintf(_file, "  \"perf\": \"%s\",\n", perf().status().c_str());
+            std::fprintf(_file, "  \"results\": [");
+        }
+
+        /**
+         * @brief Write a result. Extra fields can be appended as a JSON fragment (`"key": value, ...`).
+         * 
+         */
+        void write(const result & r, const std::string & extra = "")
+        {
+            std::fprintf(_file, "%s\n    { \"case\": \"%s\", \"entities\": %u, \"updaters\": %u",
+                _first ? "" : ",", r.name.c_str(), r.entities, r.updaters);
+            _first = false;
+            if (!r.skipped.empty() || r.samples.empty())
+            {
+                std::fprintf(_file, ", \"skipped\": \"%s\" }", r.skipped.c_str());
+                return;
+            }
+            double ops = r.ops > 0 ? static_cast<double>(r.ops) : 1.0;
+            double min = *std::min_element(r.samples.begin(), r.samples.end());
+            std::fprintf(_file, ", \"ops\": %llu, \"ns_per_op_min\": %.3f, \"ns_per_op_median\": %.3f, \"ns_per_op_max\": %.3f",
+                static_cast<unsigned long long>(r.ops), min / ops, percentile(r.samples, 0.5) / ops,
+                *std::max_element(r.samples.begin(), r.samples.end()) / ops);
+            if (r.counters.any())
+                std::fprintf(_file, ", %s", r.counters.json(ops, "per_op").c_str());
+            if (!extra.empty())
+                std::fprintf(_file, ", %s", extra.c_str());
+            std::fprintf(_file, " }");
+            std::fflush(_file);
+        }
+
+        /**
+         * @brief Write an object that is not a timed result (`"key": value, ...`).
+         * 
+         */
+        void write_raw(const char * name, const std::string & fields)
+        {
+            std::fprintf(_file, "%s\n    { \"case\": \"%s\", %s }", _first ? "" : ",", name, fields.c_str());
+            _first = false;
+            std::fflush(_file);
+        }
+
+        ~json_writer()
+        {
+            std::fprintf(_file, "\n  ]\n}\n");
+            if (_file != stdout)
+                std::fclose(_file);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,330 @@
+#ifndef ESA_PERF_H
+#define ESA_PERF_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#ifdef __linux__
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+
+/**
+ * @brief Hardware performance counters (Linux `perf_event_open`): cycles, instructions,
+ * L1 data cache misses, last level cache misses and branch misses.
+ * When the counters are not available (other OS, virtual machine, `perf_event_paranoid`, ...)
+ * nothing is measured and the benchmarks only report timings.
+ * 
+ */
+namespace bench
+{
+    /**
+     * @brief The counters, in the order used by `perf_sample`.
+     * 
+     */
+    enum perf_counter_id
+    {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_MISSES,
+        LLC_MISSES,
+        BRANCH_MISSES,
+        PERF_COUNTERS
+    };
+
+
+    /**
+     * @brief Names of the counters, as written in the JSON results.
+     * 
+     */
+    inline const char * perf_name(uint32_t id)
+    {
+        static const char * names[PERF_COUNTERS] = { "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses" };
+        return names[id];
+    }
+
+
+    /**
+     * @brief Values of the counters. Counters that could not be opened are not valid.
+     * 
+     */
+    struct perf_sample
+    {
+        bool valid[PERF_COUNTERS] = {};
+        double value[PERF_COUNTERS] = {};
+
+        [[nodiscard]] bool any() const
+        {
+            for (uint32_t i = 0; i < PERF_COUNTERS; i++)
+            {
+                if (valid[i])
+                    return true;
+            }
+            return false;
+        }
+
+        /**
+         * @brief The valid counters divided by `per`, as a JSON fragment (`"cycles_per_op": ..., ...`).
+         * 
+         */
+        [[nodiscard]] std::string json(double per, const char * suffix) const
+        {
+            std::string s;
+            char buffer[96];
+            for (uint32_t i = 0; i < PERF_COUNTERS; i++)
+            {
+                if (!valid[i])
+                    continue;
+                std::snprintf(buffer, sizeof(buffer), "%s\"%s_%s\": %.3f", s.empty() ? "" : ", ", perf_name(i), suffix,
+                    per > 0 ? value[i] / per : value[i]);
+                s += buffer;
+            }
+            return s;
+        }
+    };
+
+
+#ifdef __linux__
+    /**
+     * @brief Open a counter for the calling thread (user space only).
+     * 
+     * @param id The counter.
+     * @param group The file descriptor of the group leader, or `-1` to open a leader.
+     * @return int The file descriptor, or `-1` if the counter is not available.
+     */
+    inline int perf_open(uint32_t id, int group)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        switch (id)
+        {
+            case CYCLES:
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case INSTRUCTIONS:
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case L1D_MISSES:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                break;
+            case LLC_MISSES:
+                attr.config = PERF_COUNT_HW_CACHE_MISSES;
+                break;
+            default:
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+        }
+        attr.disabled = group == -1 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return int(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+    }
+#endif
+
+
+    /**
+     * @brief A group of counters, read together around a piece of code.
+     * Counters that are not supported by the machine are left out of the group.
+     * 
+     */
+    class perf_group
+    {
+        int _fds[PERF_COUNTERS];
+        int _leader = -1;
+        uint32_t _order[PERF_COUNTERS]; // counter of each value read from the group
+        uint32_t _members = 0;
+        std::string _status;
+
+        public:
+
+        perf_group()
+        {
+            for (uint32_t i = 0; i < PERF_COUNTERS; i++)
+                _fds[i] = -1;
+#ifdef __linux__
+            for (uint32_t i = 0; i < PERF_COUNTERS; i++)
+            {
+                _fds[i] = perf_open(i, _leader);
+                if (_fds[i] == -1)
+                    continue;
+                if (_leader == -1)
+                    _leader = _fds[i];
+                _order[_members++] = i;
+                _status += _status.empty() ? perf_name(i) : std::string(" ") + perf_name(i);
+            }
+            if (_leader == -1)
+                _status = std::string("unavailable (") + std::strerror(errno) + ")";
+#else
+            _status = "unavailable (perf_event_open requires Linux)";
+#endif
+        }
+
+        perf_group(const perf_group &) = delete;
+        perf_group & operator=(const perf_group &) = delete;
+
+        ~perf_group()
+        {
+#ifdef __linux__
+            for (uint32_t i = 0; i < PERF_COUNTERS; i++)
+            {
+                if (_fds[i] != -1)
+                    close(_fds[i]);
+            }
+#endif
+        }
+
+        /**
+         * @brief Tells if at least one counter is available.
+         * 
+         */
+        [[nodiscard]] bool available() const
+        {
+            return _leader != -1;
+        }
+
+        /**
+         * @brief The counters in the group, or the reason why there are none.
+         * 
+         */
+        [[nodiscard]] const std::string & status() const
+        {
+            return _status;
+        }
+
+        /**
+         * @brief Reset and start the counters.
+         * 
+         */
+        void start()
+        {
+#ifdef __linux__
+            if (_leader == -1)
+                return;
+            ioctl(_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+        }
+
+        /**
+         * @brief Stop the counters and read them. Values are scaled if the counters were multiplexed.
+         * 
+         */
+        [[nodiscard]] perf_sample stop()
+        {
+            perf_sample s;
+#ifdef __linux__
+            if (_leader == -1)
+                return s;
+            ioctl(_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            uint64_t data[3 + PERF_COUNTERS];
+            if (read(_leader, data, sizeof(data)) < ssize_t(3 * sizeof(uint64_t)) || data[2] == 0)
+                return s;
+            double scale = double(data[1]) / double(data[2]);
+            for (uint32_t i = 0; i < data[0] && i < _members; i++)
+            {
+                s.valid[_order[i]] = true;
+                s.value[_order[i]] = double(data[3 + i]) * scale;
+            }
+#endif
+            return s;
+        }
+    };
+
+
+    /**
+     * @brief The group of counters shared by the benchmark cases.
+     * 
+     */
+    inline perf_group & perf()
+    {
+        static perf_group group;
+        return group;
+    }
+
+
+    /**
+     * @brief A single counter that is always running, used as the clock of ESA's profiler:
+     * the profiler then reports, for instance, the instructions executed by each updater.
+     * 
+     */
+    class perf_clock
+    {
+        int _fd = -1;
+
+        public:
+
+        explicit perf_clock(uint32_t id)
+        {
+#ifdef __linux__
+            _fd = perf_open(id, -1);
+            if (_fd != -1)
+                ioctl(_fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+        }
+
+        perf_clock(const perf_clock &) = delete;
+        perf_clock & operator=(const perf_clock &) = delete;
+
+        ~perf_clock()
+        {
+#ifdef __linux__
+            if (_fd != -1)
+                close(_fd);
+#endif
+        }
+
+        [[nodiscard]] bool available() const
+        {
+            return _fd != -1;
+        }
+
+        /**
+         * @brief The current value of the counter (truncated to 32 bits, as ESA's clocks).
+         * 
+         */
+        [[nodiscard]] uint32_t now() const
+        {
+#ifdef __linux__
+            uint64_t data[4] = {};
+            if (_fd != -1 && read(_fd, data, sizeof(data)) >= ssize_t(4 * sizeof(uint64_t)))
+                return uint32_t(data[3]);
+#endif
+            return 0;
+        }
+    };
+
+
+    /**
+     * @brief The running counter of each kind, opened on first use.
+     * 
+     */
+    template<uint32_t Id>
+    perf_clock & perf_clock_of()
+    {
+        static perf_clock clock(Id);
+        return clock;
+    }
+
+
+    /**
+     * @brief Clock functions for ESA's profiler (`esa::clock_fn`), one for each counter.
+     * 
+     */
+    template<uint32_t Id>
+    uint32_t perf_clock_fn()
+    {
+        return perf_clock_of<Id>().now();
+    }
+}
+
+#endif
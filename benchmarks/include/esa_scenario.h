@@ -0,0 +1,238 @@
+#ifndef ESA_SCENARIO_H
+#define ESA_SCENARIO_H
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "esa.h"
+#include "esa_bench.h"
+
+
+/**
+ * @brief Helpers for the headless scenario benchmarks: run a game loop for
+ * a number of frames and report frames per second, per-frame percentiles
+ * and memory.
+ * 
+ */
+namespace bench
+{
+    /**
+     * @brief Scenario parameters, given on the command line as `--name value`.
+     * 
+     */
+    class parameters
+    {
+        std::vector<std::pair<std::string, uint32_t>> _values;
+        std::string _usage;
+
+        public:
+
+        /**
+         * @brief Declare a parameter with its default value, and read it from the command line.
+         * The parameter is removed from `argv`, so that the remaining options can be parsed by `bench::options`.
+         * 
+         */
+        uint32_t get(int & argc, char ** argv, const char * name, uint32_t fallback)
+        {
+            uint32_t value = fallback;
+            std::string option = std::string("--") + name;
+            for (int i = 1; i + 1 < argc; i++)
+            {
+                if (option == argv[i])
+                {
+                    value = std::strtoul(argv[i + 1], nullptr, 10);
+                    for (int j = i; j + 2 <= argc; j++)
+                        argv[j] = argv[j + 2];
+                    argc -= 2;
+                    break;
+                }
+            }
+            _values.push_back({ name, value });
+            _usage += std::string(" [--") + name + " N (" + std::to_string(fallback) + ")]";
+            return value;
+        }
+
+        /**
+         * @brief The declared parameters and their default values, for the usage message of `bench::options`.
+         * 
+         */
+        [[nodiscard]] const std::string & usage() const
+        {
+            return _usage;
+        }
+
+        /**
+         * @brief Parameters as a JSON fragment.
+         * 
+         */
+        [[nodiscard]] std::string json() const
+        {
+            std::string s = "\"parameters\": {";
+            for (size_t i = 0; i < _values.size(); i++)
+                s += (i ? ", \"" : " \"") + _values[i].first + "\": " + std::to_string(_values[i].second);
+            return s + " }";
+        }
+    };
+
+
+    /**
+     * @brief Peak resident memory of the whole process since it started, in kilobytes. It never goes down,
+     * so it covers all the runs before the current one (and the benchmark harness itself).
+     * 
+     */
+    [[nodiscard]] inline long process_peak_memory_kb()
+    {
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+
+
+    /**
+     * @brief Current resident memory of the process, in kilobytes, or `-1` where it cannot be read (Linux only).
+     * 
+     */
+    [[nodiscard]] inline long resident_memory_kb()
+    {
+#ifdef __linux__
+        long pages = -1;
+        long resident = -1;
+        std::FILE * f = std::fopen("/proc/self/statm", "r");
+        if (f == nullptr)
+            return -1;
+        int read = std::fscanf(f, "%ld %ld", &pages, &resident);
+        std::fclose(f);
+        return read == 2 ? resident * (sysconf(_SC_PAGESIZE) / 1024) : -1;
+#else
+        return -1;
+#endif
+    }
+
+
+#ifdef ESA_PROFILER
+    /**
+     * @brief Run the scenario once for each hardware counter, using the counter as the clock of
+     * the table's profiler, and write the counters of each updater per entity processed
+     * (per call for updaters without entities). The state must have a `table` member.
+     * 
+     */
+    template<typename Setup, typename Frame>
+    void profile_updaters(json_writer & out, const char * name, uint32_t frames, Setup & setup, Frame & frame)
+    {
+        static const esa::clock_fn clocks[PERF_COUNTERS] = { &perf_clock_fn<CYCLES>, &perf_clock_fn<INSTRUCTIONS>,
+            &perf_clock_fn<L1D_MISSES>, &perf_clock_fn<LLC_MISSES>, &perf_clock_fn<BRANCH_MISSES> };
+        const bool available[PERF_COUNTERS] = { perf_clock_of<CYCLES>().available(), perf_clock_of<INSTRUCTIONS>().available(),
+            perf_clock_of<L1D_MISSES>().available(), perf_clock_of<LLC_MISSES>().available(), perf_clock_of<BRANCH_MISSES>().available() };
+
+        std::vector<esa::tag_t> tags;
+        std::vector<perf_sample> samples;
+        std::vector<double> visits, calls;
+        bool first = true; // entities and calls are counted during the first run
+        for (uint32_t c = 0; c < PERF_COUNTERS; c++)
+        {
+            if (!available[c])
+                continue;
+            auto state = setup();
+            auto & profiler = state->table.profiler();
+            profiler.set_clock(clocks[c]);
+            std::vector<uint32_t> previous;
+            for (uint32_t i = 0; i < frames; i++)
+            {
+                frame(*state, i);
+                for (uint32_t s = 0; s < profiler.size(); s++)
+                {
+                    if (s >= tags.size())
+                    {
+                        tags.push_back(profiler.tag(s));
+                        samples.emplace_back();
+                        visits.push_back(0);
+                        calls.push_back(0);
+                    }
+                    if (s >= previous.size())
+                        previous.push_back(0);
+                    auto & updater = profiler.updater(tags[s]);
+                    uint32_t ran = updater.total_calls() - previous[s];
+                    previous[s] = updater.total_calls();
+                    if (first)
+                    {
+                        visits[s] += double(ran) * profiler.subscribed(tags[s]);
+                        calls[s] += ran;
+                    }
+                }
+            }
+            for (uint32_t s = 0; s < tags.size() && s < profiler.size(); s++)
+            {
+                samples[s].valid[c] = true;
+                samples[s].value[c] = double(profiler.updater(tags[s]).total());
+            }
+            first = false;
+        }
+        std::string updater_case = std::string(name) + "_updater";
+        for (uint32_t s = 0; s < tags.size(); s++)
+        {
+            bool per_entity = visits[s] > 0;
+            out.write_raw(updater_case.c_str(), "\"tag\": " + std::to_string(tags[s]) +
+                ", \"calls\": " + std::to_string(uint64_t(calls[s])) +
+                ", \"entities\": " + std::to_string(uint64_t(visits[s])) + ", " +
+                samples[s].json(per_entity ? visits[s] : calls[s], per_entity ? "per_entity" : "per_call"));
+        }
+    }
+#endif
+
+
+    /**
+     * @brief Run `frame(i)` for `frames` frames, `repeat` times, and write one result per run.
+     * 
+     */
+    template<typename Setup, typename Frame>
+    void run_scenario(const options & opt, json_writer & out, const char * name, const parameters & params,
+        uint32_t frames, Setup && setup, Frame && frame)
+    {
+        for (uint32_t run = 0; run < opt.repeat; run++)
+        {
+            long resident = resident_memory_kb();
+            auto state = setup();
+            result r;
+            r.name = name;
+            r.ops = 1;
+            r.samples.reserve(frames);
+            uint32_t peak_entities = 0;
+            double total = 0;
+            double entity_frames = 0;
+            bool counting = opt.perf && perf().available();
+            if (counting)
+                perf().start();
+            for (uint32_t i = 0; i < frames; i++)
+            {
+                uint32_t entities = 0;
+                double ns = time_ns([&]() { entities = frame(*state, i); });
+                r.samples.push_back(ns);
+                total += ns;
+                entity_frames += entities;
+                peak_entities = std::max(peak_entities, entities);
+            }
+            std::string counters;
+            if (counting)
+                counters = perf().stop().json(entity_frames, "per_entity") + ", ";
+            r.entities = peak_entities;
+            long run_memory = resident >= 0 ? resident_memory_kb() - resident : -1;
+            char extra[512];
+            std::snprintf(extra, sizeof(extra), 
+                "\"run\": %u, \"frames\": %u, \"fps\": %.1f, \"frame_ns_p50\": %.0f, \"frame_ns_p90\": %.0f, "
+                "\"frame_ns_p99\": %.0f, \"frame_ns_max\": %.0f, \"run_memory_kb\": %ld, \"process_peak_memory_kb\": %ld, ",
+                run, frames, frames / (total * 1e-9), percentile(r.samples, 0.5), percentile(r.samples, 0.9),
+                percentile(r.samples, 0.99), percentile(r.samples, 1.0), run_memory, process_peak_memory_kb());
+            out.write(r, extra + counters + params.json());
+        }
+#ifdef ESA_PROFILER
+        if (opt.perf)
+            profile_updaters(out, name, frames, setup, frame);
+#endif
+    }
+}
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef STUB_BN_H
+#define STUB_BN_H
+
+#include <cmath>
+#include <cstdint>
+
+
+/**
+ * @brief Minimal stand-ins for the butano types used by the examples
+ * (fixed point numbers, sprites, trigonometry, random numbers), so that
+ * the example scenarios can run headless on the host.
+ * 
+ */
+namespace stub
+{
+    /**
+     * @brief Fixed point number with 12 fractional bits, like `bn::fixed`.
+     * 
+     */
+    class fixed
+    {
+        int _data;
+
+        public:
+
+        constexpr fixed() : _data(0) { }
+        constexpr fixed(int value) : _data(value * 4096) { }
+        constexpr fixed(double value) : _data(int(value * 4096)) { }
+
+        [[nodiscard]] static constexpr fixed from_data(int data)
+        {
+            fixed f;
+            f._data = data;
+            return f;
+        }
+
+        [[nodiscard]] constexpr int data() const { return _data; }
+        [[nodiscard]] constexpr int integer() const { return _data / 4096; }
+
+        constexpr fixed operator-() const { return from_data(-_data); }
+        constexpr fixed operator+(fixed o) const { return from_data(_data + o._data); }
+        constexpr fixed operator-(fixed o) const { return from_data(_data - o._data); }
+        constexpr fixed operator*(fixed o) const { return from_data(int((int64_t(_data) * o._data) >> 12)); }
+        constexpr fixed operator/(fixed o) const { return from_data(int((int64_t(_data) << 12) / o._data)); }
+        constexpr fixed & operator+=(fixed o) { _data += o._data; return *this; }
+        constexpr fixed & operator-=(fixed o) { _data -= o._data; return *this; }
+        constexpr fixed & operator*=(fixed o) { *this = *this * o; return *this; }
+        constexpr bool operator<(fixed o) const { return _data < o._data; }
+        constexpr bool operator>(fixed o) const { return _data > o._data; }
+        constexpr bool operator<=(fixed o) const { return _data <= o._data; }
+        constexpr bool operator>=(fixed o) const { return _data >= o._data; }
+        constexpr bool operator==(fixed o) const { return _data == o._data; }
+    };
+
+
+    /**
+     * @brief A sprite handle: it only stores its attributes, and counts the live sprites.
+     * 
+     */
+    class sprite_ptr
+    {
+        fixed _x, _y, _scale;
+        int _angle = 0;
+        int _tiles = 0;
+
+        public:
+
+        inline static int live = 0;
+
+        sprite_ptr(fixed x, fixed y) : _x(x), _y(y), _scale(1) { live++; }
+        sprite_ptr(const sprite_ptr & o) : _x(o._x), _y(o._y), _scale(o._scale), _angle(o._angle), _tiles(o._tiles) { live++; }
+        sprite_ptr & operator=(const sprite_ptr & o) = default;
+        ~sprite_ptr() { live--; }
+
+        [[nodiscard]] fixed x() const { return _x; }
+        [[nodiscard]] fixed y() const { return _y; }
+        [[nodiscard]] fixed vertical_scale() const { return _scale; }
+        void set_x(fixed x) { _x = x; }
+        void set_y(fixed y) { _y = y; }
+        void set_scale(fixed scale) { _scale = scale; }
+        void set_rotation_angle(int angle) { _angle = angle; }
+        void set_tiles(int tiles) { _tiles = tiles; }
+    };
+
+
+    /**
+     * @brief Sine of an angle in degrees, from a lookup table (like butano's).
+     * 
+     */
+    [[nodiscard]] inline fixed degrees_sin(fixed degrees)
+    {
+        static int lut[4096];
+        static bool ready = false;
+        if (!ready)
+        {
+            for (int i = 0; i < 4096; i++)
+                lut[i] = int(std::sin(i * 2 * M_PI / 4096) * 4096);
+            ready = true;
+        }
+        int i = int((int64_t(degrees.data()) * 4096 / (360 * 4096)) & 4095);
+        return fixed::from_data(lut[i]);
+    }
+
+
+    [[nodiscard]] inline fixed degrees_cos(fixed degrees)
+    {
+        return degrees_sin(degrees + 90);
+    }
+
+
+    /**
+     * @brief Deterministic xorshift random number generator.
+     * 
+     */
+    class random
+    {
+        uint32_t _state = 2463534242u;
+
+        public:
+
+        [[nodiscard]] uint32_t get()
+        {
+            _state ^= _state << 13;
+            _state ^= _state >> 17;
+            _state ^= _state << 5;
+            return _state;
+        }
+
+        [[nodiscard]] int get_int(int limit) { return int(get() % uint32_t(limit)); }
+        [[nodiscard]] int get_int(int min, int limit) { return min + get_int(limit - min); }
+        [[nodiscard]] fixed get_fixed(int min, int limit) { return fixed::from_data(min * 4096 + get_int((limit - min) * 4096)); }
+    };
+}
+
+#endif
@@ -0,0 +1,404 @@
+#include <memory>
+
+#include "esa.h"
+#include "esa_bench.h"
+
+
+/**
+ * @brief Micro benchmarks for every ESA container and table operation.
+ * Each case is run for table sizes from 32 to 65535 entities and 1 to 32 updaters.
+ * 
+ */
+namespace
+{
+    constexpr esa::tag_t POSITION = 0;
+    constexpr esa::tag_t QUERY = 0;
+    constexpr esa::tag_t APPLY = 0;
+
+    struct position
+    {
+        int x, y;
+    };
+
+
+    template<uint32_t N>
+    using table_t = esa::entity_table<N, 2, 32, 1, 1>;
+
+
+    template<uint32_t N>
+    class u_sum : public esa::entity_updater<N>
+    {
+        esa::series<position, N> & positions;
+
+        public:
+
+        int sum = 0;
+
+        u_sum(table_t<N> & t, esa::tag_t tag) : 
+            esa::entity_updater<N>(tag),
+            positions(t.template get_series<position, POSITION>())
+        { }
+
+        bool select(esa::entity e) override
+        {
+            return true;
+        }
+
+        void update() override
+        {
+            for (esa::entity e : this->subscribed())
+                sum += positions[e].x;
+            bench::keep(sum);
+        }
+    };
+
+
+    template<uint32_t N>
+    class q_even : public esa::cached_query<N>
+    {
+        esa::series<position, N> & positions;
+
+        public:
+
+        q_even(table_t<N> & t) : 
+            esa::cached_query<N>(QUERY),
+            positions(t.template get_series<position, POSITION>())
+        { }
+
+        bool select(esa::entity e) override
+        {
+            return true;
+        }
+
+        bool where(esa::entity e) override
+        {
+            return (positions[e].x & 1) == 0;
+        }
+    };
+
+
+    template<uint32_t N>
+    class a_move : public esa::cached_apply<N>
+    {
+        esa::series<position, N> & positions;
+
+        public:
+
+        a_move(table_t<N> & t) : 
+            esa::cached_apply<N>(APPLY),
+            positions(t.template get_series<position, POSITION>())
+        { }
+
+        bool select(esa::entity e) override
+        {
+            return true;
+        }
+
+        bool apply(esa::entity e) override
+        {
+            positions[e].x++;
+            return false;
+        }
+    };
+
+
+    template<uint32_t N>
+    bool f_even(table_t<N> & t, esa::entity e)
+    {
+        return (t.template get<position, POSITION>(e).x & 1) == 0;
+    }
+
+
+    template<uint32_t N>
+    bool f_move(table_t<N> & t, esa::entity e)
+    {
+        t.template get<position, POSITION>(e).x++;
+        return false;
+    }
+
+
+    /**
+     * @brief A table with `updaters` updaters, one cached query, one cached apply object
+     * and `entities` entities owning a position (optionally subscribed).
+     * 
+     */
+    template<uint32_t N>
+    struct fixture
+    {
+        table_t<N> table;
+
+        fixture(uint32_t updaters, uint32_t entities, bool subscribe)
+        {
+            table.template add_component<position>(POSITION);
+            for (uint32_t u = 0; u < updaters; u++)
+                table.add_updater(new u_sum<N>(table, u));
+            table.add_query(new q_even<N>(table));
+            table.add_apply(new a_move<N>(table));
+            table.init();
+            for (uint32_t i = 0; i < entities; i++)
+            {
+                esa::entity e = table.create();
+                table.template add<position, POSITION>(e, { int(i), int(i) });
+                if (subscribe)
+                    table.subscribe(e);
+            }
+        }
+    };
+
+
+    /**
+     * @brief Run a case `repeat` times: `setup` builds a fresh fixture (not timed), `run` is timed.
+     * 
+     */
+    template<typename Setup, typename Run>
+    bench::result measure(const bench::options & opt, const char * name, uint32_t entities, uint32_t updaters, 
+        uint64_t ops, Setup && setup, Run && run)
+    {
+        bench::result r;
+        r.name = name;
+        r.entities = entities;
+        r.updaters = updaters;
+        r.ops = ops;
+        for (uint32_t i = 0; i < opt.repeat; i++)
+        {
+            auto f = setup();
+            r.samples.push_back(bench::time_ns([&]() { run(*f); }));
+        }
+        if (opt.perf && bench::perf().available())
+        {
+            auto f = setup();
+            bench::perf().start();
+            run(*f);
+            r.counters = bench::perf().stop();
+        }
+        return r;
+    }
+
+
+    /**
+     * @brief Run a fast operation `repeat` times: each sample repeats the operation until it takes
+     * at least one millisecond. `ops` is the number of operations performed by a single call.
+     * 
+     */
+    template<typename Function>
+    bench::result measure_loop(const bench::options & opt, const char * name, uint32_t entities, uint32_t updaters, 
+        uint64_t ops, Function && loop)
+    {
+        auto repeated = [&](uint32_t iterations) 
+        { 
+            return bench::time_ns([&]() { for (uint32_t i = 0; i < iterations; i++) loop(); }); 
+        };
+        uint32_t iterations = 1;
+        while (iterations < (1u << 20) && repeated(iterations) < 1e6)
+            iterations *= 2;
+        bench::result r;
+        r.name = name;
+        r.entities = entities;
+        r.updaters = updaters;
+        r.ops = ops * iterations;
+        for (uint32_t i = 0; i < opt.repeat; i++)
+            r.samples.push_back(repeated(iterations));
+        if (opt.perf && bench::perf().available())
+        {
+            bench::perf().start();
+            for (uint32_t i = 0; i < iterations; i++)
+                loop();
+            r.counters = bench::perf().stop();
+        }
+        return r;
+    }
+
+
+    template<uint32_t N>
+    void run_size(const bench::options & opt, bench::json_writer & out)
+    {
+        if (N > opt.max_entities)
+            return;
+
+        auto fresh = [](uint32_t u, uint32_t n, bool s) { return std::make_unique<fixture<N>>(u, n, s); };
+
+        // operations that do not depend on the number of updaters
+        if (opt.selected("create"))
+            out.write(measure(opt, "create", N, 0, N, 
+                [&]() { return fresh(0, 0, false); },
+                [&](fixture<N> & f) 
+                { 
+                    for (uint32_t i = 0; i < N; i++)
+                    {
+                        esa::entity e = f.table.create();
+                        bench::keep(e);
+                    }
+                }));
+
+        if (opt.selected("get"))
+        {
+            auto f = fresh(0, N, false);
+            auto loop = [&]()
+            {
+                int sum = 0;
+                for (esa::entity e = 0; e < N; e++)
+                    sum += f->table.template get<position, POSITION>(e).x;
+                bench::keep(sum);
+            };
+            out.write(measure_loop(opt, "get", N, 0, uint64_t(N), loop));
+        }
+
+        if (opt.selected("series_index"))
+        {
+            auto f = fresh(0, N, false);
+            esa::series<position, N> & positions = f->table.template get_series<position, POSITION>();
+            auto loop = [&]()
+            {
+                int sum = 0;
+                for (esa::entity e = 0; e < N; e++)
+                    sum += positions[e].x;
+                bench::keep(sum);
+            };
+            out.write(measure_loop(opt, "series_index", N, 0, uint64_t(N), loop));
+        }
+
+        if (opt.selected("indexed_lookup"))
+        {
+            constexpr uint32_t S = N < 4096 ? N : 4096;
+            auto s = std::make_unique<esa::indexed_series<position, S>>();
+            for (uint32_t i = 0; i < S; i++)
+                s->add(esa::entity(N - 1 - i), { int(i), int(i) });
+            auto loop = [&]()
+            {
+                int sum = 0;
+                for (uint32_t i = 0; i < S; i++)
+                    sum += s->lookup(esa::entity(N - 1 - i)).x;
+                bench::keep(sum);
+            };
+            out.write(measure_loop(opt, "indexed_lookup", S, 0, uint64_t(S), loop));
+        }
+
+        if (opt.selected("function_query"))
+        {
+            auto f = fresh(0, N, false);
+            auto loop = [&]()
+            {
+                esa::vector<esa::entity, N> ids;
+                f->table.template query<N>(&f_even<N>, ids);
+                bench::keep(ids);
+            };
+            out.write(measure_loop(opt, "function_query", N, 0, uint64_t(N), loop));
+        }
+
+        if (opt.selected("function_apply"))
+        {
+            auto f = fresh(0, N, false);
+            auto loop = [&]() { f->table.apply(&f_move<N>); };
+            out.write(measure_loop(opt, "function_apply", N, 0, uint64_t(N), loop));
+        }
+
+        // operations that depend on the number of updaters
+        for (uint32_t U = 1; U <= opt.max_updaters && U <= 32; U *= (U == 1 ? 8 : 4))
+        {
+            // subscription and destruction are quadratic in the number of entities
+            bool affordable = double(N) * N * U / 2 <= opt.budget;
+            const char * skip = "quadratic cost exceeds --budget";
+
+            // cached queries and applys only depend on the subscribed entities
+            if (U == 1 && opt.selected("cached_query"))
+            {
+                if (!affordable)
+                    out.write({ "cached_query", N, U, 0, {}, skip });
+                else
+                {
+                    auto f = fresh(U, N, true);
+                    auto loop = [&]()
+                    {
+                        esa::vector<esa::entity, N> ids;
+                        f->table.template query<QUERY, N>(ids);
+                        bench::keep(ids);
+                    };
+                    out.write(measure_loop(opt, "cached_query", N, U, uint64_t(N), loop));
+                }
+            }
+
+            if (U == 1 && opt.selected("cached_apply"))
+            {
+                if (!affordable)
+                    out.write({ "cached_apply", N, U, 0, {}, skip });
+                else
+                {
+                    auto f = fresh(U, N, true);
+                    auto loop = [&]() { f->table.template apply<APPLY, N>(); };
+                    out.write(measure_loop(opt, "cached_apply", N, U, uint64_t(N), loop));
+                }
+            }
+
+            if (opt.selected("subscribe"))
+            {
+                if (!affordable)
+                    out.write({ "subscribe", N, U, 0, {}, skip });
+                else
+                    out.write(measure(opt, "subscribe", N, U, N, 
+                        [&]() { return fresh(U, N, false); },
+                        [&](fixture<N> & f) 
+                        { 
+                            for (esa::entity e = 0; e < N; e++)
+                                f.table.subscribe(e);
+                        }));
+            }
+
+            if (opt.selected("update"))
+            {
+                if (!affordable)
+                    out.write({ "update", N, U, 0, {}, skip });
+                else
+                {
+                    auto f = fresh(U, N, true);
+                    auto loop = [&]() { f->table.update(); };
+                    out.write(measure_loop(opt, "update", N, U, uint64_t(N) * U, loop));
+                }
+            }
+
+            if (opt.selected("destroy"))
+            {
+                if (!affordable)
+                    out.write({ "destroy", N, U, 0, {}, skip });
+                else
+                    out.write(measure(opt, "destroy", N, U, N, 
+                        [&]() { return fresh(U, N, true); },
+                        [&](fixture<N> & f) 
+                        { 
+                            for (esa::entity e = 0; e < N; e++)
+                                f.table.destroy(e);
+                            f.table.update(); // end-of-frame destruction
+                        }));
+            }
+
+            if (opt.selected("clear"))
+            {
+                if (!affordable)
+                    out.write({ "clear", N, U, 0, {}, skip });
+                else
+                    out.write(measure(opt, "clear", N, U, N, 
+                        [&]() { return fresh(U, N, true); },
+                        [&](fixture<N> & f) 
+                        { 
+                            f.table.clear();
+                            f.table.update();
+                        }));
+            }
+        }
+    }
+}
+
+
+int main(int argc, char ** argv)
+{
+    bench::options opt;
+    opt.parse(argc, argv);
+    bench::json_writer out(opt, "esa_micro");
+
+    run_size<32>(opt, out);
+    run_size<256>(opt, out);
+    run_size<2048>(opt, out);
+    run_size<16384>(opt, out);
+    run_size<65535>(opt, out);
+    
+    return 0;
+}
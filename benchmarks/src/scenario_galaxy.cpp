@@ -0,0 +1,286 @@
+#include <memory>
+#include <optional>
+
+#include "esa.h"
+#include "esa_scenario.h"
+#include "stub_bn.h"
+
+
+/**
+ * @brief Headless port of the `tiny-galaxy` example: galaxies made of black holes,
+ * stars, planets and moons, whose absolute positions are resolved through a scene graph.
+ * The number of galaxies and of bodies can be configured, and solar systems are
+ * periodically destroyed and spawned again to exercise the structural operations.
+ * 
+ */
+namespace tg
+{
+    constexpr uint32_t capacity = 4096;
+
+    using entity         = esa::entity;
+    using entity_table   = esa::entity_table<capacity, 4, 3, 0, 0>;
+    using entity_updater = esa::entity_updater<capacity>;
+    using table_updater  = esa::table_updater;
+    using fixed          = stub::fixed;
+
+    struct position
+    {
+        fixed x, y;
+    };
+
+    struct orbit
+    {
+        fixed distance, angle, v_angular;
+    };
+
+    using sprite = std::optional<stub::sprite_ptr>;
+
+    namespace tags
+    {
+        enum
+        {
+            POSITION = 0, ORBIT = 1, SPRITE = 2, PARENT = 3,
+            SCENEGRAPH = 0, UPDATE_ORBIT = 1, BACKGROUND = 2
+        };
+    }
+
+    /**
+     * @brief Shape of the generated galaxies.
+     * 
+     */
+    struct shape
+    {
+        uint32_t systems, planets, moon_chance;
+    };
+
+
+    class u_orbit : public entity_updater
+    {
+        entity_table & table;
+
+        public:
+
+        u_orbit(entity_table & t) : entity_updater(tags::UPDATE_ORBIT), table(t) { }
+
+        bool select(entity e) override
+        {
+            return table.has<tags::ORBIT>(e);
+        }
+
+        void update() override
+        {
+            for (entity e : this->subscribed())
+            {
+                position & pos = table.get<position, tags::POSITION>(e);
+                orbit & orb    = table.get<orbit, tags::ORBIT>(e);
+                if (orb.angle < 360)
+                    orb.angle += orb.v_angular;
+                else
+                    orb.angle = 0;
+                pos.x = orb.distance * stub::degrees_cos(orb.angle);
+                pos.y = orb.distance * stub::degrees_sin(orb.angle);
+            }
+        }
+    };
+
+
+    class u_scenegraph : public entity_updater
+    {
+        entity_table & table;
+
+        public:
+
+        u_scenegraph(entity_table & t) : entity_updater(tags::SCENEGRAPH), table(t) { }
+
+        bool select(entity e) override
+        {
+            return table.has<tags::PARENT>(e) && table.has<tags::POSITION>(e);
+        }
+
+        void update() override
+        {
+            for (entity e : this->subscribed())
+            {
+                position & pos = table.get<position, tags::POSITION>(e);
+                stub::sprite_ptr & spr = table.get<sprite, tags::SPRITE>(e).value();
+                entity parent = table.get<entity, tags::PARENT>(e);
+                fixed abs_x = pos.x;
+                fixed abs_y = pos.y;
+                while (true)
+                {
+                    position & parent_pos = table.get<position, tags::POSITION>(parent);
+                    abs_x += parent_pos.x;
+                    abs_y += parent_pos.y;
+                    if (!table.has<tags::PARENT>(parent))
+                        break;
+                    parent = table.get<entity, tags::PARENT>(parent);
+                    if (!table.has<tags::PARENT>(parent))
+                        break;
+                }
+                spr.set_x(abs_x);
+                spr.set_y(abs_y);
+            }
+        }
+    };
+
+
+    class u_background : public table_updater
+    {
+        position bg;
+
+        public:
+
+        u_background() : table_updater(tags::BACKGROUND) { }
+
+        void update() override
+        {
+            bg.x -= 0.05;
+            bg.y += 0.1;
+        }
+    };
+
+
+    entity body(entity_table & table, orbit orb, entity parent)
+    {
+        entity e = table.create();
+        table.add<position, tags::POSITION>(e, { 0, 0 });
+        table.add<orbit, tags::ORBIT>(e, orb);
+        table.add<entity, tags::PARENT>(e, parent);
+        table.add<sprite, tags::SPRITE>(e, stub::sprite_ptr(0, 0));
+        table.subscribe(e);
+        return e;
+    }
+
+
+    /**
+     * @brief Spawn a star with its planets and moons (same layout as the example).
+     * 
+     */
+    entity solar_system(entity_table & table, fixed angle, entity parent, const shape & s, stub::random & rnd)
+    {
+        entity star = body(table, { rnd.get_fixed(48, 120), angle, 0.1 }, parent);
+        fixed scale = fixed(1) / rnd.get_int(1, 3);
+        table.get<sprite, tags::SPRITE>(star).value().set_scale(scale);
+        for (uint32_t a = 0; a < s.planets; a++)
+        {
+            fixed distance = rnd.get_fixed(8, 16);
+            entity planet = body(table, { distance, fixed(360) * fixed(int(a)) / fixed(int(s.planets)), fixed(16) / distance }, star);
+            table.get<sprite, tags::SPRITE>(planet).value().set_scale(scale);
+            if (uint32_t(rnd.get_int(100)) < s.moon_chance)
+                body(table, { 3, 30, -1.0 }, planet);
+        }
+        return star;
+    }
+
+
+    void galaxy(entity_table & table, fixed x, fixed y, const shape & s, stub::random & rnd)
+    {
+        entity e = table.create();
+        table.add<position, tags::POSITION>(e, { x, y });
+        table.add<sprite, tags::SPRITE>(e, stub::sprite_ptr(x, y));
+        table.subscribe(e);
+        for (uint32_t a = 0; a < s.systems; a++)
+            solar_system(table, fixed(360) * fixed(int(a)) / fixed(int(s.systems)), e, s, rnd);
+    }
+
+
+    /**
+     * @brief Used by a function query to find all the descendants of a star.
+     * 
+     */
+    bool descends_from(entity_table & table, entity e, entity & star)
+    {
+        while (table.has<tags::PARENT>(e))
+        {
+            e = table.get<entity, tags::PARENT>(e);
+            if (e == star)
+                return true;
+        }
+        return false;
+    }
+
+    bool is_star(entity_table & table, entity e)
+    {
+        if (!table.has<tags::PARENT>(e))
+            return false;
+        return !table.has<tags::PARENT>(table.get<entity, tags::PARENT>(e));
+    }
+
+
+    struct game
+    {
+        entity_table table;
+        stub::random rnd;
+        shape s;
+
+        game(uint32_t galaxies, const shape & sh) : s(sh)
+        {
+            table.add_component<position>(tags::POSITION);
+            table.add_component<orbit>(tags::ORBIT);
+            table.add_component<sprite>(tags::SPRITE);
+            table.add_component<entity>(tags::PARENT);
+            table.add_updater(new u_orbit(table));
+            table.add_updater(new u_scenegraph(table));
+            table.add_updater(new u_background());
+            table.set_updater_phase<tags::BACKGROUND>(esa::phase::POST);
+            table.set_updater_rate<tags::BACKGROUND>(2, 1);
+            table.init();
+            for (uint32_t g = 0; g < galaxies; g++)
+                galaxy(table, int(g % 4) * 240 - 360, int(g / 4) * 160 - 240, s, rnd);
+        }
+
+        /**
+         * @brief Destroy a random solar system with all its bodies, and spawn a new one in its place.
+         * 
+         */
+        void respawn()
+        {
+            auto stars = table.query<capacity>(&is_star);
+            if (stars.empty())
+                return;
+            entity star = stars[rnd.get_int(stars.size())];
+            entity parent = table.get<entity, tags::PARENT>(star);
+            fixed angle = table.get<orbit, tags::ORBIT>(star).angle;
+            for (entity e : table.query<capacity, entity>(&descends_from, star))
+                table.destroy(e);
+            table.destroy(star); // the entities are removed at the end of the next update
+            solar_system(table, angle, parent, s, rnd);
+        }
+    };
+}
+
+
+int main(int argc, char ** argv)
+{
+    bench::parameters params;
+    uint32_t frames   = params.get(argc, argv, "frames", 3600);
+    uint32_t galaxies = params.get(argc, argv, "galaxies", 8);
+    tg::shape s;
+    s.systems     = params.get(argc, argv, "systems", 8);
+    s.planets     = params.get(argc, argv, "planets", 3);
+    s.moon_chance = params.get(argc, argv, "moon-chance", 40);
+    uint32_t churn    = params.get(argc, argv, "respawn-every", 30);
+    bench::options opt;
+    opt.repeat = 3;
+    opt.parse(argc, argv, params.usage());
+    uint32_t worst = galaxies * (1 + s.systems * (1 + s.planets * 2)) + 1 + s.planets * 2; // + a respawned system
+    if (worst > tg::capacity || churn == 0)
+    {
+        std::fprintf(stderr, "invalid parameters (at most %u bodies, respawn-every > 0)\n", tg::capacity);
+        return 1;
+    }
+    bench::json_writer out(opt, "esa_scenario_galaxy");
+
+    bench::run_scenario(opt, out, "tiny_galaxy", params, frames,
+        [&]() { return std::make_unique<tg::game>(galaxies, s); },
+        [&](tg::game & g, uint32_t f)
+        {
+            if (f % churn == churn - 1 && s.systems)
+                g.respawn();
+            uint32_t entities = g.table.size();
+            g.table.update();
+            return entities;
+        });
+
+    return 0;
+}
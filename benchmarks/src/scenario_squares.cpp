@@ -0,0 +1,448 @@
+#include <deque>
+#include <memory>
+#include <optional>
+
+#include "esa.h"
+#include "esa_scenario.h"
+#include "stub_bn.h"
+
+
+/**
+ * @brief Headless port of the `colored-squares` example: squares of four colors
+ * bounce around, rotate, scale, blink and animate, while they are continuously
+ * spawned and destroyed. The key presses of the example are replaced by a fixed
+ * schedule of actions (spawn bursts, queries, applys, clears).
+ * 
+ */
+namespace cs
+{
+    constexpr uint32_t capacity = 4096;
+
+    using entity         = esa::entity;
+    using entity_table   = esa::entity_table<capacity, 8, 6, 1, 0>;
+    using uint_set       = esa::uintn_set;
+    using fixed          = stub::fixed;
+
+    struct position
+    {
+        fixed x, y;
+    };
+
+    struct velocity
+    {
+        fixed x, y;
+    };
+
+    using sprite = std::optional<stub::sprite_ptr>;
+
+    enum class color
+    {
+        RED, BLUE, YELLOW, FLASHING
+    };
+
+    namespace tags
+    {
+        enum
+        {
+            POSITION = 0, VELOCITY = 1, SPRITE = 2, COLOR = 3, SCALE = 4, ANGLE = 5, VISIBLE = 6, ANIM_SET = 7,
+            ANIM_CURR = 0, ANIM_CURR_SZ = 2, ANIM_FIRST = 2, ANIM_FIRST_SZ = 2, ANIM_LAST = 4, ANIM_LAST_SZ = 2,
+            MOVEMENT = 0, ROTATION = 1, SCALING = 2, VISIBILITY = 3, ANIMATION = 4,
+            QRY_ROTATION = 0
+        };
+    }
+
+    /**
+     * @brief Simulated key presses, set by the scenario before each frame.
+     * 
+     */
+    struct keys
+    {
+        bool a = false, b = false;
+    };
+
+
+    class u_movement : public esa::entity_updater<capacity>
+    {
+        entity_table & table;
+
+        public:
+
+        u_movement(entity_table & t) : entity_updater(tags::MOVEMENT), table(t) { }
+
+        bool select(entity e) override
+        {
+            return table.has<tags::POSITION>(e) && table.has<tags::VELOCITY>(e);
+        }
+
+        void update() override
+        {
+            for (entity e : this->subscribed())
+            {
+                sprite & spr   = table.get<sprite, tags::SPRITE>(e);
+                position & pos = table.get<position, tags::POSITION>(e);
+                velocity & vel = table.get<velocity, tags::VELOCITY>(e);
+
+                pos.x += vel.x;
+                pos.y += vel.y;
+
+                if (pos.x < -120) { pos.x = -120; vel.x *= -1; }
+                else if (pos.x > 120) { pos.x = 120; vel.x *= -1; }
+                if (pos.y < -80) { pos.y = -80; vel.y *= -1; }
+                else if (pos.y > 80) { pos.y = 80; vel.y *= -1; }
+
+                if (spr.has_value())
+                {
+                    spr.value().set_x(pos.x);
+                    spr.value().set_y(pos.y);
+                }
+            }
+        }
+    };
+
+
+    class u_rotation : public esa::entity_updater<capacity>
+    {
+        entity_table & table;
+
+        public:
+
+        u_rotation(entity_table & t) : entity_updater(tags::ROTATION), table(t) { }
+
+        bool select(entity e) override
+        {
+            return table.has<tags::ANGLE>(e);
+        }
+
+        void update() override
+        {
+            for (entity e : this->subscribed())
+            {
+                sprite & spr = table.get<sprite, tags::SPRITE>(e);
+                int & angle = table.get<int, tags::ANGLE>(e);
+                angle++;
+                if (angle == 360)
+                    angle = 0;
+                if (spr.has_value())
+                    spr.value().set_rotation_angle(angle);
+            }
+        }
+    };
+
+
+    class u_scaling : public esa::entity_updater<capacity>
+    {
+        entity_table & table;
+        keys & pressed;
+
+        public:
+
+        u_scaling(entity_table & t, keys & k) : entity_updater(tags::SCALING), table(t), pressed(k) { }
+
+        bool select(entity e) override
+        {
+            return table.has<tags::SCALE>(e);
+        }
+
+        void update() override
+        {
+            for (entity e : this->subscribed())
+            {
+                sprite & spr = table.get<sprite, tags::SPRITE>(e);
+                int & scale = table.get<int, tags::SCALE>(e);
+                if (pressed.a)
+                    scale = scale < 3 ? scale + 1 : 1;
+                if (spr.has_value())
+                    spr.value().set_scale(fixed(1) / scale);
+            }
+        }
+    };
+
+
+    class u_visibility : public esa::entity_updater<capacity>
+    {
+        entity_table & table;
+        keys & pressed;
+
+        public:
+
+        u_visibility(entity_table & t, keys & k) : entity_updater(tags::VISIBILITY), table(t), pressed(k) { }
+
+        bool select(entity e) override
+        {
+            return table.has<tags::VISIBLE>(e);
+        }
+
+        void update() override
+        {
+            if (!pressed.b)
+                return;
+            for (entity e : this->subscribed())
+            {
+                sprite & spr   = table.get<sprite, tags::SPRITE>(e);
+                bool & visible = table.get<bool, tags::VISIBLE>(e);
+                if (visible)
+                {
+                    spr.reset();
+                    visible = false;
+                }
+                else
+                {
+                    position & pos = table.get<position, tags::POSITION>(e);
+                    spr = stub::sprite_ptr(pos.x, pos.y);
+                    spr.value().set_tiles(1);
+                    visible = true;
+                }
+            }
+        }
+    };
+
+
+    class u_animation : public esa::entity_updater<capacity>
+    {
+        entity_table & table;
+
+        public:
+
+        u_animation(entity_table & t) : entity_updater(tags::ANIMATION), table(t) { }
+
+        bool select(entity e) override
+        {
+            return table.has<tags::ANIM_SET>(e);
+        }
+
+        void update() override { }
+
+        void expired(entity e) override
+        {
+            sprite & spr    = table.get<sprite, tags::SPRITE>(e);
+            uint_set & anim = table.get<uint_set, tags::ANIM_SET>(e);
+            uint32_t curr = anim.get<tags::ANIM_CURR, tags::ANIM_CURR_SZ>();
+            uint32_t first = anim.get<tags::ANIM_FIRST, tags::ANIM_FIRST_SZ>();
+            uint32_t last = anim.get<tags::ANIM_LAST, tags::ANIM_LAST_SZ>();
+            curr = curr < last ? curr + 1 : first;
+            if (spr.has_value())
+                spr.value().set_tiles(curr);
+            anim.set<tags::ANIM_CURR, tags::ANIM_CURR_SZ>(curr);
+            table.schedule<tags::ANIMATION>(e, 10);
+        }
+    };
+
+
+    class q_rotation : public esa::cached_query<capacity>
+    {
+        entity_table & table;
+
+        public:
+
+        q_rotation(entity_table & t) : cached_query(tags::QRY_ROTATION), table(t) { }
+
+        bool select(entity e) override
+        {
+            return table.has<tags::ANGLE>(e);
+        }
+
+        bool where(entity e) override
+        {
+            return table.get<int, tags::ANGLE>(e) > 180;
+        }
+    };
+
+
+    bool find_red_squares(entity_table & table, entity e)
+    {
+        return table.get<color, tags::COLOR>(e) == color::RED;
+    }
+
+    struct x_boundaries
+    {
+        fixed min, max;
+    };
+
+    bool find_yellow_squares_within(entity_table & table, entity e, x_boundaries & b)
+    {
+        position & pos = table.get<position, tags::POSITION>(e);
+        return table.get<color, tags::COLOR>(e) == color::YELLOW && pos.x < b.max && pos.x > b.min;
+    }
+
+    bool incr_blue_squares_velocity(entity_table & table, entity e)
+    {
+        if (table.get<color, tags::COLOR>(e) == color::BLUE)
+        {
+            velocity & vel = table.get<velocity, tags::VELOCITY>(e);
+            vel.x += vel.x > 0 ? fixed(1) : fixed(-1);
+            vel.y += vel.y > 0 ? fixed(1) : fixed(-1);
+        }
+        return false;
+    }
+
+    bool remove_all_sprites(entity_table & table, entity e)
+    {
+        table.get<sprite, tags::SPRITE>(e).reset();
+        return false;
+    }
+
+
+    /**
+     * @brief Create a square of a certain color (same components as the example).
+     * 
+     */
+    entity square(entity_table & table, color c, stub::random & rnd)
+    {
+        entity e = table.create();
+        fixed vx = rnd.get_int(2) ? fixed(0.5) : fixed(-0.5);
+        fixed vy = rnd.get_int(2) ? fixed(0.5) : fixed(-0.5);
+        table.add<position, tags::POSITION>(e, { rnd.get_fixed(-100, 100), rnd.get_fixed(-60, 60) });
+        table.add<velocity, tags::VELOCITY>(e, { vx, vy });
+        table.add<color, tags::COLOR>(e, c);
+        if (c != color::BLUE)
+            table.add<int, tags::SCALE>(e, 1);
+        if (c != color::RED)
+            table.add<int, tags::ANGLE>(e, rnd.get_int(360));
+        if (c == color::BLUE)
+            table.add<bool, tags::VISIBLE>(e, true);
+        if (c == color::FLASHING)
+        {
+            uint_set anim;
+            anim.set<tags::ANIM_LAST, tags::ANIM_LAST_SZ>(2);
+            table.add<uint_set, tags::ANIM_SET>(e, anim);
+        }
+        table.add<sprite, tags::SPRITE>(e, stub::sprite_ptr(0, 0));
+        table.subscribe(e);
+        if (c == color::FLASHING)
+            table.schedule<tags::ANIMATION>(e, 10);
+        return e;
+    }
+
+
+    /**
+     * @brief State of a scenario run.
+     * 
+     */
+    struct game
+    {
+        entity_table table;
+        keys pressed;
+        stub::random rnd;
+        std::deque<std::pair<entity, uint32_t>> spawned; // entity and its serial number
+        uint32_t serials[capacity] = {};
+        uint32_t next_serial = 1;
+
+        game()
+        {
+            table.add_component<position>(tags::POSITION);
+            table.add_component<velocity>(tags::VELOCITY);
+            table.add_component<sprite>(tags::SPRITE);
+            table.add_component<color>(tags::COLOR);
+            table.add_component<int>(tags::SCALE);
+            table.add_component<int>(tags::ANGLE);
+            table.add_component<bool>(tags::VISIBLE);
+            table.add_component<uint_set>(tags::ANIM_SET);
+            table.add_updater(new u_movement(table));
+            table.add_updater(new u_rotation(table));
+            table.add_updater(new u_visibility(table, pressed));
+            table.add_updater(new u_scaling(table, pressed));
+            table.add_updater(new u_animation(table));
+            table.add_query(new q_rotation(table));
+            table.init();
+        }
+
+        void spawn(color c)
+        {
+            entity e = square(table, c, rnd);
+            serials[e] = next_serial++;
+            spawned.push_back({ e, serials[e] });
+        }
+
+        void kill(entity e)
+        {
+            table.get<sprite, tags::SPRITE>(e).reset();
+            table.destroy(e);
+            serials[e] = 0;
+        }
+    };
+}
+
+
+int main(int argc, char ** argv)
+{
+    bench::parameters params;
+    uint32_t frames  = params.get(argc, argv, "frames", 3600);
+    uint32_t target  = params.get(argc, argv, "target", 128);
+    uint32_t burst   = params.get(argc, argv, "burst", 8);
+    uint32_t every   = params.get(argc, argv, "burst-every", 4);
+    uint32_t clears  = params.get(argc, argv, "clear-every", 900);
+    bench::options opt;
+    opt.repeat = 3;
+    opt.parse(argc, argv, params.usage());
+    if (target > cs::capacity || burst == 0 || every == 0 || clears == 0)
+    {
+        std::fprintf(stderr, "invalid parameters (target must be <= %u, the others > 0)\n", cs::capacity);
+        return 1;
+    }
+    bench::json_writer out(opt, "esa_scenario_squares");
+
+    bench::run_scenario(opt, out, "colored_squares", params, frames,
+        []() { return std::make_unique<cs::game>(); },
+        [&](cs::game & g, uint32_t f)
+        {
+            using namespace cs;
+            entity_table & table = g.table;
+            g.pressed.a = f % 30 == 0;
+            g.pressed.b = f % 90 == 0;
+
+            // spawn bursts, then destroy the oldest squares above the target
+            if (f % every == 0)
+            {
+                for (uint32_t i = 0; i < burst && !table.full(); i++)
+                    g.spawn(color(i & 3));
+            }
+            uint32_t alive = table.size();
+            while (alive > target && !g.spawned.empty())
+            {
+                auto [e, serial] = g.spawned.front();
+                g.spawned.pop_front();
+                if (g.serials[e] == serial)
+                {
+                    g.kill(e);
+                    alive--;
+                }
+            }
+
+            // the actions bound to the keys in the example
+            switch (f % 60)
+            {
+                case 15: // destroy the rotating squares with angle > 180
+                    for (entity e : table.query<tags::QRY_ROTATION, capacity>())
+                        g.kill(e);
+                    break;
+                case 30:
+                    table.apply(&incr_blue_squares_velocity);
+                    break;
+                case 45: // freeze the yellow squares with -64 < x < 64
+                {
+                    x_boundaries b = { -64, 64 };
+                    for (entity e : table.query<capacity, x_boundaries>(&find_yellow_squares_within, b))
+                        table.get<velocity, tags::VELOCITY>(e) = { 0, 0 };
+                    break;
+                }
+                case 55: // destroy all the red squares
+                    for (entity e : table.query<capacity>(&find_red_squares))
+                        g.kill(e);
+                    break;
+            }
+            if (f % clears == clears - 1)
+            {
+                table.apply(&remove_all_sprites);
+                table.clear();
+                for (uint32_t e = 0; e < capacity; e++)
+                    g.serials[e] = 0;
+                g.spawned.clear();
+            }
+
+            uint32_t entities = table.size();
+            table.update();
+            return entities;
+        });
+
+    return 0;
+}
@@ -57,13 +57,47 @@ namespace esa
 
 
     /**
-     * @brief IWRAM, EWRAM.
+     * @brief A function returning the current time, in any unit (GBA timer ticks, microseconds, ...).
+     * 
+     */
+    using clock_fn = uint32_t (*)();
+
+
+    /**
+     * @brief IWRAM, EWRAM, ROM. (ROM is only used to model the cost of reading read-only data in the cartridge)
      * 
      */
     enum class ram
     {
         IWRAM,
-        EWRAM
+        EWRAM,
+        ROM
+    };
+
+
+    /**
+     * @brief The phases of `entity_table::update()`, executed in this order.
+     * Updaters are assigned to `SIM` unless specified otherwise.
+     * When a fixed timestep is used, `SIM` may run more than once per frame.
+     * 
+     */
+    enum class phase
+    {
+        PRE,
+        SIM,
+        POST,
+        RENDER_EXTRACT
+    };
+
+
+    /**
+     * @brief Tag of the constructors that create a column again over the memory it used in a previous run
+     * (a file mapped by `esa::mapped_arena`), without initializing its content.
+     * 
+     */
+    struct reattach_t
+    {
+
     };
 
 
@@ -119,6 +153,41 @@ namespace esa
     class entity_mask;
 
 
+    /**
+     * @brief A read-only view on an entity mask, used by updaters, cached queries
+     * and cached apply objects to skip the entities disabled in their table.
+     * 
+     */
+    class entity_filter;
+
+
+    /**
+     * @brief A hierarchical timer wheel, used by entity tables to wake up updaters
+     * (or destroy entities) after a certain number of frames.
+     * 
+     * @tparam Entities The maximum number of entities.
+     * @tparam Timers The maximum number of pending timers.
+     */
+    template<uint32_t Entities, uint32_t Timers>
+    class timer_wheel;
+
+
+    /**
+     * @brief The timer wheel of an entity table: `ESA_TIMERS` timers if the macro is defined, as many timers as
+     * entities otherwise (an entity can have a pending timer for each updater), but at most 65534, since the timers
+     * are linked by 16-bit indexes.
+     * 
+     * @tparam Entities The maximum number of entities.
+     */
+#ifdef ESA_TIMERS
+    template<uint32_t Entities>
+    using table_timer_wheel = timer_wheel<Entities, (ESA_TIMERS < 0xffff ? ESA_TIMERS : 0xfffe)>;
+#else
+    template<uint32_t Entities>
+    using table_timer_wheel = timer_wheel<Entities, (Entities < 0xffff ? Entities : 0xfffe)>;
+#endif
+
+
     /**
      * @brief Base class for any updater.
      * 
@@ -151,6 +220,23 @@ namespace esa
     class index_updater;
 
 
+    /**
+     * @brief Base class for sliced updaters.
+     * 
+     */
+    class isliced_updater;
+
+
+    /**
+     * @brief A sliced updater is an entity updater that processes its entities across
+     * several frames, within a per-frame budget, resuming from a stored cursor.
+     * 
+     * @tparam Entities The maximum number of entities the updater is expected to work with.
+     */
+    template<uint32_t Entities>
+    class sliced_updater;
+
+
     /**
      * @brief  A table updater is an updater that does not work on any specific entity.
      * It is used to access an entity table and perform operations on it through other means (like queries).
@@ -159,6 +245,311 @@ namespace esa
     class table_updater;
 
 
+    /**
+     * @brief Storage for the coroutine frames of tasks, sized at compile time (no heap allocation).
+     * 
+     * @tparam FrameSize The maximum size of a coroutine frame, in bytes.
+     * @tparam Frames The maximum number of coroutine frames allocated at the same time.
+     */
+    template<uint32_t FrameSize, uint32_t Frames>
+    class task_pool;
+
+
+    /**
+     * @brief State shared by all tasks (wait condition, owner, ...).
+     * 
+     */
+    class task_state;
+
+
+    /**
+     * @brief A task is a C++20 coroutine that can suspend itself across frames, waiting for
+     * `next_frame()`, `frames(n)` or `component_changed<Tag>(e)`.
+     * Requires C++20 coroutines support.
+     * 
+     * @tparam FrameSize The maximum size of the coroutine frame, in bytes.
+     * @tparam Frames The number of coroutine frames available for tasks of this type.
+     */
+    template<uint32_t FrameSize, uint32_t Frames>
+    class task;
+
+
+    /**
+     * @brief Base class for task updaters.
+     * 
+     */
+    class itask_updater;
+
+
+    /**
+     * @brief A task updater runs tasks, resuming only those whose wait condition is satisfied.
+     * 
+     * @tparam Tasks The maximum number of tasks running at the same time.
+     */
+    template<uint32_t Tasks>
+    class task_updater;
+
+
+    /**
+     * @brief Rolling time samples (min/avg/max/p99) of a profiled operation.
+     * 
+     * @tparam Frames The number of frames kept.
+     */
+    template<uint32_t Frames>
+    class profile_samples;
+
+
+    /**
+     * @brief Records the time spent by each updater of a table, by the end-of-frame destruction and
+     * by the subscriptions, using a pluggable clock. Attached to the table only when `ESA_PROFILER` is defined.
+     * 
+     * @tparam Updaters The maximum number of updaters of the table.
+     * @tparam Frames The number of frames kept. (`ESA_PROFILER_FRAMES`, 64 by default)
+     */
+    template<uint32_t Updaters, uint32_t Frames>
+    class profiler;
+
+
+    /**
+     * @brief Ring buffer of trace events (frames, updaters, queries, apply operations, destruction),
+     * which can be exported as Chrome trace-event JSON. Attached to the table only when `ESA_TRACE` is defined.
+     * 
+     * @tparam Events The number of events kept. (`ESA_TRACE_EVENTS`, 1024 by default)
+     */
+    template<uint32_t Events>
+    class trace_buffer;
+
+
+    /**
+     * @brief Records a begin event when constructed, and the matching end event when destroyed.
+     * 
+     * @tparam Events The number of events of the trace buffer.
+     */
+    template<uint32_t Events>
+    class trace_scope;
+
+
+    /**
+     * @brief Keeps what happened during the last frames of a table (time of each updater, entities created,
+     * destroyed and subscribed, queries), and dumps it through a callback when a frame is too slow.
+     * Attached to the table only when `ESA_FLIGHT_RECORDER` is defined.
+     * 
+     * @tparam Updaters The maximum number of updaters of the table.
+     * @tparam Frames The number of frames kept. (`ESA_FLIGHT_RECORDER_FRAMES`, 32 by default)
+     */
+    template<uint32_t Updaters, uint32_t Frames>
+    class flight_recorder;
+
+
+    /**
+     * @brief Log of the structural operations made on a table, in a compact binary stream that can be replayed
+     * on the host. Attached to the table only when `ESA_OP_LOG` is defined.
+     * 
+     * @tparam Bytes The size of the buffer. (`ESA_OP_LOG_BYTES`, 4096 by default)
+     */
+    template<uint32_t Bytes>
+    class op_log;
+
+
+    /**
+     * @brief The header of a table snapshot.
+     * 
+     */
+    struct snapshot_header;
+
+
+    /**
+     * @brief Writes a table snapshot to a buffer (or only counts its bytes).
+     * 
+     */
+    class snapshot_writer;
+
+
+    /**
+     * @brief Reads a table snapshot from a buffer.
+     * 
+     */
+    class snapshot_reader;
+
+
+    /**
+     * @brief How the components of a type that is not trivially copyable are saved and restored in snapshots.
+     * 
+     * @tparam ComponentType The type of the component.
+     */
+    template<typename ComponentType>
+    struct snapshot_hooks;
+
+
+    /**
+     * @brief A log of the changes made to a table in the last frames, in a ring buffer, to rewind the table
+     * (used when `ESA_ROLLBACK` is defined).
+     * 
+     */
+    class rollback_log;
+
+
+    /**
+     * @brief A rollback log with its own memory.
+     * 
+     * @tparam Bytes The size of the buffer. (`ESA_ROLLBACK_BYTES`, 16384 by default)
+     * @tparam Frames The maximum number of frames. (`ESA_ROLLBACK_FRAMES`, 8 by default)
+     */
+    template<uint32_t Bytes, uint32_t Frames>
+    class rollback_buffer;
+
+
+    /**
+     * @brief A hash of a set of entries, one per entity, updated as the entries change
+     * (used when `ESA_STATE_HASH` is defined).
+     * 
+     * @tparam Entities The maximum number of entities.
+     */
+    template<uint32_t Entities>
+    class running_hash;
+
+
+    /**
+     * @brief How much of a fixed-size container is in use (a column, the subscriber list of an updater, ...).
+     * 
+     */
+    struct usage;
+
+
+    /**
+     * @brief Entities created, destroyed and subscribed by a table.
+     * 
+     */
+    struct churn;
+
+
+    /**
+     * @brief Occupancy, fragmentation (holes below the used rows) and churn of a table.
+     * 
+     */
+    struct table_stats;
+
+
+    /**
+     * @brief Memory taken up by some objects, split between IWRAM and EWRAM (computed at compile time).
+     * 
+     */
+    struct footprint;
+
+
+    /**
+     * @brief The heap used by ESA, counting allocations and releases.
+     * 
+     */
+    class heap;
+
+
+    /**
+     * @brief Base class for memory arenas, from which a table can create its internals and its columns.
+     * 
+     */
+    class iarena;
+
+
+    /**
+     * @brief An arena allocating blocks one after the other in a caller-provided buffer, and releasing them in one shot.
+     * 
+     */
+    class linear_arena;
+
+
+    /**
+     * @brief A linear arena owning its buffer, to be defined as a static object (in IWRAM or EWRAM).
+     * 
+     * @tparam Bytes The size of the arena.
+     */
+    template<uint32_t Bytes>
+    class static_arena;
+
+
+    /**
+     * @brief Caller-provided storage for the internals of a table, so that the table allocates nothing on the heap.
+     * 
+     * @tparam Entities, Components, Updaters, Queries, Applys The template parameters of the table.
+     */
+    template<uint32_t Entities, uint32_t Components, uint32_t Updaters, uint32_t Queries, uint32_t Applys>
+    struct table_storage;
+
+
+    /**
+     * @brief Base class for the observers of the memory accesses reported when `ESA_INSTRUMENT` is defined.
+     * 
+     */
+    class iaccess_observer;
+
+
+    /**
+     * @brief Dispatches the memory accesses made by the tables to the attached observers.
+     * 
+     */
+    class instrument;
+
+
+    /**
+     * @brief The bus width and the cycles per transfer of a memory region.
+     * 
+     */
+    struct wait_states;
+
+
+    /**
+     * @brief The reads and writes made to a memory region.
+     * 
+     */
+    struct region_counters;
+
+
+    /**
+     * @brief Estimates the cycles spent by each updater accessing IWRAM, EWRAM and ROM, on the host.
+     * 
+     * @tparam Updaters The maximum number of updaters tracked.
+     * @tparam Frames The number of frames kept for each updater. (64 by default)
+     */
+    template<uint32_t Updaters, uint32_t Frames = 64>
+    class memory_sim;
+
+
+    /**
+     * @brief The recommended placement of a column (IWRAM or EWRAM), with its size and the bytes accessed.
+     * 
+     */
+    struct column_placement;
+
+
+    /**
+     * @brief The recommended placement of all the columns of a table, for a certain IWRAM budget.
+     * 
+     * @tparam Components The maximum number of components of the table.
+     */
+    template<uint32_t Components>
+    struct placement_plan;
+
+
+    /**
+     * @brief Records the accesses to each column and recommends which columns to place in IWRAM.
+     * 
+     * @tparam Components The maximum number of components of the table.
+     */
+    template<uint32_t Components>
+    class placement_advisor;
+
+
+    /**
+     * @brief Records which columns each updater reads and writes, finds the updaters that conflict,
+     * and flags the accesses that were not declared.
+     * 
+     * @tparam Updaters The maximum number of updaters tracked.
+     * @tparam Components The maximum number of components of the table.
+     */
+    template<uint32_t Updaters, uint32_t Components>
+    class access_recorder;
+
+
     /**
      * @brief Base class for cached query.
      * 
@@ -193,6 +584,25 @@ namespace esa
     class cached_apply;
 
 
+    /**
+     * @brief Writes a level stream: prefabs and entities, as records of component tags and bytes.
+     * 
+     */
+    class level_writer;
+
+
+    /**
+     * @brief A level stream loads the entities of a level stream into a table across frames, within a per-frame budget,
+     * by priority, subscribing the entities created in each frame together.
+     * 
+     * @tparam Table The type of the table.
+     * @tparam Records The maximum number of entities in a stream.
+     * @tparam Prefabs The maximum number of prefabs in a stream.
+     */
+    template<typename Table, uint32_t Records, uint32_t Prefabs>
+    class level_stream;
+
+
     /**
      * @brief A set of 32 boolean values, implmented in a single unsigned integer.
      * Can be used as a component for memory efficiency in exchange for a small performance penalty. 
@@ -216,14 +626,35 @@ namespace esa
 #include "esa_array.h"
 #include "esa_vector.h"
 #include "esa_entity_mask.h"
+#include "esa_profiler.h"
+#include "esa_trace.h"
+#include "esa_flight_recorder.h"
+#include "esa_op_log.h"
+#include "esa_snapshot.h"
+#include "esa_rollback.h"
+#include "esa_state_hash.h"
+#include "esa_timer_wheel.h"
+#include "esa_stats.h"
+#include "esa_footprint.h"
+#include "esa_heap.h"
+#include "esa_arena.h"
+#include "esa_instrument.h"
+#include "esa_memory_sim.h"
 #include "esa_series.h"
 #include "esa_indexed_series.h"
+#include "esa_placement.h"
+#include "esa_access_recorder.h"
 #include "esa_entity_updater.h"
 #include "esa_index_updater.h"
+#include "esa_sliced_updater.h"
+#if defined(__cpp_impl_coroutine)
+#include "esa_task.h"
+#endif
 #include "esa_table_updater.h"
 #include "esa_cached_query.h"
 #include "esa_cached_apply.h"
 #include "esa_entity_table.h"
+#include "esa_level_stream.h"
 #include "esa_components.h"
 
 #endif
\ No newline at end of file
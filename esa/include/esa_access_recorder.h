@@ -0,0 +1,324 @@
+#ifndef ESA_ACCESS_RECORDER_H
+#define ESA_ACCESS_RECORDER_H
+
+#include <cassert>
+
+#include "esa.h"
+
+
+namespace esa
+{
+    /**
+     * @brief Records which columns each updater reads and writes when `ESA_INSTRUMENT` is defined (the access matrix),
+     * and compares them with the accesses declared for each updater. Two updaters conflict if one of them writes
+     * a column that the other one reads or writes: their order matters, and they cannot run at the same time.
+     * Columns are read by `has`, `read` and `id`, and written by `add`, `remove`, `get` and the `[]` operators
+     * of the series (a mutable reference is assumed to be written).
+     * 
+     * @tparam Updaters The maximum number of updaters tracked.
+     * @tparam Components The maximum number of components of the table.
+     */
+    template<uint32_t Updaters, uint32_t Components>
+    class access_recorder : public iaccess_observer
+    {
+        /**
+         * @brief Bit of a column read.
+         * 
+         */
+        static constexpr unsigned char READ_BIT = 1;
+
+
+        /**
+         * @brief Bit of a column written.
+         * 
+         */
+        static constexpr unsigned char WRITE_BIT = 2;
+
+
+        /**
+         * @brief The tag of the updater tracked in each slot, in order of declaration or first access.
+         * 
+         */
+        tag_t _tags [ Updaters == 0 ? 1 : Updaters ];
+
+
+        /**
+         * @brief The accesses made by each updater to each column. (`READ_BIT`, `WRITE_BIT`)
+         * 
+         */
+        unsigned char _observed [ Updaters == 0 ? 1 : Updaters ][ Components ];
+
+
+        /**
+         * @brief The accesses declared for each updater to each column. (a declared write also allows reads)
+         * 
+         */
+        unsigned char _declared [ Updaters == 0 ? 1 : Updaters ][ Components ];
+
+
+        /**
+         * @brief The number of slots in use.
+         * 
+         */
+        uint32_t _slots;
+
+
+        /**
+         * @brief If true, an undeclared access fails an assertion as soon as it happens.
+         * 
+         */
+        bool _strict;
+
+
+        /**
+         * @brief Returns the bits of a kind of access.
+         * 
+         */
+        [[nodiscard]] static unsigned char _bits(access_kind kind)
+        {
+            return kind == access_kind::READ ? READ_BIT : kind == access_kind::WRITE ? WRITE_BIT : READ_BIT | WRITE_BIT;
+        }
+
+
+        /**
+         * @brief Find the slot of an updater, adding it if it was never seen.
+         * 
+         * @param tag The tag of the updater.
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t _slot(tag_t tag)
+        {
+            for (uint32_t i = 0; i < _slots; i++)
+            {
+                if (_tags[i] == tag)
+                    return i;
+            }
+            assert(_slots < Updaters && "ESA ERROR: too many updaters for the access recorder!");
+            _tags[_slots] = tag;
+            for (uint32_t c = 0; c < Components; c++)
+            {
+                _observed[_slots][c] = 0;
+                _declared[_slots][c] = 0;
+            }
+            _slots++;
+            return _slots - 1;
+        }
+
+
+        /**
+         * @brief Find the slot of an updater, or `Updaters` if it is not tracked.
+         * 
+         * @param tag The tag of the updater.
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t _find(tag_t tag)
+        {
+            for (uint32_t i = 0; i < _slots; i++)
+            {
+                if (_tags[i] == tag)
+                    return i;
+            }
+            return Updaters;
+        }
+
+
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         */
+        access_recorder()
+        {
+            _slots = 0;
+            _strict = false;
+        }
+
+
+        /**
+         * @brief Declare an access of an updater to a column. (`WRITE` and `MODIFY` also allow reads)
+         * 
+         * @param updater The tag of the updater.
+         * @param column The tag of the column.
+         * @param kind The kind of access.
+         */
+        void declare(tag_t updater, tag_t column, access_kind kind)
+        {
+            assert(column < Components && "ESA ERROR: component tag out of range!");
+            _declared[_slot(updater)][column] |= kind == access_kind::READ ? READ_BIT : READ_BIT | WRITE_BIT;
+        }
+
+
+        /**
+         * @brief If true, an undeclared access fails an assertion as soon as it happens (to find it with a debugger).
+         * 
+         * @param strict True to assert on undeclared accesses.
+         */
+        void set_strict(bool strict)
+        {
+            _strict = strict;
+        }
+
+
+        /**
+         * @brief Record an access. Accesses made outside updaters, and to subscriber lists, are ignored.
+         * 
+         */
+        void access(tag_t updater, tag_t column, ram where, access_kind kind, uint32_t bytes) override
+        {
+            (void) where;
+            (void) bytes;
+            if (updater == instrument::NO_TAG || column >= Components)
+                return;
+            uint32_t slot = _slot(updater);
+            unsigned char bits = _bits(kind);
+            _observed[slot][column] |= bits;
+            assert(!(_strict && (bits & ~_declared[slot][column])) && "ESA ERROR: undeclared column access!");
+        }
+
+
+        /**
+         * @brief Forget the accesses recorded so far. (the declarations are kept)
+         * 
+         */
+        void reset()
+        {
+            for (uint32_t i = 0; i < _slots; i++)
+            {
+                for (uint32_t c = 0; c < Components; c++)
+                    _observed[i][c] = 0;
+            }
+        }
+
+
+        /**
+         * @brief Returns the number of updaters tracked.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t updaters()
+        {
+            return _slots;
+        }
+
+
+        /**
+         * @brief Returns the tag of the updater in a certain slot (in order of declaration or first access).
+         * 
+         * @param slot The slot.
+         * @return tag_t
+         */
+        [[nodiscard]] tag_t tag(uint32_t slot)
+        {
+            assert(slot < _slots && "ESA ERROR: access recorder slot out of range!");
+            return _tags[slot];
+        }
+
+
+        /**
+         * @brief Tells if an updater was seen reading a column.
+         * 
+         * @param updater The tag of the updater.
+         * @param column The tag of the column.
+         * @return true
+         * @return false
+         */
+        [[nodiscard]] bool reads(tag_t updater, tag_t column)
+        {
+            uint32_t slot = _find(updater);
+            return slot < _slots && column < Components && (_observed[slot][column] & READ_BIT);
+        }
+
+
+        /**
+         * @brief Tells if an updater was seen writing a column.
+         * 
+         * @param updater The tag of the updater.
+         * @param column The tag of the column.
+         * @return true
+         * @return false
+         */
+        [[nodiscard]] bool writes(tag_t updater, tag_t column)
+        {
+            uint32_t slot = _find(updater);
+            return slot < _slots && column < Components && (_observed[slot][column] & WRITE_BIT);
+        }
+
+
+        /**
+         * @brief Tells if an updater accessed a column in a way that was not declared.
+         * 
+         * @param updater The tag of the updater.
+         * @param column The tag of the column.
+         * @return true
+         * @return false
+         */
+        [[nodiscard]] bool undeclared(tag_t updater, tag_t column)
+        {
+            uint32_t slot = _find(updater);
+            return slot < _slots && column < Components && (_observed[slot][column] & ~_declared[slot][column]);
+        }
+
+
+        /**
+         * @brief Returns the number of (updater, column) pairs with undeclared accesses.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t undeclared()
+        {
+            uint32_t n = 0;
+            for (uint32_t i = 0; i < _slots; i++)
+            {
+                for (uint32_t c = 0; c < Components; c++)
+                {
+                    if (_observed[i][c] & ~_declared[i][c])
+                        n++;
+                }
+            }
+            return n;
+        }
+
+
+        /**
+         * @brief Returns the first column through which two updaters conflict (one writes it, the other one reads or writes it),
+         * or `instrument::NO_TAG` if they are independent. Both the recorded and the declared accesses are considered.
+         * 
+         * @param a The tag of an updater.
+         * @param b The tag of another updater.
+         * @return tag_t
+         */
+        [[nodiscard]] tag_t conflict(tag_t a, tag_t b)
+        {
+            uint32_t sa = _find(a);
+            uint32_t sb = _find(b);
+            if (sa >= _slots || sb >= _slots || sa == sb)
+                return instrument::NO_TAG;
+            for (tag_t c = 0; c < Components; c++)
+            {
+                unsigned char ua = _observed[sa][c] | _declared[sa][c];
+                unsigned char ub = _observed[sb][c] | _declared[sb][c];
+                if (((ua & WRITE_BIT) && ub) || ((ub & WRITE_BIT) && ua))
+                    return c;
+            }
+            return instrument::NO_TAG;
+        }
+
+
+        /**
+         * @brief Tells if two updaters conflict: their relative order must be kept, and they cannot run concurrently.
+         * 
+         * @param a The tag of an updater.
+         * @param b The tag of another updater.
+         * @return true
+         * @return false
+         */
+        [[nodiscard]] bool conflicts(tag_t a, tag_t b)
+        {
+            return conflict(a, b) != instrument::NO_TAG;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef ESA_ACCESS_REPORT_H
+#define ESA_ACCESS_REPORT_H
+
+#include <cstdio>
+
+#include "esa.h"
+
+
+/**
+ * @brief Export of the accesses recorded by an `esa::access_recorder`: the access matrix as text,
+ * and the conflict graph in the Graphviz DOT format. Host builds only (uses the C standard library).
+ * 
+ */
+namespace esa
+{
+    /**
+     * @brief A function returning the name of an updater or of a column, or `nullptr` to use its tag.
+     * 
+     */
+    using tag_name_fn = const char * (*)(tag_t tag);
+
+
+    /**
+     * @brief Write the access matrix: one row per updater, one column per component, with `R` for reads,
+     * `W` for writes, `RW` for both, and a `!` for undeclared accesses.
+     * 
+     * @param out The output file.
+     * @param recorder The access recorder.
+     * @param updater_name The names of the updaters. (`nullptr` = tags)
+     * @param column_name The names of the columns. (`nullptr` = tags)
+     */
+    template<uint32_t Updaters, uint32_t Components>
+    void write_access_matrix(std::FILE * out, access_recorder<Updaters, Components> & recorder,
+        tag_name_fn updater_name = nullptr, tag_name_fn column_name = nullptr)
+    {
+        std::fprintf(out, "%-20s", "");
+        for (tag_t c = 0; c < Components; c++)
+        {
+            const char * n = column_name != nullptr ? column_name(c) : nullptr;
+            if (n != nullptr)
+                std::fprintf(out, " %10.10s", n);
+            else
+                std::fprintf(out, " %10u", unsigned(c));
+        }
+        std::fprintf(out, "\n");
+        for (uint32_t i = 0; i < recorder.updaters(); i++)
+        {
+            tag_t u = recorder.tag(i);
+            const char * n = updater_name != nullptr ? updater_name(u) : nullptr;
+            if (n != nullptr)
+                std::fprintf(out, "%-20.20s", n);
+            else
+                std::fprintf(out, "%-20u", unsigned(u));
+            for (tag_t c = 0; c < Components; c++)
+            {
+                bool r = recorder.reads(u, c);
+                bool w = recorder.writes(u, c);
+                const char * cell = r && w ? "RW" : r ? "R" : w ? "W" : ".";
+                std::fprintf(out, " %9s%c", cell, recorder.undeclared(u, c) ? '!' : ' ');
+            }
+            std::fprintf(out, "\n");
+        }
+    }
+
+
+    /**
+     * @brief Write the conflict graph in the Graphviz DOT format: one node per updater, and one edge
+     * between each pair of conflicting updaters, labelled with the first column they conflict on.
+     * 
+     * @param out The output file.
+     * @param recorder The access recorder.
+     * @param updater_name The names of the updaters. (`nullptr` = tags)
+     * @param column_name The names of the columns. (`nullptr` = tags)
+     */
+    template<uint32_t Updaters, uint32_t Components>
+    void write_conflict_graph(std::FILE * out, access_recorder<Updaters, Components> & recorder,
+        tag_name_fn updater_name = nullptr, tag_name_fn column_name = nullptr)
+    {
+        std::fprintf(out, "graph conflicts {\n");
+        for (uint32_t i = 0; i < recorder.updaters(); i++)
+        {
+            tag_t u = recorder.tag(i);
+            const char * n = updater_name != nullptr ? updater_name(u) : nullptr;
+            if (n != nullptr)
+                std::fprintf(out, "    u%u [label=\"%s\"];\n", unsigned(u), n);
+            else
+                std::fprintf(out, "    u%u [label=\"%u\"];\n", unsigned(u), unsigned(u));
+        }
+        for (uint32_t i = 0; i < recorder.updaters(); i++)
+        {
+            for (uint32_t j = i + 1; j < recorder.updaters(); j++)
+            {
+                tag_t a = recorder.tag(i);
+                tag_t b = recorder.tag(j);
+                tag_t c = recorder.conflict(a, b);
+                if (c == instrument::NO_TAG)
+                    continue;
+                const char * n = column_name != nullptr ? column_name(c) : nullptr;
+                if (n != nullptr)
+                    std::fprintf(out, "    u%u -- u%u [label=\"%s\"];\n", unsigned(a), unsigned(b), n);
+                else
+                    std::fprintf(out, "    u%u -- u%u [label=\"%u\"];\n", unsigned(a), unsigned(b), unsigned(c));
+            }
+        }
+        std::fprintf(out, "}\n");
+    }
+}
+
+#endif
@@ -0,0 +1,304 @@
+#ifndef ESA_ARENA_H
+#define ESA_ARENA_H
+
+#include <cassert>
+#include <new>
+
+#include "esa.h"
+
+
+namespace esa
+{
+    class iarena
+    {
+        public:
+
+
+        /**
+         * @brief Allocate a block of memory.
+         * 
+         * @param bytes The size of the block.
+         * @param alignment The alignment of the block. (a power of two)
+         * @return void* The block, or `nullptr` if the arena is full.
+         */
+        [[nodiscard]] virtual void * allocate(uint32_t bytes, uint32_t alignment) = 0;
+
+
+        /**
+         * @brief Returns the current position of the arena, to be passed to `release()`.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] virtual uint32_t mark() = 0;
+
+
+        /**
+         * @brief Release, in one shot, all the blocks allocated after a certain position.
+         * 
+         * @param mark A position returned by `mark()`.
+         */
+        virtual void release(uint32_t mark) = 0;
+
+
+        /**
+         * @brief Tells if the last block allocated holds an object created there by a previous run,
+         * whose content must be kept (e.g. a column in a file mapped by `esa::mapped_arena`).
+         * 
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] virtual bool reattached()
+        {
+            return false;
+        }
+
+
+        /**
+         * @brief Returns where the memory of the arena is.
+         * 
+         * @return ram
+         */
+        [[nodiscard]] virtual ram location()
+        {
+            return ram::EWRAM;
+        }
+
+
+        /**
+         * @brief Create an object in the arena.
+         * 
+         * @tparam Type The type of the object.
+         * @return Type*
+         */
+        template<typename Type>
+        [[nodiscard]] Type * create()
+        {
+            void * p = allocate(sizeof(Type), alignof(Type));
+            assert(p != nullptr && "ESA ERROR: arena is full!");
+            return ::new(p) Type();
+        }
+
+
+        /**
+         * @brief Create a column in the arena. If the arena holds the column created by a previous run
+         * (see `reattached()`), it is created again over its memory, keeping its content.
+         * 
+         * @tparam Type The type of the column (`series` or `indexed_series`).
+         * @return Type* 
+         */
+        template<typename Type>
+        [[nodiscard]] Type * create_column()
+        {
+            void * p = allocate(sizeof(Type), alignof(Type));
+            assert(p != nullptr && "ESA ERROR: arena is full!");
+            if (reattached())
+                return ::new(p) Type(reattach_t());
+            return ::new(p) Type();
+        }
+
+
+        /**
+         * @brief Destroy an object created in an arena. Its memory is only reclaimed by `release()`.
+         * (nothing happens for `nullptr`)
+         * 
+         * @tparam Type The type of the object (or a base class with a virtual destructor).
+         * @param p A pointer to the object.
+         */
+        template<typename Type>
+        static void destroy(Type * p)
+        {
+            if (p != nullptr)
+                p->~Type();
+        }
+
+
+        /**
+         * @brief Virtual destructor.
+         * 
+         */
+        virtual ~iarena() = default;
+    };
+
+
+    class linear_arena : public iarena
+    {
+        /**
+         * @brief The memory of the arena.
+         * 
+         */
+        unsigned char * _buffer;
+
+
+        /**
+         * @brief The size of the memory, in bytes.
+         * 
+         */
+        uint32_t _capacity;
+
+
+        /**
+         * @brief The number of bytes in use.
+         * 
+         */
+        uint32_t _used;
+
+
+        /**
+         * @brief The largest number of bytes in use.
+         * 
+         */
+        uint32_t _peak;
+
+
+        /**
+         * @brief Where the memory is.
+         * 
+         */
+        ram _where;
+
+
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         * @param buffer The memory of the arena (e.g. a static array in IWRAM or EWRAM).
+         * @param bytes The size of the memory, in bytes.
+         * @param where Where the memory is.
+         */
+        linear_arena(void * buffer, uint32_t bytes, ram where = ram::EWRAM)
+        {
+            _buffer = static_cast<unsigned char *>(buffer);
+            _capacity = bytes;
+            _used = 0;
+            _peak = 0;
+            _where = where;
+        }
+
+
+        /**
+         * @brief Allocate a block of memory, right after the previous one.
+         * 
+         * @param bytes The size of the block.
+         * @param alignment The alignment of the block. (a power of two)
+         * @return void* The block, or `nullptr` if the arena is full.
+         */
+        [[nodiscard]] void * allocate(uint32_t bytes, uint32_t alignment) override
+        {
+            unsigned long address = (unsigned long) (_buffer + _used);
+            uint32_t padding = uint32_t((alignment - (address & (alignment - 1))) & (alignment - 1));
+            if (_used + padding + bytes > _capacity)
+                return nullptr;
+            void * p = _buffer + _used + padding;
+            _used += padding + bytes;
+            if (_used > _peak)
+                _peak = _used;
+            return p;
+        }
+
+
+        /**
+         * @brief Returns the number of bytes in use, to be passed to `release()`.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t mark() override
+        {
+            return _used;
+        }
+
+
+        /**
+         * @brief Release all the blocks allocated after a certain position.
+         * 
+         * @param mark A position returned by `mark()`.
+         */
+        void release(uint32_t mark) override
+        {
+            assert(mark <= _used && "ESA ERROR: arena mark is out of range!");
+            _used = mark;
+        }
+
+
+        /**
+         * @brief Returns where the memory of the arena is.
+         * 
+         * @return ram
+         */
+        [[nodiscard]] ram location() override
+        {
+            return _where;
+        }
+
+
+        /**
+         * @brief Release all the blocks.
+         * 
+         */
+        void reset()
+        {
+            _used = 0;
+        }
+
+
+        /**
+         * @brief Returns the number of bytes in use.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t used()
+        {
+            return _used;
+        }
+
+
+        /**
+         * @brief Returns the size of the arena, in bytes.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t capacity()
+        {
+            return _capacity;
+        }
+
+
+        /**
+         * @brief Returns the largest number of bytes in use since the arena was created.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t peak()
+        {
+            return _peak;
+        }
+    };
+
+
+    template<uint32_t Bytes>
+    class static_arena : public linear_arena
+    {
+        /**
+         * @brief The memory of the arena.
+         * 
+         */
+        alignas(8) unsigned char _memory [ Bytes ];
+
+
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         * @param where Where the arena is. (IWRAM if it is a global or stack object)
+         */
+        static_arena(ram where = ram::EWRAM) : linear_arena(_memory, Bytes, where)
+        {
+
+        }
+    };
+}
+
+#endif
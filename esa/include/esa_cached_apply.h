@@ -16,6 +16,82 @@ namespace esa
         tag_t _tag;
 
 
+        /**
+         * @brief Filter skipping the entities disabled in the table.
+         * 
+         */
+        entity_filter _disabled;
+
+
+#ifdef ESA_ROLLBACK
+        /**
+         * @brief The rollback log of the table. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        rollback_log * _rollback = nullptr;
+
+
+        /**
+         * @brief The rollback epoch in which the state was last saved. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        uint32_t _saved = 0;
+#endif
+
+
+#ifdef ESA_STATE_HASH
+        /**
+         * @brief The hash of the subscribed entities. (only with `ESA_STATE_HASH`)
+         * 
+         */
+        uint32_t _subscribed_hash = 0;
+#endif
+
+
+        protected:
+
+
+        /**
+         * @brief Save the state of the apply object in the rollback log of the table, before it is changed
+         * for the first time in a frame. Does nothing unless `ESA_ROLLBACK` is defined.
+         * 
+         */
+        void _touch()
+        {
+#ifdef ESA_ROLLBACK
+            if (_rollback != nullptr)
+                _rollback->save(rollback_kind::APPLY, _tag, this, _saved);
+#endif
+        }
+
+
+        /**
+         * @brief Add an entity to the hash of the subscribed entities when it subscribes, or remove it
+         * when it unsubscribes. Does nothing unless `ESA_STATE_HASH` is defined.
+         * 
+         * @param e The ID of the entity.
+         */
+        void _hash_subscription(entity e)
+        {
+#ifdef ESA_STATE_HASH
+            _subscribed_hash ^= hash_entry(e, nullptr, 0);
+#endif
+        }
+
+
+        /**
+         * @brief Clear the hash of the subscribed entities, before they are added again (e.g. after restoring a snapshot).
+         * Does nothing unless `ESA_STATE_HASH` is defined.
+         * 
+         */
+        void _reset_subscription_hash()
+        {
+#ifdef ESA_STATE_HASH
+            _subscribed_hash = 0;
+#endif
+        }
+
+
         public:
 
 
@@ -29,6 +105,33 @@ namespace esa
         }
 
 
+#ifdef ESA_STATE_HASH
+        /**
+         * @brief Returns the hash of the entities subscribed to the apply object, in any order. (only with `ESA_STATE_HASH`)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t subscription_hash()
+        {
+            return _subscribed_hash;
+        }
+#endif
+
+
+        /**
+         * @brief Record the changes to the apply object in a rollback log when `ESA_ROLLBACK` is defined.
+         * Called by the table when the apply object is added.
+         * 
+         * @param log The rollback log.
+         */
+        void track(rollback_log * log)
+        {
+#ifdef ESA_ROLLBACK
+            _rollback = log;
+#endif
+        }
+
+
         /**
          * @brief Filter entities processed by this apply based on their components.
          * 
@@ -62,9 +165,80 @@ namespace esa
         virtual void subscribe(entity e) = 0;
 
 
+        /**
+         * @brief Subscribe several entities to the apply object. By default they are subscribed one by one.
+         * 
+         * @param entities The IDs of the entities.
+         * @param count The number of entities.
+         */
+        virtual void subscribe(const entity * entities, uint32_t count)
+        {
+            for (uint32_t i = 0; i < count; i++)
+                subscribe(entities[i]);
+        }
+
+
         virtual void unsubscribe(entity e) = 0;
 
 
+        /**
+         * @brief Returns the number of entities subscribed to the apply object. (including disabled ones)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] virtual uint32_t count()
+        {
+            return 0;
+        }
+
+
+        /**
+         * @brief Returns the maximum number of entities that can be subscribed to the apply object.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] virtual uint32_t capacity()
+        {
+            return 0;
+        }
+
+
+        /**
+         * @brief Attach the filter of the entities disabled in the table.
+         * 
+         * @param f The filter.
+         */
+        void set_filter(entity_filter f)
+        {
+            _disabled = f;
+        }
+
+
+        /**
+         * @brief Tells if some entity is currently disabled in the table.
+         * 
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool filtering()
+        {
+            return _disabled.active();
+        }
+
+
+        /**
+         * @brief Tells if an entity is enabled (not disabled in the table).
+         * 
+         * @param e The ID of the entity.
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool enabled(entity e)
+        {
+            return !_disabled.excludes(e);
+        }
+
+
         /**
          * @brief Returns the unique tag associated to the apply.
          * 
@@ -76,6 +250,22 @@ namespace esa
         }
 
 
+        /**
+         * @brief Write the entities subscribed to the apply object to a snapshot.
+         * 
+         * @param w The snapshot writer.
+         */
+        virtual void save(snapshot_writer & w) = 0;
+
+
+        /**
+         * @brief Replace the entities subscribed to the apply object with the ones read from a snapshot.
+         * 
+         * @param r The snapshot reader.
+         */
+        virtual void load(snapshot_reader & r) = 0;
+
+
         /**
          * @brief Virtual destructor.
          * 
@@ -118,7 +308,37 @@ namespace esa
                     return;
             }
             if (select(e))
+            {
+                _touch();
+                _hash_subscription(e);
                 _entities.push_back(e);
+            }
+        }
+
+
+        /**
+         * @brief Subscribe several entities to the cached apply object. The subscribed entities are checked for duplicates
+         * once for the whole batch.
+         * 
+         * @param entities The IDs of the entities.
+         * @param count The number of entities.
+         */
+        void subscribe(const entity * entities, uint32_t count) override
+        {
+            bool batched = for_each_new(_entities, entities, count, [this](entity e)
+            {
+                if (select(e))
+                {
+                    _touch();
+                    _hash_subscription(e);
+                    _entities.push_back(e);
+                }
+            });
+            if (!batched)
+            {
+                for (uint32_t i = 0; i < count; i++)
+                    subscribe(entities[i]);
+            }
         }
 
 
@@ -132,6 +352,8 @@ namespace esa
             {
                 if (_entities[i] == e)
                 {
+                    _touch();
+                    _hash_subscription(e);
                     _entities.erase(i);
                     break;
                 }
@@ -141,12 +363,72 @@ namespace esa
 
         /**
          * @brief Returns a vector with the IDs of the entities subscribed to this apply.
+         * Entities disabled in the table are skipped.
          * 
          * @return vector<entity, Entities> 
          */
         [[nodiscard]] vector<entity, Entities> subscribed()
         {
-            return _entities;
+            if (!filtering())
+            {
+                ESA_COPY(sizeof(_entities));
+                return _entities;
+            }
+            ESA_COPY(_entities.size() * sizeof(entity));
+            vector<entity, Entities> ids;
+            for (auto e : _entities)
+            {
+                if (enabled(e))
+                    ids.push_back(e);
+            }
+            return ids;
+        }
+
+
+        /**
+         * @brief Returns the number of entities subscribed to the apply object. (including disabled ones)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t count() override
+        {
+            return _entities.size();
+        }
+
+
+        /**
+         * @brief Returns the maximum number of entities that can be subscribed to the apply object. (`Entities`)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t capacity() override
+        {
+            return Entities;
+        }
+
+
+        /**
+         * @brief Write the subscribed entities to a snapshot.
+         * 
+         * @param w The snapshot writer.
+         */
+        void save(snapshot_writer & w) override
+        {
+            w.write_vector(_entities);
+        }
+
+
+        /**
+         * @brief Replace the subscribed entities with the ones read from a snapshot.
+         * 
+         * @param r The snapshot reader.
+         */
+        void load(snapshot_reader & r) override
+        {
+            r.read_vector(_entities);
+            _reset_subscription_hash();
+            for (entity e : _entities)
+                _hash_subscription(e);
         }
 
 
@@ -32,6 +32,16 @@ namespace esa
         }
 
 
+        /**
+         * @brief Constructor keeping the mask already in memory (see `reattach_t`).
+         * 
+         */
+        entity_mask(reattach_t)
+        {
+
+        }
+
+
         /**
          * @brief Marks a certain entity as present.
          * 
@@ -69,6 +79,162 @@ namespace esa
             return ( (_mask[e >> 5] >> (e & 31)) & 1 ) == 1;
         }
 
+
+        /**
+         * @brief Returns 32 bits of the mask (entities `32 * i`...`32 * i + 31`).
+         * 
+         * @param i The index of the word.
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t word(uint32_t i)
+        {
+            assert(i < ((Entities - 1) >> 5) + 1 && "ESA ERROR: entity mask word is out of range!");
+            return _mask[i];
+        }
+
+
+        /**
+         * @brief Returns a pointer to the words of the mask.
+         * 
+         * @return const uint32_t* 
+         */
+        [[nodiscard]] const uint32_t * data()
+        {
+            return _mask;
+        }
+
+
+        /**
+         * @brief Returns the number of entities in the mask.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t count()
+        {
+            uint32_t n = 0;
+            for (uint32_t i = 0; i < ((Entities - 1) >> 5) + 1; i++)
+                n += __builtin_popcount(_mask[i]);
+            return n;
+        }
+
+    };
+
+
+
+    /**
+     * @brief Calls a function once for each entity of a batch that is not already subscribed, nor repeated earlier
+     * in the batch. The subscribed entities are scanned only once for the whole batch, instead of once per entity.
+     * 
+     * @tparam Entities The capacity of the subscriber list.
+     * @tparam Function The type of the function called with each new entity.
+     * @param subscribed The entities already subscribed.
+     * @param entities The IDs of the entities of the batch.
+     * @param count The number of entities of the batch.
+     * @param add The function.
+     * @return false if the IDs of the batch span more than `Entities` values (nothing is called: subscribe them one by one).
+     */
+    template<uint32_t Entities, typename Function>
+    bool for_each_new(vector<entity, Entities> & subscribed, const entity * entities, uint32_t count, Function && add)
+    {
+        if (count == 0)
+            return true;
+        entity lo = entities[0];
+        entity hi = entities[0];
+        for (uint32_t i = 1; i < count; i++)
+        {
+            if (entities[i] < lo)
+                lo = entities[i];
+            if (entities[i] > hi)
+                hi = entities[i];
+        }
+        if (uint32_t(hi - lo) >= Entities)
+            return false;
+        entity_mask<Entities> seen;
+        for (auto e : subscribed)
+        {
+            if (e >= lo && e <= hi)
+                seen.add(e - lo);
+        }
+        for (uint32_t i = 0; i < count; i++)
+        {
+            entity e = entities[i];
+            if (seen.contains(e - lo))
+                continue;
+            seen.add(e - lo);
+            add(e);
+        }
+        return true;
+    }
+
+
+
+    class entity_filter
+    {
+        /**
+         * @brief Words of the mask of the excluded entities. (`nullptr` = no filter attached)
+         * 
+         */
+        const uint32_t * _words;
+
+
+        /**
+         * @brief Number of entities currently excluded.
+         * 
+         */
+        const uint32_t * _count;
+
+
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         */
+        entity_filter()
+        {
+            _words = nullptr;
+            _count = nullptr;
+        }
+
+
+        /**
+         * @brief Attach the filter to an entity mask.
+         * 
+         * @param words The words of the mask.
+         * @param count A pointer to the number of entities in the mask.
+         */
+        void attach(const uint32_t * words, const uint32_t * count)
+        {
+            _words = words;
+            _count = count;
+        }
+
+
+        /**
+         * @brief Tells if the filter currently excludes some entity.
+         * 
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool active()
+        {
+            return _words != nullptr && *_count > 0;
+        }
+
+
+        /**
+         * @brief Tells if an entity is excluded by the filter.
+         * 
+         * @param e The ID of the entity.
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool excludes(entity e)
+        {
+            return active() && ((_words[e >> 5] >> (e & 31)) & 1) == 1;
+        }
+
     };
 }
 
@@ -2,6 +2,7 @@
 #define ESA_ENTITY_TABLE_H
 
 #include <cassert>
+#include <new>
 
 #include "esa.h"
 
@@ -82,6 +83,214 @@ namespace esa
         vector<icached_apply *, Applys> * _applys;
 
 
+        /**
+         * @brief Entity mask storing disabled entities.
+         * 
+         */
+        entity_mask<Entities> _disabled;
+
+
+        /**
+         * @brief The number of disabled entities.
+         * 
+         */
+        uint32_t _disabled_count;
+
+
+        /**
+         * @brief Timers. (allocated when the first timer is scheduled, unless the table uses a `table_storage`)
+         * 
+         */
+        table_timer_wheel<Entities> * _timers;
+
+
+        /**
+         * @brief True if the internals were allocated on the heap by the table.
+         * 
+         */
+        bool _owned;
+
+
+        /**
+         * @brief The arena of the internals and of the timers. (`nullptr` = heap or `table_storage`)
+         * 
+         */
+        iarena * _arena;
+
+
+        /**
+         * @brief The arena of the columns added with `add_component`. (`nullptr` = heap)
+         * 
+         */
+        iarena * _column_arena;
+
+
+        /**
+         * @brief Position of `_arena` before the table allocated from it.
+         * 
+         */
+        uint32_t _arena_mark;
+
+
+        /**
+         * @brief Position of `_column_arena` before the table allocated from it.
+         * 
+         */
+        uint32_t _column_mark;
+
+
+        /**
+         * @brief The number of frames processed by `update()`.
+         * 
+         */
+        uint32_t _frame;
+
+
+        /**
+         * @brief The number of simulation steps processed by `update()`.
+         * 
+         */
+        uint32_t _step;
+
+
+        /**
+         * @brief Duration of a simulation step, used by `update(elapsed)`. (`0` = no fixed timestep)
+         * 
+         */
+        uint32_t _timestep;
+
+
+        /**
+         * @brief Maximum number of simulation steps per frame, used by `update(elapsed)`.
+         * 
+         */
+        uint32_t _max_steps;
+
+
+        /**
+         * @brief Time accumulated and not yet consumed by simulation steps.
+         * 
+         */
+        uint32_t _accumulator;
+
+
+        /**
+         * @brief Structural operations during the current frame.
+         * 
+         */
+        churn _churn;
+
+
+        /**
+         * @brief Structural operations during the last frame.
+         * 
+         */
+        churn _last_churn;
+
+
+        /**
+         * @brief Structural operations since the statistics were reset.
+         * 
+         */
+        churn _total_churn;
+
+
+        /**
+         * @brief The number of frames since the statistics were reset.
+         * 
+         */
+        uint32_t _stats_frames;
+
+
+        /**
+         * @brief The largest number of entities since the statistics were reset.
+         * 
+         */
+        uint32_t _peak_size;
+
+
+        /**
+         * @brief The largest number of rows used since the statistics were reset.
+         * 
+         */
+        uint32_t _peak_used;
+
+
+#ifdef ESA_PROFILER
+        /**
+         * @brief Per-updater profiler. (only with `ESA_PROFILER`)
+         * 
+         */
+        esa::profiler<Updaters, ESA_PROFILER_FRAMES> _profiler;
+#endif
+
+
+#ifdef ESA_TRACE
+        /**
+         * @brief Trace of the last events. (only with `ESA_TRACE`)
+         * 
+         */
+        trace_buffer<ESA_TRACE_EVENTS> _trace;
+#endif
+
+
+#ifdef ESA_FLIGHT_RECORDER
+        /**
+         * @brief Flight recorder of the last frames. (only with `ESA_FLIGHT_RECORDER`)
+         * 
+         */
+        flight_recorder<Updaters, ESA_FLIGHT_RECORDER_FRAMES> _recorder;
+#endif
+
+
+#ifdef ESA_OP_LOG
+        /**
+         * @brief Log of the structural operations. (only with `ESA_OP_LOG`)
+         * 
+         */
+        op_log<ESA_OP_LOG_BYTES> _oplog;
+#endif
+
+
+#ifdef ESA_ROLLBACK
+        /**
+         * @brief Changes made in the last frames, to rewind the table. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        rollback_buffer<ESA_ROLLBACK_BYTES, ESA_ROLLBACK_FRAMES> _rollback;
+
+
+        /**
+         * @brief The entities saved in the rollback log in the current epoch. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        entity_mask<Entities> _touched_rows;
+
+
+        /**
+         * @brief The rollback epoch of `_touched_rows`. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        uint32_t _rows_epoch = 0;
+#endif
+
+
+#ifdef ESA_STATE_HASH
+        /**
+         * @brief The running hash of the entities in the table, disabled and marked for destruction. (only with `ESA_STATE_HASH`)
+         * 
+         */
+        running_hash<Entities> _row_hash;
+
+
+        /**
+         * @brief The running hash of the pooled IDs and of their positions. (only with `ESA_STATE_HASH`)
+         * 
+         */
+        uint32_t _pooled_hash = 0;
+#endif
+
+
         /**
          * @brief Destroy an entity previousy marked for destruction.
          * 
@@ -89,7 +298,19 @@ namespace esa
          */
         void _destory(entity e)
         {
+            _touch_row(e);
+            _unhash_row(e);
+            ESA_TRACE_COUNT(_trace, trace_kind::DESTROYS);
+            ESA_FLIGHT_COUNT(_recorder, destroyed);
+            _churn.destroyed++;
             unsubscribe(e, true);
+            if (_timers != nullptr)
+                _timers->cancel(e);
+            if (_disabled.contains(e))
+            {
+                _disabled.remove(e);
+                _disabled_count--;
+            }
             _emask.remove(e);
             _size--;
             if (e == _used - 1)
@@ -100,339 +321,1838 @@ namespace esa
                     _columns[i]->remove(e);
             }
             if (!_pooled_ids->full())
-                _pooled_ids->push_back(e);
+            {
+#ifdef ESA_ROLLBACK
+                _rollback.record(rollback_kind::POOLED, rollback_pooled { _pooled_ids->size(), _pooled_ids->begin()[_pooled_ids->size()] });
+#endif
+                _push_pooled(e);
+            }
         }
 
 
-        public:
+        /**
+         * @brief Returns where the columns added with `add_component` are: in the column arena, or on the heap (EWRAM).
+         * 
+         * @return ram
+         */
+        [[nodiscard]] ram _column_location()
+        {
+            return _column_arena != nullptr ? _column_arena->location() : ram::EWRAM;
+        }
 
 
         /**
-         * @brief Constructor.
+         * @brief Returns the rollback log of the table (`nullptr` unless `ESA_ROLLBACK` is defined).
          * 
+         * @return rollback_log* 
          */
-        entity_table() : _columns(nullptr)
+        [[nodiscard]] rollback_log * _rollback_log()
         {
-            _used = 0;
-            _size = 0;
-            _pooled_ids = new vector<entity, Entities>();
-            _components_location = new array<ram, Components>();
-            _updaters = new vector<iupdater *, Updaters>();
-            _queries = new vector<icached_query *, Queries>();
-            _applys = new vector<icached_apply *, Applys>();
+#ifdef ESA_ROLLBACK
+            return &_rollback;
+#else
+            return nullptr;
+#endif
         }
 
 
         /**
-         * @brief Tells the number of entities currently in the table.
+         * @brief Save the state of an entity in the rollback log, before it is changed for the first time in a frame.
+         * Does nothing unless `ESA_ROLLBACK` is defined.
          * 
-         * @return uint32_t 
+         * @param e The ID of the entity.
          */
-        [[nodiscard]] uint32_t size()
+        void _touch_row(entity e)
         {
-            return _size;
+#ifdef ESA_ROLLBACK
+            if (!_rollback.recording())
+                return;
+            if (_rows_epoch != _rollback.epoch())
+            {
+                _touched_rows = entity_mask<Entities>();
+                _rows_epoch = _rollback.epoch();
+            }
+            if (_touched_rows.contains(e))
+                return;
+            _touched_rows.add(e);
+            _rollback.record(rollback_kind::ROW, rollback_row { e, _emask.contains(e), _destroyed.contains(e), _disabled.contains(e) });
+#endif
         }
 
 
+#ifdef ESA_STATE_HASH
         /**
-         * @brief Tells the number of rows used in the table up to now.
-         * This may be different from the total number of entities in the table,
-         * as some rows may be currently unused (destroyed entities).
+         * @brief Returns the entry of an entity in the hash of the rows: its ID and whether it is in the table,
+         * disabled or marked for destruction, or `0` if none of these. (only with `ESA_STATE_HASH`)
          * 
+         * @param e The ID of the entity.
          * @return uint32_t 
          */
-        [[nodiscard]] uint32_t used()
+        [[nodiscard]] uint32_t _row_entry(entity e)
         {
-            return _used;
+            unsigned char flags = (_emask.contains(e) ? 1 : 0) | (_destroyed.contains(e) ? 2 : 0) | (_disabled.contains(e) ? 4 : 0);
+            return flags == 0 ? 0 : hash_entry(e, &flags, 1);
         }
 
 
         /**
-         * @brief Tells if the table is full. (that is, if all entity IDs are used)
+         * @brief Returns the entry of a pooled ID in the hash of the pool: the ID and its position. (only with `ESA_STATE_HASH`)
          * 
-         * @return true 
-         * @return false 
+         * @param position The position in the pool.
+         * @return uint32_t 
          */
-        [[nodiscard]] bool full()
+        [[nodiscard]] uint32_t _pooled_entry(uint32_t position)
         {
-            return _size == Entities;
+            return hash_entry(entity(position), &_pooled_ids->begin()[position], sizeof(entity));
         }
 
 
         /**
-         * @brief Create a new entity and return its ID.
+         * @brief Compute the hash of the pool again from all the pooled IDs (e.g. after restoring a snapshot). (only with `ESA_STATE_HASH`)
          * 
-         * @return entity The ID of the newly creatd entity.
          */
-        [[nodiscard]] entity create()
+        void _rehash_pooled()
         {
-            assert(!full() && "ECSA ERROR: all available entity IDs are allocated!");
-            entity e = _used;
-            if (!_pooled_ids->empty())
-            {
-                e = _pooled_ids->back();
-                _pooled_ids->pop_back();
-            }
-            _emask.add(e);
-            _size++;
-            if (e == _used)
-                _used++;
-            return e;
+            _pooled_hash = 0;
+            for (uint32_t i = 0; i < _pooled_ids->size(); i++)
+                _pooled_hash ^= _pooled_entry(i);
         }
+#endif
 
 
         /**
-         * @brief Mark an entity for destruction. The entity
-         * wil be destroyed at the end of the current update
-         * iteration. If some of the entity's component allocates resources,
-         * you should remember to deallocate them inside their destructors.
+         * @brief Add an ID at the end of the pool, updating the hash of the pool.
          * 
          * @param e The ID of the entity.
          */
-        void destroy(entity e)
+        void _push_pooled(entity e)
         {
-            _destroyed.add(e);
+            _pooled_ids->push_back(e);
+#ifdef ESA_STATE_HASH
+            _pooled_hash ^= _pooled_entry(_pooled_ids->size() - 1);
+#endif
         }
 
 
         /**
-         * @brief Delete all the entities from the table.
+         * @brief Remove the ID at the end of the pool, updating the hash of the pool.
          * 
          */
-        void clear()
+        void _pop_pooled()
         {
-            for (entity e = 0; e < used(); e++)
-            {
-                if (contains(e))
-                    destroy(e);
-            }
+#ifdef ESA_STATE_HASH
+            _pooled_hash ^= _pooled_entry(_pooled_ids->size() - 1);
+#endif
+            _pooled_ids->pop_back();
         }
 
 
         /**
-         * @brief Add a new column of a certain data type to the table. A column is
-         * just an array of components. The components data is allocated in EWRAM: if you want it to
-         * be allocated in IWRAM for performance reasons, use `entity_table::add_series` instead.
+         * @brief Remove an entity from the hash of the rows, before it changes. It is added back
+         * by `state_hash()`. Does nothing unless `ESA_STATE_HASH` is defined.
          * 
-         * @tparam ComponentType The data type of the component.
-         * @param tag The unique tag to assign to the component.
+         * @param e The ID of the entity.
          */
-        template<typename ComponentType>
-        void add_component(tag_t tag)
+        void _unhash_row(entity e)
         {
-            assert(_columns[tag] == nullptr);
-            (*_components_location)[tag] = ram::EWRAM;
-            _columns[tag] = new series<ComponentType, Entities>();
+#ifdef ESA_STATE_HASH
+            _row_hash.change(e, [this](entity x) { return _row_entry(x); });
+#endif
         }
 
 
         /**
-         * @brief Obtain a reference to an entity's component, based on its data type and tag.
+         * @brief Save whether an updater is active in the rollback log, before it is activated or deactivated.
+         * Does nothing unless `ESA_ROLLBACK` is defined.
          * 
-         * @tparam ComponentType The data type of the component.
-         * @tparam Tag The unique tag of the component.
-         * @param e The ID of the entity.
-         * @return ComponentType& 
+         * @param u The updater.
          */
-        template<typename ComponentType, tag_t Tag>
-        [[nodiscard]] ComponentType & get(entity e)
+        void _touch_active(iupdater * u)
         {
-            return static_cast<ComponentType &>(static_cast<series<ComponentType, Entities>*>(_columns[Tag])->get(e));
+#ifdef ESA_ROLLBACK
+            _rollback.record(rollback_kind::ACTIVE, rollback_active { u->tag(), u->active() });
+#endif
         }
 
 
         /**
-         * @brief Add a new column to the table. A column is an array of components. 
-         * In this case, the column must have been previously
-         * allocated on the stack (IWRAM), as a `esa::series<ComponentType, Entities>` object.
-         * The `Entities` template parameter of the series should match the one of the entity table.
+         * @brief Start a new frame in the rollback log, saving the counters of the table.
+         * Does nothing unless `ESA_ROLLBACK` is defined.
          * 
-         * @param column A pointer to the series to add (created on the stack, and NOT with `new`).
-         * @param tag The unique tag to associate to this component.
          */
-        void add_series(iseries * s, tag_t tag)
+        void _begin_rollback()
         {
-            assert(_columns[tag] == nullptr);
-            (*_components_location)[tag] = ram::IWRAM;
-            _columns[tag] = s;
+#ifdef ESA_ROLLBACK
+            _rollback.begin_frame();
+            _rollback.record(rollback_kind::FRAME, rollback_frame { _size, _used, _disabled_count, _frame, _step, _accumulator,
+                _pooled_ids->size() });
+#endif
         }
 
 
+#ifdef ESA_ROLLBACK
         /**
-         * @brief Obtain a reference to one of the table's columns.
-         * This is of type `esa::series<ComponentType, Entities>`.
+         * @brief Find an updater by its tag. (only with `ESA_ROLLBACK`)
          * 
-         * @tparam ComponentType The data type of the component.
-         * @param tag The unique tag of the component.
-         * @return series<ComponentType, Entities>& 
+         * @param tag The unique tag of the updater.
+         * @return iupdater* 
          */
-        template<typename ComponentType, tag_t Tag>
-        series<ComponentType, Entities> & get_series()
+        [[nodiscard]] iupdater * _find_updater(tag_t tag)
         {
-            return static_cast<series<ComponentType, Entities> &>(*(_columns[Tag]));
+            for (auto u : *_updaters)
+            {
+                if (u->tag() == tag)
+                    return u;
+            }
+            assert(1 == 2 && "ESA ERROR: updater could not be found!");
+            return nullptr;
+        }
+
+
+        /**
+         * @brief Undo a record of the rollback log. (only with `ESA_ROLLBACK`)
+         * 
+         * @param kind The kind of record.
+         * @param data The bytes of the record.
+         * @param bytes The number of bytes.
+         */
+        void _undo(rollback_kind kind, const unsigned char * data, uint32_t bytes)
+        {
+            tag_t tag = 0;
+            if (kind == rollback_kind::COLUMN || kind == rollback_kind::UPDATER || kind == rollback_kind::QUERY || kind == rollback_kind::APPLY)
+                __builtin_memcpy(&tag, data, sizeof(tag_t));
+            snapshot_reader r(data + sizeof(tag_t), bytes - sizeof(tag_t));
+            switch (kind)
+            {
+                case rollback_kind::FRAME:
+                {
+                    rollback_frame f;
+                    __builtin_memcpy(&f, data, sizeof(f));
+                    _size = f.size;
+                    _used = f.used;
+                    _disabled_count = f.disabled;
+                    _frame = f.frame;
+                    _step = f.step;
+                    _accumulator = f.accumulator;
+                    while (_pooled_ids->size() > f.pooled)
+                        _pop_pooled();
+                    while (_pooled_ids->size() < f.pooled)
+                        _push_pooled(_pooled_ids->begin()[_pooled_ids->size()]);
+                    break;
+                }
+                case rollback_kind::SLOT:
+                {
+                    rollback_slot s;
+                    __builtin_memcpy(&s, data, sizeof(s));
+                    _columns[s.column]->rewind(s.e, s.owned, data + sizeof(s));
+                    break;
+                }
+                case rollback_kind::COLUMN:
+                    _columns[tag]->load(r);
+                    break;
+                case rollback_kind::ROW:
+                {
+                    rollback_row row;
+                    __builtin_memcpy(&row, data, sizeof(row));
+                    _unhash_row(row.e);
+                    if (row.contained)
+                        _emask.add(row.e);
+                    else
+                        _emask.remove(row.e);
+                    if (row.destroyed)
+                        _destroyed.add(row.e);
+                    else
+                        _destroyed.remove(row.e);
+                    if (row.disabled)
+                        _disabled.add(row.e);
+                    else
+                        _disabled.remove(row.e);
+                    break;
+                }
+                case rollback_kind::POOLED:
+                {
+                    rollback_pooled p;
+                    __builtin_memcpy(&p, data, sizeof(p));
+#ifdef ESA_STATE_HASH
+                    bool pooled = p.position < _pooled_ids->size();
+                    if (pooled)
+                        _pooled_hash ^= _pooled_entry(p.position);
+#endif
+                    _pooled_ids->begin()[p.position] = p.e;
+#ifdef ESA_STATE_HASH
+                    if (pooled)
+                        _pooled_hash ^= _pooled_entry(p.position);
+#endif
+                    break;
+                }
+                case rollback_kind::ACTIVE:
+                {
+                    rollback_active a;
+                    __builtin_memcpy(&a, data, sizeof(a));
+                    iupdater * u = _find_updater(a.updater);
+                    if (a.active)
+                        u->activate();
+                    else
+                        u->deactivate();
+                    break;
+                }
+                case rollback_kind::UPDATER:
+                    _find_updater(tag)->load(r);
+                    break;
+                case rollback_kind::SLICE:
+                {
+                    rollback_slice s;
+                    __builtin_memcpy(&s, data, sizeof(s));
+                    static_cast<isliced_updater *>(_find_updater(s.updater))->rewind_position(s.cursor, s.sweeps);
+                    break;
+                }
+                case rollback_kind::QUERY:
+                    for (auto q : *_queries)
+                    {
+                        if (q->tag() == tag)
+                            q->load(r);
+                    }
+                    break;
+                case rollback_kind::APPLY:
+                    for (auto a : *_applys)
+                    {
+                        if (a->tag() == tag)
+                            a->load(r);
+                    }
+                    break;
+                case rollback_kind::TIMER:
+                case rollback_kind::TIMER_FIRST:
+                case rollback_kind::TIMER_HEAD:
+                case rollback_kind::TIMER_STATE:
+                    _timers->rewind(kind, data);
+                    break;
+            }
+        }
+#endif
+
+
+        /**
+         * @brief Returns a checksum of the layout of the table (the size of the content of each column, and the tag of each updater,
+         * cached query and cached apply object), which must match for a snapshot to be restored. It does not depend
+         * on the platform, so that a snapshot taken on the host can be restored on the GBA.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t _layout()
+        {
+            uint32_t h = 2166136261u;
+            for (uint32_t i = 0; i < _columns.size(); i++)
+                h = (h ^ (_columns[i] != nullptr ? _columns[i]->state_bytes() : 0)) * 16777619u;
+            for (auto u : *_updaters)
+                h = (h ^ u->tag()) * 16777619u;
+            for (auto q : *_queries)
+                h = (h ^ q->tag()) * 16777619u;
+            for (auto a : *_applys)
+                h = (h ^ a->tag()) * 16777619u;
+            return h;
+        }
+
+
+        /**
+         * @brief Write the state of the table to a snapshot.
+         * 
+         * @param w The snapshot writer.
+         * @param bytes The size of the snapshot, stored in the header.
+         * @param columns True to save the columns.
+         */
+        void _save(snapshot_writer & w, uint32_t bytes, bool columns)
+        {
+            snapshot_header h { snapshot_header::MAGIC, snapshot_header::VERSION, bytes, Entities, Components,
+                _updaters->size(), _queries->size(), _applys->size(), _layout(), columns ? 1u : 0u };
+            w.write_value(h);
+            w.write_value(_size);
+            w.write_value(_used);
+            w.write_value(_disabled_count);
+            w.write_value(_frame);
+            w.write_value(_step);
+            w.write_value(_accumulator);
+            w.write_value(_emask);
+            w.write_value(_destroyed);
+            w.write_value(_disabled);
+            w.write_vector(*_pooled_ids);
+            bool timers = _timers != nullptr;
+            w.write_value(timers);
+            if (timers)
+                _timers->save(w);
+            for (uint32_t i = 0; i < _columns.size() && columns; i++)
+            {
+                if (_columns[i] != nullptr)
+                    _columns[i]->save(w);
+            }
+            for (auto u : *_updaters)
+            {
+                bool active = u->active();
+                w.write_value(active);
+                u->save(w);
+            }
+            for (auto q : *_queries)
+                q->save(w);
+            for (auto a : *_applys)
+                a->save(w);
+        }
+
+
+        /**
+         * @brief The sections of a frame reported by `_hook`.
+         * 
+         */
+        enum class _section : unsigned char
+        {
+            UPDATER,
+            DESTRUCTION,
+            SUBSCRIPTION
+        };
+
+
+        /**
+         * @brief Reports a section of a frame to the instrumentation enabled, from its construction to its destruction:
+         * the profiler times it, the flight recorder and the trace record it (updaters and destruction only), and the
+         * accesses made by an updater are attributed to it (`ESA_INSTRUMENT`). Does nothing when none is enabled.
+         * 
+         */
+        class _hook
+        {
+            /**
+             * @brief The table.
+             * 
+             */
+            entity_table & _table;
+
+
+            /**
+             * @brief The section.
+             * 
+             */
+            _section _kind;
+
+
+            /**
+             * @brief The slot of the updater. (updaters only)
+             * 
+             */
+            uint32_t _slot;
+
+
+            /**
+             * @brief The tag of the updater. (updaters only)
+             * 
+             */
+            tag_t _tag;
+
+
+#ifdef ESA_PROFILER
+            /**
+             * @brief Profiler time at the beginning of the section.
+             * 
+             */
+            uint32_t _start;
+#endif
+
+
+#ifdef ESA_FLIGHT_RECORDER
+            /**
+             * @brief Flight recorder time at the beginning of the section.
+             * 
+             */
+            uint32_t _recorded;
+#endif
+
+
+            public:
+
+
+            /**
+             * @brief Constructor: the section begins.
+             * 
+             * @param table The table.
+             * @param kind The section.
+             * @param slot The slot of the updater. (updaters only)
+             * @param tag The tag of the updater. (updaters only)
+             */
+            _hook(entity_table & table, _section kind, uint32_t slot = 0, tag_t tag = 0)
+                : _table(table), _kind(kind), _slot(slot), _tag(tag)
+            {
+#ifdef ESA_TRACE
+                if (_kind != _section::SUBSCRIPTION)
+                    _table._trace.begin(_trace_kind(), _trace_id());
+#endif
+#ifdef ESA_INSTRUMENT
+                if (_kind == _section::UPDATER)
+                    instrument::set_updater(_tag);
+#endif
+#ifdef ESA_PROFILER
+                _start = _table._profiler.now();
+#endif
+#ifdef ESA_FLIGHT_RECORDER
+                _recorded = _kind != _section::SUBSCRIPTION ? _table._recorder.now() : 0;
+#endif
+            }
+
+
+            /**
+             * @brief Destructor: the section ends.
+             * 
+             */
+            ~_hook()
+            {
+#ifdef ESA_INSTRUMENT
+                if (_kind == _section::UPDATER)
+                    instrument::set_updater(instrument::NO_TAG);
+#endif
+#ifdef ESA_FLIGHT_RECORDER
+                if (_kind == _section::UPDATER)
+                    _table._recorder.updater_call(_slot, _tag, _table._recorder.now() - _recorded);
+                else if (_kind == _section::DESTRUCTION)
+                    _table._recorder.destruction_call(_table._recorder.now() - _recorded);
+#endif
+#ifdef ESA_PROFILER
+                if (_kind == _section::UPDATER)
+                    _table._profiler.updater_call(_slot, _tag, _table._profiler.now() - _start);
+                else if (_kind == _section::DESTRUCTION)
+                    _table._profiler.destruction_call(_table._profiler.now() - _start);
+                else
+                    _table._profiler.subscription_call(_table._profiler.now() - _start);
+#endif
+#ifdef ESA_TRACE
+                if (_kind != _section::SUBSCRIPTION)
+                    _table._trace.end(_trace_kind(), _trace_id());
+#endif
+            }
+
+
+#ifdef ESA_TRACE
+            /**
+             * @brief Returns the kind of the trace events of the section. (only with `ESA_TRACE`)
+             * 
+             * @return trace_kind 
+             */
+            [[nodiscard]] trace_kind _trace_kind() const
+            {
+                return _kind == _section::UPDATER ? trace_kind::UPDATER : trace_kind::DESTRUCTION;
+            }
+
+
+            /**
+             * @brief Returns the ID of the trace events of the section. (only with `ESA_TRACE`)
+             * 
+             * @return tag_t 
+             */
+            [[nodiscard]] tag_t _trace_id() const
+            {
+                return _kind == _section::UPDATER ? _tag : trace_event::NO_TAG;
+            }
+#endif
+        };
+
+
+        /**
+         * @brief Update the active updaters assigned to a certain phase, in order of insertion.
+         * 
+         * @param p The phase.
+         * @param tick The tick counter used for the updaters' rates.
+         */
+        void _run(esa::phase p, uint32_t tick)
+        {
+            for (uint32_t i = 0; i < _updaters->size(); i++)
+            {
+                iupdater * u = (*_updaters)[i];
+                if (!(u->active()) || u->phase() != p || !(u->due(tick)))
+                    continue;
+                _hook hook(*this, _section::UPDATER, i, u->tag());
+                u->update();
+            }
+        }
+
+
+        /**
+         * @brief Call `f(e)` for each entity in the table that is not disabled, in order of ID,
+         * until `f` returns true. The masks are processed 32 entities at a time.
+         * 
+         * @tparam Function The type of the function.
+         * @param f The function.
+         */
+        template<typename Function>
+        void _scan(Function && f)
+        {
+            if (_used == 0)
+                return;
+            for (uint32_t w = 0; w <= ((_used - 1) >> 5); w++)
+            {
+                uint32_t bits = _emask.word(w) & ~_disabled.word(w);
+                while (bits != 0)
+                {
+                    entity e = (w << 5) | __builtin_ctz(bits);
+                    bits &= bits - 1;
+                    if (f(e))
+                        return;
+                }
+            }
+        }
+
+
+        /**
+         * @brief Entity filter attached to updaters, cached queries and cached apply objects.
+         * 
+         * @return entity_filter 
+         */
+        [[nodiscard]] entity_filter _filter()
+        {
+            entity_filter f;
+            f.attach(_disabled.data(), &_disabled_count);
+            return f;
+        }
+
+
+        /**
+         * @brief Advance the timers by one frame, and deliver the expired ones.
+         * Timers targeting an inactive updater or a disabled entity are parked until the updater
+         * is activated or the entity is enabled.
+         * 
+         */
+        void _expire()
+        {
+            if (_timers == nullptr || _timers->size() == 0)
+                return;
+            _timers->tick([this](entity e, tag_t target)
+            {
+                if (target == table_timer_wheel<Entities>::DESTROY)
+                    return true;
+                for (auto u : *_updaters)
+                {
+                    if (u->tag() == target)
+                        return u->active() && u->enabled(e);
+                }
+                assert(1 == 2 && "ESA ERROR: updater could not be found!");
+                return true;
+            },
+            [this](entity e, tag_t target)
+            {
+                if (target == table_timer_wheel<Entities>::DESTROY)
+                {
+                    destroy(e);
+                    return;
+                }
+                for (auto u : *_updaters)
+                {
+                    if (u->tag() == target)
+                    {
+                        u->expired(e);
+                        return;
+                    }
+                }
+            });
+        }
+
+
+        /**
+         * @brief Destroy all the entities marked for destruction.
+         * 
+         */
+        void _destroy_marked()
+        {
+            {
+                _hook hook(*this, _section::DESTRUCTION);
+                for (entity e = 0; e < _used; e++)
+                {
+                    if (_destroyed.contains(e))
+                    {
+                        _destory(e);
+                        _destroyed.remove(e);
+                    }
+                }
+            }
+#ifdef ESA_PROFILER
+            for (uint32_t i = 0; i < _updaters->size(); i++)
+                _profiler.updater_count(i, (*_updaters)[i]->tag(), (*_updaters)[i]->count());
+            _profiler.end_frame();
+#endif
+        }
+
+
+        /**
+         * @brief Returns the timers, allocating them when the first timer is scheduled.
+         * 
+         * @return table_timer_wheel<Entities>* 
+         */
+        [[nodiscard]] table_timer_wheel<Entities> * _timer_wheel()
+        {
+            if (_timers == nullptr)
+            {
+                _timers = _make<table_timer_wheel<Entities>>(_arena);
+                if (_timers != nullptr)
+                    _timers->track(_rollback_log());
+            }
+            return _timers;
+        }
+
+
+        /**
+         * @brief Create an object in an arena, or on the heap if there is no arena. When `ESA_NO_HEAP`
+         * is defined and there is no arena (e.g. the table uses a `table_storage`), nothing is created.
+         * 
+         * @tparam Type The type of the object.
+         * @param a The arena. (`nullptr` = heap)
+         * @return Type* (`nullptr` if nothing could be created)
+         */
+        template<typename Type>
+        [[nodiscard]] static Type * _make(iarena * a)
+        {
+#ifdef ESA_NO_HEAP
+            assert(a != nullptr && "ESA ERROR: no arena to allocate from, with ESA_NO_HEAP defined!");
+            return a != nullptr ? a->create<Type>() : nullptr;
+#else
+            return a != nullptr ? a->create<Type>() : heap::create<Type>();
+#endif
+        }
+
+
+        /**
+         * @brief Create a column in an arena, or on the heap if there is no arena. An arena may hold the column
+         * created by a previous run, which is then kept (see `iarena::create_column`).
+         * 
+         * @tparam Type The type of the column.
+         * @param a The arena. (`nullptr` = heap)
+         * @return Type* 
+         */
+        template<typename Type>
+        [[nodiscard]] static Type * _make_column(iarena * a)
+        {
+            if (a != nullptr)
+                return a->create_column<Type>();
+            return _make<Type>(a);
+        }
+
+
+        /**
+         * @brief Close the statistics of the current frame.
+         * 
+         */
+        void _end_stats()
+        {
+            _total_churn.created += _churn.created;
+            _total_churn.destroyed += _churn.destroyed;
+            _total_churn.subscribed += _churn.subscribed;
+            _last_churn = _churn;
+            _churn = churn {};
+            _stats_frames++;
+        }
+
+
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         */
+        entity_table() : _columns(nullptr)
+        {
+            _used = 0;
+            _size = 0;
+            _frame = 0;
+            _step = 0;
+            _timestep = 0;
+            _max_steps = 1;
+            _accumulator = 0;
+            _timers = nullptr;
+            _disabled_count = 0;
+            _owned = true;
+            _arena = nullptr;
+            _column_arena = nullptr;
+            _arena_mark = 0;
+            _column_mark = 0;
+            _pooled_ids = heap::create<vector<entity, Entities>>();
+            _components_location = heap::create<array<ram, Components>>();
+            _updaters = heap::create<vector<iupdater *, Updaters>>();
+            _queries = heap::create<vector<icached_query *, Queries>>();
+            _applys = heap::create<vector<icached_apply *, Applys>>();
+            reset_stats();
+        }
+
+
+        /**
+         * @brief Constructor using caller-provided storage for the internals of the table: nothing is allocated
+         * on the heap. With the arena constructor, this is the only constructor available when `ESA_NO_HEAP` is defined.
+         * 
+         * @param storage The storage, usually a static object. It must outlive the table, and it cannot be shared.
+         */
+        entity_table(table_storage<Entities, Components, Updaters, Queries, Applys> & storage) : _columns(nullptr)
+        {
+            _used = 0;
+            _size = 0;
+            _frame = 0;
+            _step = 0;
+            _timestep = 0;
+            _max_steps = 1;
+            _accumulator = 0;
+            _timers = &storage.timers;
+            _disabled_count = 0;
+            _owned = false;
+            _arena = nullptr;
+            _column_arena = nullptr;
+            _arena_mark = 0;
+            _column_mark = 0;
+            _pooled_ids = &storage.pooled_ids;
+            _components_location = &storage.components_location;
+            _updaters = &storage.updaters;
+            _queries = &storage.queries;
+            _applys = &storage.applys;
+            reset_stats();
+        }
+
+
+        /**
+         * @brief Constructor using arenas: the internals of the table and its timers are created in `arena`,
+         * and the columns added with `add_component` in `columns`. Nothing is allocated on the heap, and when
+         * the table is destroyed both arenas are released, in one shot, to where they were before the table
+         * was constructed (so they should not be used for objects that outlive the table in the meantime).
+         * 
+         * @param arena The arena of the internals. (e.g. an `esa::static_arena` in EWRAM)
+         * @param columns The arena of the columns. (e.g. an `esa::static_arena` in IWRAM, or the same arena)
+         */
+        entity_table(iarena & arena, iarena & columns) : _columns(nullptr)
+        {
+            _used = 0;
+            _size = 0;
+            _frame = 0;
+            _step = 0;
+            _timestep = 0;
+            _max_steps = 1;
+            _accumulator = 0;
+            _timers = nullptr;
+            _disabled_count = 0;
+            _owned = false;
+            _arena = &arena;
+            _column_arena = &columns;
+            _arena_mark = arena.mark();
+            _column_mark = columns.mark();
+            _pooled_ids = arena.create<vector<entity, Entities>>();
+            _components_location = arena.create<array<ram, Components>>();
+            _updaters = arena.create<vector<iupdater *, Updaters>>();
+            _queries = arena.create<vector<icached_query *, Queries>>();
+            _applys = arena.create<vector<icached_apply *, Applys>>();
+            reset_stats();
+        }
+
+
+        /**
+         * @brief Constructor using a single arena for the internals of the table, its timers and the columns
+         * added with `add_component`.
+         * 
+         * @param arena The arena.
+         */
+        entity_table(iarena & arena) : entity_table(arena, arena)
+        {
+
+        }
+
+
+        /**
+         * @brief Returns the memory allocated by the table on the heap (EWRAM): pooled IDs, column locations,
+         * lists of updaters, cached queries and cached apply objects, and timers. Columns, updaters, cached queries
+         * and cached apply objects are not included. (see `esa::table_footprint`)
+         * 
+         * @param timers True if the table uses timers (`schedule`, `destroy_after`).
+         * @return footprint 
+         */
+        [[nodiscard]] static constexpr esa::footprint heap_footprint(bool timers)
+        {
+            return esa::footprint { 0, uint32_t(sizeof(vector<entity, Entities>) + sizeof(array<ram, Components>)
+                + sizeof(vector<iupdater *, Updaters>) + sizeof(vector<icached_query *, Queries>)
+                + sizeof(vector<icached_apply *, Applys>) + (timers ? sizeof(table_timer_wheel<Entities>) : 0)) };
+        }
+
+
+        /**
+         * @brief Tells the number of entities currently in the table.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t size()
+        {
+            return _size;
+        }
+
+
+        /**
+         * @brief Tells the number of rows used in the table up to now.
+         * This may be different from the total number of entities in the table,
+         * as some rows may be currently unused (destroyed entities).
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t used()
+        {
+            return _used;
+        }
+
+
+        /**
+         * @brief Tells if the table is full. (that is, if all entity IDs are used)
+         * 
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool full()
+        {
+            return _size == Entities;
+        }
+
+
+        /**
+         * @brief Create a new entity and return its ID.
+         * 
+         * @return entity The ID of the newly creatd entity.
+         */
+        [[nodiscard]] entity create()
+        {
+            assert(!full() && "ECSA ERROR: all available entity IDs are allocated!");
+            ESA_TRACE_COUNT(_trace, trace_kind::CREATES);
+            ESA_FLIGHT_COUNT(_recorder, created);
+            entity e = _used;
+            if (!_pooled_ids->empty())
+            {
+                e = _pooled_ids->back();
+                _pop_pooled();
+            }
+            _touch_row(e);
+            _unhash_row(e);
+            _emask.add(e);
+            _size++;
+            if (e == _used)
+                _used++;
+            _churn.created++;
+            if (_size > _peak_size)
+                _peak_size = _size;
+            if (_used > _peak_used)
+                _peak_used = _used;
+            ESA_LOG_OP(_oplog, entity_op(op_kind::CREATE, e));
+            return e;
+        }
+
+
+        /**
+         * @brief Mark an entity for destruction. The entity
+         * wil be destroyed at the end of the current update
+         * iteration. If some of the entity's component allocates resources,
+         * you should remember to deallocate them inside their destructors.
+         * 
+         * @param e The ID of the entity.
+         */
+        void destroy(entity e)
+        {
+            ESA_LOG_OP(_oplog, entity_op(op_kind::DESTROY, e));
+            _touch_row(e);
+            _unhash_row(e);
+            _destroyed.add(e);
+        }
+
+
+        /**
+         * @brief Delete all the entities from the table.
+         * 
+         */
+        void clear()
+        {
+            for (entity e = 0; e < used(); e++)
+            {
+                if (contains(e))
+                    destroy(e);
+            }
+        }
+
+
+        /**
+         * @brief Returns the size of a snapshot of the table, in bytes.
+         * 
+         * @param columns True to count the columns.
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t snapshot_size(bool columns = true)
+        {
+            snapshot_writer w(nullptr, 0);
+            _save(w, 0, columns);
+            return w.size();
+        }
+
+
+        /**
+         * @brief Save the state of the table to a buffer: the entities, the disabled entities and the ones marked
+         * for destruction, the pooled IDs, the timers, the columns, the subscribers of the updaters, cached queries
+         * and cached apply objects, and which updaters are active. Columns of trivially copyable components take one copy
+         * each; other components are saved by `snapshot_hooks`. The running tasks of task updaters are not saved.
+         * 
+         * Without `columns`, the columns are left out, e.g. because they are kept in a file mapped by `esa::mapped_arena`.
+         * 
+         * @param buffer The buffer.
+         * @param bytes The size of the buffer. (at least `snapshot_size(columns)`)
+         * @param columns True to save the columns.
+         * @return uint32_t The number of bytes written (`0` if the buffer is too small).
+         */
+        uint32_t snapshot(void * buffer, uint32_t bytes, bool columns = true)
+        {
+            uint32_t size = snapshot_size(columns);
+            if (size > bytes)
+                return 0;
+            snapshot_writer w(buffer, bytes);
+            _save(w, size, columns);
+            return w.size();
+        }
+
+
+        /**
+         * @brief Restore the state of the table from a snapshot. The table must have the same template parameters,
+         * columns, updaters, cached queries and cached apply objects as the one that was saved. Nothing happens
+         * to the table if the snapshot does not match it.
+         * 
+         * @param data The snapshot.
+         * @param bytes The size of the snapshot, in bytes.
+         * @param columns True if the snapshot contains the columns (see `snapshot()`).
+         * @return true The table was restored.
+         * @return false The snapshot does not match the table, or is truncated.
+         */
+        bool restore(const void * data, uint32_t bytes, bool columns = true)
+        {
+            if (bytes < sizeof(snapshot_header))
+                return false;
+            snapshot_reader r(data, bytes);
+            snapshot_header h;
+            r.read_value(h);
+            if (h.magic != snapshot_header::MAGIC || h.version != snapshot_header::VERSION || h.bytes > bytes
+                || h.entities != Entities || h.components != Components || h.updaters != _updaters->size()
+                || h.queries != _queries->size() || h.applys != _applys->size() || h.layout != _layout()
+                || h.columns != (columns ? 1u : 0u))
+                return false;
+            r.read_value(_size);
+            r.read_value(_used);
+            r.read_value(_disabled_count);
+            r.read_value(_frame);
+            r.read_value(_step);
+            r.read_value(_accumulator);
+            r.read_value(_emask);
+            r.read_value(_destroyed);
+            r.read_value(_disabled);
+            r.read_vector(*_pooled_ids);
+            bool timers;
+            r.read_value(timers);
+            if (timers)
+                _timer_wheel()->load(r);
+            else if (_timers != nullptr)
+                ::new(static_cast<void*>(_timers)) table_timer_wheel<Entities>();
+            if (_timers != nullptr)
+                _timers->track(_rollback_log());
+            for (uint32_t i = 0; i < _columns.size() && columns; i++)
+            {
+                if (_columns[i] != nullptr)
+                    _columns[i]->load(r);
+            }
+            for (auto u : *_updaters)
+            {
+                bool active;
+                r.read_value(active);
+                if (active)
+                    u->activate();
+                else
+                    u->deactivate();
+                u->load(r);
+            }
+            for (auto q : *_queries)
+                q->load(r);
+            for (auto a : *_applys)
+                a->load(r);
+            assert(r.position() == h.bytes && "ESA ERROR: snapshot does not match the table!");
+#ifdef ESA_ROLLBACK
+            _rollback.clear();
+#endif
+#ifdef ESA_STATE_HASH
+            _row_hash.reset([this](entity x) { return _row_entry(x); });
+            _rehash_pooled();
+#endif
+            if (_size > _peak_size)
+                _peak_size = _size;
+            if (_used > _peak_used)
+                _peak_used = _used;
+            return true;
+        }
+
+
+        /**
+         * @brief Restore the state of the table from a snapshot stored in an array, such as a level image
+         * generated by `esa_snapshot2cpp`, which stays in ROM: the columns are copied to the table in one shot each.
+         * 
+         * @tparam Bytes The size of the array.
+         * @param image The snapshot.
+         * @return true The table was restored.
+         * @return false The snapshot does not match the table.
+         */
+        template<uint32_t Bytes>
+        bool restore(const unsigned char (& image) [ Bytes ])
+        {
+            return restore(image, Bytes);
+        }
+
+
+        /**
+         * @brief Disable an entity: it stays in the table and keeps its subscriptions, but it is
+         * skipped by updaters, cached queries, cached apply objects, function queries and applys.
+         * 
+         * @param e The ID of the entity.
+         */
+        void disable(entity e)
+        {
+            assert(contains(e) && "ESA ERROR: entity is not in the table!");
+            ESA_LOG_OP(_oplog, entity_op(op_kind::DISABLE, e));
+            if (!_disabled.contains(e))
+            {
+                _touch_row(e);
+                _unhash_row(e);
+                _disabled.add(e);
+                _disabled_count++;
+            }
+        }
+
+
+        /**
+         * @brief Enable an entity previously disabled.
+         * 
+         * @param e The ID of the entity.
+         */
+        void enable(entity e)
+        {
+            ESA_LOG_OP(_oplog, entity_op(op_kind::ENABLE, e));
+            if (_disabled.contains(e))
+            {
+                _touch_row(e);
+                _unhash_row(e);
+                _disabled.remove(e);
+                _disabled_count--;
+                if (_timers != nullptr)
+                    _timers->resume_entity(e);
+                for (auto u : *_updaters)
+                    u->reenabled(e);
+            }
+        }
+
+
+        /**
+         * @brief Tells if an entity is enabled (not disabled).
+         * 
+         * @param e The ID of the entity.
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool enabled(entity e)
+        {
+            return !_disabled.contains(e);
+        }
+
+
+        /**
+         * @brief Schedule a timer for an entity: after `frames` calls to `update()`, the
+         * `expired` function of the updater with tag `Tag` is called for the entity.
+         * Timers are cancelled when the entity is destroyed.
+         * 
+         * @tparam Tag The unique tag of the updater.
+         * @param e The ID of the entity.
+         * @param frames The number of frames. (at least `1`)
+         * @return true if the timer was scheduled, false if all the timers of the table are pending
+         * (see `ESA_TIMERS`) or the timers could not be allocated.
+         */
+        template<tag_t Tag>
+        bool schedule(entity e, uint32_t frames)
+        {
+            table_timer_wheel<Entities> * timers = _timer_wheel();
+            return timers != nullptr && timers->schedule(e, Tag, frames);
+        }
+
+
+        /**
+         * @brief Destroy an entity after a certain number of calls to `update()`.
+         * 
+         * @param e The ID of the entity.
+         * @param frames The number of frames. (at least `1`)
+         * @return true if the timer was scheduled, false if all the timers of the table are pending
+         * (see `ESA_TIMERS`) or the timers could not be allocated.
+         */
+        bool destroy_after(entity e, uint32_t frames)
+        {
+            ESA_LOG_OP(_oplog, destroy_after(e, frames));
+            table_timer_wheel<Entities> * timers = _timer_wheel();
+            return timers != nullptr && timers->schedule(e, table_timer_wheel<Entities>::DESTROY, frames);
+        }
+
+
+        /**
+         * @brief Cancel all the timers of an entity.
+         * 
+         * @param e The ID of the entity.
+         */
+        void cancel_timers(entity e)
+        {
+            if (_timers != nullptr)
+                _timers->cancel(e);
+        }
+
+
+        /**
+         * @brief Cancel the timers of an entity scheduled for a certain updater.
+         * 
+         * @tparam Tag The unique tag of the updater.
+         * @param e The ID of the entity.
+         */
+        template<tag_t Tag>
+        void cancel_timer(entity e)
+        {
+            if (_timers != nullptr)
+                _timers->cancel(e, Tag);
+        }
+
+
+        /**
+         * @brief Add a new column of a certain data type to the table. A column is
+         * just an array of components. The components data is allocated in EWRAM (or in the column arena of the
+         * table): if you want it to be allocated in IWRAM for performance reasons, use `entity_table::add_series` instead.
+         * 
+         * @tparam ComponentType The data type of the component.
+         * @param tag The unique tag to assign to the component.
+         */
+        template<typename ComponentType>
+        void add_component(tag_t tag)
+        {
+            assert(_columns[tag] == nullptr);
+            iseries * column = _make_column<series<ComponentType, Entities>>(_column_arena);
+            if (column == nullptr)
+                return;
+            (*_components_location)[tag] = ram::EWRAM;
+            _columns[tag] = column;
+            _columns[tag]->locate(tag, _column_location());
+            _columns[tag]->track(_rollback_log(), tag);
+        }
+
+
+        /**
+         * @brief Obtain a reference to an entity's component, based on its data type and tag.
+         * 
+         * @tparam ComponentType The data type of the component.
+         * @tparam Tag The unique tag of the component.
+         * @param e The ID of the entity.
+         * @return ComponentType& 
+         */
+        template<typename ComponentType, tag_t Tag>
+        [[nodiscard]] ComponentType & get(entity e)
+        {
+            return static_cast<ComponentType &>(static_cast<series<ComponentType, Entities>*>(_columns[Tag])->get(e));
+        }
+
+
+        /**
+         * @brief Obtain a constant reference to an entity's component. Same as `get`, but the component
+         * is not saved for `rewind` nor hashed again by `state_hash`, and it is reported as a read (and not as
+         * a write) when `ESA_INSTRUMENT` is defined.
+         * 
+         * @tparam ComponentType The data type of the component.
+         * @tparam Tag The unique tag of the component.
+         * @param e The ID of the entity.
+         * @return const ComponentType& 
+         */
+        template<typename ComponentType, tag_t Tag>
+        [[nodiscard]] const ComponentType & read(entity e)
+        {
+            return static_cast<series<ComponentType, Entities>*>(_columns[Tag])->read(e);
+        }
+
+
+        /**
+         * @brief Add a new column to the table. A column is an array of components. 
+         * In this case, the column must have been previously
+         * allocated on the stack (IWRAM), as a `esa::series<ComponentType, Entities>` object.
+         * The `Entities` template parameter of the series should match the one of the entity table.
+         * 
+         * @param column A pointer to the series to add (created on the stack, and NOT with `new`).
+         * @param tag The unique tag to associate to this component.
+         */
+        void add_series(iseries * s, tag_t tag)
+        {
+            assert(_columns[tag] == nullptr);
+            (*_components_location)[tag] = ram::IWRAM;
+            _columns[tag] = s;
+            s->locate(tag, ram::IWRAM);
+            s->track(_rollback_log(), tag);
+        }
+
+
+        /**
+         * @brief Obtain a reference to one of the table's columns.
+         * This is of type `esa::series<ComponentType, Entities>`.
+         * 
+         * @tparam ComponentType The data type of the component.
+         * @param tag The unique tag of the component.
+         * @return series<ComponentType, Entities>& 
+         */
+        template<typename ComponentType, tag_t Tag>
+        series<ComponentType, Entities> & get_series()
+        {
+            return static_cast<series<ComponentType, Entities> &>(*(_columns[Tag]));
+        }
+
+
+        /**
+         * @brief Add an indexed component to the table. This is a
+         * column in the table that uses an underying `esa::indexed_series` to
+         * store components (to be used for memory efficiency).
+         * 
+         * @tparam ComponentType The data type of the component.
+         * @tparam Size The maximum number of entities that can own this component.
+         * @param tag The unique tag to associate to this component.
+         */
+        template<typename ComponentType, uint32_t Size>
+        void add_component(tag_t tag)
+        {
+            assert(_columns[tag] == nullptr);
+            iseries * column = _make_column<indexed_series<ComponentType, Size>>(_column_arena);
+            if (column == nullptr)
+                return;
+            (*_components_location)[tag] = ram::EWRAM;
+            _columns[tag] = column;
+            _columns[tag]->locate(tag, _column_location());
+            _columns[tag]->track(_rollback_log(), tag);
+        }
+
+
+        /**
+         * @brief Obtain a reference to an entity's indexed component, based on its data type and tag.
+         * 
+         * @tparam ComponentType The data type of the component.
+         * @tparam Size The size of the underlying indexed series.
+         * @tparam Tag The unique tag of the component.
+         * @param e The ID of the entity.
+         * @return ComponentType& 
+         */
+        template<typename ComponentType, uint32_t Size, tag_t Tag>
+        [[nodiscard]] ComponentType & get(entity e)
+        {
+            return static_cast<ComponentType &>(static_cast<indexed_series<ComponentType, Size>*>(_columns[Tag])->lookup(e));
+        }
+
+
+        /**
+         * @brief Obtain a constant reference to an entity's indexed component. Same as `get`, but the component
+         * is not saved for `rewind` nor hashed again by `state_hash`, and it is reported as a read (and not as
+         * a write) when `ESA_INSTRUMENT` is defined.
+         * 
+         * @tparam ComponentType The data type of the component.
+         * @tparam Size The size of the underlying indexed series.
+         * @tparam Tag The unique tag of the component.
+         * @param e The ID of the entity.
+         * @return const ComponentType& 
+         */
+        template<typename ComponentType, uint32_t Size, tag_t Tag>
+        [[nodiscard]] const ComponentType & read(entity e)
+        {
+            return static_cast<indexed_series<ComponentType, Size>*>(_columns[Tag])->read(e);
+        }
+
+
+        /**
+         * @brief Add a new indexed column to the table. This must be a pointer
+         * to an `esa::indexed_series` object created on the stack (not using `new`).
+         * 
+         * @param column A pointer to the indexed series to add.
+         * @param tag The unique tag to associate to this component.
+         */
+        void add_indexed_series(iseries * s, tag_t tag)
+        {
+            assert(_columns[tag] == nullptr);
+            (*_components_location)[tag] = ram::IWRAM;
+            _columns[tag] = s;
+            s->locate(tag, ram::IWRAM);
+            s->track(_rollback_log(), tag);
+        }
+
+
+        /**
+         * @brief Obtain a reference to one of the table's indexed columns.
+         * This is of type `esa::series<ComponentType, Entities>`.
+         * 
+         * @tparam ComponentType The data type of the component.
+         * @tparam Size the Size of the indexed series.
+         * @param tag The unique tag of the component.
+         * @return series<ComponentType, Entities>& 
+         */
+        template<typename ComponentType, uint32_t Size, tag_t Tag>
+        indexed_series<ComponentType, Size> & get_series()
+        {
+            return static_cast<indexed_series<ComponentType, Size> &>(*(_columns[Tag]));
+        }
+
+
+        /**
+         * @brief Add a component to an entity.
+         * 
+         * @tparam ComponentType The type of the component.
+         * @tparam Tag The unique tag of the component.
+         * @param e The ID of the entity.
+         * @param c An instance of the component.
+         */
+        template<typename ComponentType, tag_t Tag>
+        void add(entity e, const ComponentType & c)
+        {
+            ESA_LOG_OP(_oplog, add(e, Tag, &c, sizeof(ComponentType)));
+            static_cast<series<ComponentType, Entities>*>(_columns[Tag])->add(e, c);
+        }
+
+
+        /**
+         * @brief Add an idnexed component to an entity.
+         * 
+         * @tparam ComponentType The type of the component.
+         * @tparam Size The size of the underline indexed series.
+         * @tparam Tag The unique tag of the component.
+         * @param e The ID of the entity.
+         * @param c An instance of the component.
+         */
+        template<typename ComponentType, uint32_t Size, tag_t Tag>
+        void add(entity e, const ComponentType & c)
+        {
+            ESA_LOG_OP(_oplog, add(e, Tag, &c, sizeof(ComponentType)));
+            static_cast<indexed_series<ComponentType, Size>*>(_columns[Tag])->add(e, c);
+        }
+
+
+        /**
+         * @brief Add a component to an entity from its bytes, e.g. when replaying an operation log.
+         * Only for trivially copyable components.
+         * 
+         * @param e The ID of the entity.
+         * @param tag The unique tag of the component.
+         * @param data The bytes of the component.
+         * @param bytes The size of the component.
+         */
+        void add_bytes(entity e, tag_t tag, const void * data, uint32_t bytes)
+        {
+            assert(tag < Components && _columns[tag] != nullptr && "ESA ERROR: component could not be found!");
+            ESA_LOG_OP(_oplog, add(e, tag, data, bytes));
+            _columns[tag]->add_bytes(e, data, bytes);
+        }
+
+
+        /**
+         * @brief Tells if the entity has a certain component.
+         * 
+         * @tparam Tag The unique tag of the component.
+         * @param e The ID of the entity.
+         * @return true 
+         * @return false 
+         */
+        template<tag_t Tag>
+        [[nodiscard]] bool has(entity e)
+        {
+            return _columns[Tag]->has(e);
+        }
+
+
+        /**
+         * @brief Tells if the table contains a certain entity.
+         * 
+         * @param e The ID of the entity.
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool contains(entity e)
+        {
+            return _emask.contains(e);
+        }
+
+
+        /**
+         * @brief Initialize all the updaters, cached queries and cached apply objects.
+         * 
+         */
+        void init()
+        {
+            for (auto u : *_updaters)
+                u->init();
+            for (auto q : *_queries)
+                q->init();
+            for (auto a : *_applys)
+                a->init();
+        }
+
+
+        /**
+         * @brief Update all updaters, phase by phase (`PRE`, `SIM`, `POST`, `RENDER_EXTRACT`),
+         * in order of insertion within each phase. The `SIM` phase runs exactly once.
+         * Expired timers are delivered first, and entities marked for destruction are destroyed at the end.
+         * 
+         */
+        void update()
+        {
+            ESA_TRACE_SCOPE(_trace, trace_kind::FRAME, trace_event::NO_TAG);
+#ifdef ESA_FLIGHT_RECORDER
+            _recorder.begin_frame(_frame);
+#endif
+            ESA_LOG_OP(_oplog, frame());
+            ESA_LOG_OP(_oplog, set_inner(true));
+            _begin_rollback();
+            _expire();
+            _run(esa::phase::PRE, _frame);
+            _run(esa::phase::SIM, _step);
+            _step++;
+            _run(esa::phase::POST, _frame);
+            _run(esa::phase::RENDER_EXTRACT, _frame);
+            _destroy_marked();
+            _end_stats();
+            ESA_LOG_OP(_oplog, set_inner(false));
+#ifdef ESA_INSTRUMENT
+            instrument::end_frame();
+#endif
+#ifdef ESA_FLIGHT_RECORDER
+            _recorder.end_frame(_size);
+#endif
+            _frame++;
+        }
+
+
+        /**
+         * @brief Update all updaters using a fixed timestep (see `set_timestep`). The elapsed
+         * time is accumulated, and the `SIM` phase runs once for every full timestep available
+         * (at most `max_steps` times, the exceeding time is dropped). The other phases run once.
+         * 
+         * @param elapsed The time elapsed since the previous frame. (same unit as the timestep)
+         */
+        void update(uint32_t elapsed)
+        {
+            ESA_TRACE_SCOPE(_trace, trace_kind::FRAME, trace_event::NO_TAG);
+#ifdef ESA_FLIGHT_RECORDER
+            _recorder.begin_frame(_frame);
+#endif
+            assert(_timestep > 0 && "ESA ERROR: no fixed timestep was set for the table!");
+            ESA_LOG_OP(_oplog, frame(elapsed));
+            ESA_LOG_OP(_oplog, set_inner(true));
+            _begin_rollback();
+            _accumulator += elapsed;
+            _expire();
+            _run(esa::phase::PRE, _frame);
+            uint32_t steps = 0;
+            while (_accumulator >= _timestep && steps < _max_steps)
+            {
+                _run(esa::phase::SIM, _step);
+                _step++;
+                steps++;
+                _accumulator -= _timestep;
+            }
+            if (_accumulator >= _timestep)
+                _accumulator %= _timestep;
+            _run(esa::phase::POST, _frame);
+            _run(esa::phase::RENDER_EXTRACT, _frame);
+            _destroy_marked();
+            _end_stats();
+            ESA_LOG_OP(_oplog, set_inner(false));
+#ifdef ESA_INSTRUMENT
+            instrument::end_frame();
+#endif
+#ifdef ESA_FLIGHT_RECORDER
+            _recorder.end_frame(_size);
+#endif
+            _frame++;
+        }
+
+
+        /**
+         * @brief Set the fixed timestep used by `update(elapsed)`.
+         * 
+         * @param timestep The duration of a simulation step. (any unit: cycles, microseconds, ...)
+         * @param max_steps The maximum number of simulation steps per frame.
+         */
+        void set_timestep(uint32_t timestep, uint32_t max_steps)
+        {
+            assert(timestep > 0 && "ESA ERROR: the timestep must be larger than zero!");
+            assert(max_steps > 0 && "ESA ERROR: at least one simulation step per frame is required!");
+            _timestep = timestep;
+            _max_steps = max_steps;
+            _accumulator = 0;
+        }
+
+
+        /**
+         * @brief Returns the time accumulated by `update(elapsed)` and not yet consumed
+         * by a simulation step (useful to interpolate rendering between two steps).
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t accumulator()
+        {
+            return _accumulator;
+        }
+
+
+        /**
+         * @brief Returns the number of frames processed by the table.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t frame()
+        {
+            return _frame;
+        }
+
+
+        /**
+         * @brief Returns the number of simulation steps processed by the table.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t step()
+        {
+            return _step;
+        }
+
+
+        /**
+         * @brief Returns the occupancy, fragmentation and churn of the table: holes below the `used()` watermark,
+         * pooled IDs, high-water marks, and entities created, destroyed and subscribed during the last frame.
+         * 
+         * @return table_stats 
+         */
+        [[nodiscard]] table_stats stats()
+        {
+            table_stats s;
+            s.entities = _size;
+            s.capacity = Entities;
+            s.used = _used;
+            s.holes = _used - _size;
+            s.pooled = _pooled_ids->size();
+            s.disabled = _disabled_count;
+            s.peak_entities = _peak_size;
+            s.peak_used = _peak_used;
+            s.frames = _stats_frames;
+            s.last = _last_churn;
+            s.total = _total_churn;
+            return s;
+        }
+
+
+        /**
+         * @brief Reset the high-water marks and the totals of `stats()`.
+         * 
+         */
+        void reset_stats()
+        {
+            _churn = churn {};
+            _last_churn = churn {};
+            _total_churn = churn {};
+            _stats_frames = 0;
+            _peak_size = _size;
+            _peak_used = _used;
+        }
+
+
+        /**
+         * @brief Returns the number of entities owning a component, against the capacity of its column
+         * (`Entities` for series, `Size` for indexed series).
+         * 
+         * @tparam Tag The unique tag of the component.
+         * @return usage 
+         */
+        template<tag_t Tag>
+        [[nodiscard]] usage column_usage()
+        {
+            assert(_columns[Tag] != nullptr && "ESA ERROR: component could not be found!");
+            return usage { _columns[Tag]->count(), _columns[Tag]->capacity() };
+        }
+
+
+        /**
+         * @brief Returns the column of a component through its base class, e.g. to read its size,
+         * or `nullptr` if the component was not added.
+         * 
+         * @param tag The unique tag of the component.
+         * @return iseries*
+         */
+        [[nodiscard]] iseries * column(tag_t tag)
+        {
+            assert(tag < Components && "ESA ERROR: component tag out of range!");
+            return _columns[tag];
         }
 
 
         /**
-         * @brief Add an indexed component to the table. This is a
-         * column in the table that uses an underying `esa::indexed_series` to
-         * store components (to be used for memory efficiency).
+         * @brief Returns the number of entities subscribed to an updater, against its capacity.
+         * (running tasks for task updaters, `0` for table updaters)
          * 
-         * @tparam ComponentType The data type of the component.
-         * @tparam Size The maximum number of entities that can own this component.
-         * @param tag The unique tag to associate to this component.
+         * @tparam Tag The unique tag of the updater.
+         * @return usage 
          */
-        template<typename ComponentType, uint32_t Size>
-        void add_component(tag_t tag)
+        template<tag_t Tag>
+        [[nodiscard]] usage updater_usage()
         {
-            assert(_columns[tag] == nullptr);
-            (*_components_location)[tag] = ram::EWRAM;
-            _columns[tag] = new indexed_series<ComponentType, Size>();
+            iupdater * u = get_updater<Tag>();
+            return usage { u->count(), u->capacity() };
         }
 
 
         /**
-         * @brief Obtain a reference to an entity's indexed component, based on its data type and tag.
+         * @brief Returns the number of entities subscribed to a cached query, against its capacity.
          * 
-         * @tparam ComponentType The data type of the component.
-         * @tparam Size The size of the underlying indexed series.
-         * @tparam Tag The unique tag of the component.
-         * @param e The ID of the entity.
-         * @return ComponentType& 
+         * @tparam Tag The unique tag of the cached query.
+         * @return usage 
          */
-        template<typename ComponentType, uint32_t Size, tag_t Tag>
-        [[nodiscard]] ComponentType & get(entity e)
+        template<tag_t Tag>
+        [[nodiscard]] usage query_usage()
         {
-            return static_cast<ComponentType &>(static_cast<indexed_series<ComponentType, Size>*>(_columns[Tag])->lookup(e));
+            icached_query * q = get_query<Tag>();
+            return usage { q->count(), q->capacity() };
         }
 
 
         /**
-         * @brief Add a new indexed column to the table. This must be a pointer
-         * to an `esa::indexed_series` object created on the stack (not using `new`).
+         * @brief Returns the number of entities subscribed to a cached apply object, against its capacity.
          * 
-         * @param column A pointer to the indexed series to add.
-         * @param tag The unique tag to associate to this component.
+         * @tparam Tag The unique tag of the cached apply object.
+         * @return usage 
          */
-        void add_indexed_series(iseries * s, tag_t tag)
+        template<tag_t Tag>
+        [[nodiscard]] usage apply_usage()
         {
-            assert(_columns[tag] == nullptr);
-            (*_components_location)[tag] = ram::IWRAM;
-            _columns[tag] = s;
+            icached_apply * a = get_apply<Tag>();
+            return usage { a->count(), a->capacity() };
         }
 
 
+#ifdef ESA_FLIGHT_RECORDER
         /**
-         * @brief Obtain a reference to one of the table's indexed columns.
-         * This is of type `esa::series<ComponentType, Entities>`.
+         * @brief Returns the flight recorder, which keeps the last frames (time of each updater, entities
+         * created, destroyed and subscribed, queries) and dumps them when a frame is too slow.
+         * No frame is recorded until a clock is set. (only with `ESA_FLIGHT_RECORDER`)
          * 
-         * @tparam ComponentType The data type of the component.
-         * @tparam Size the Size of the indexed series.
-         * @param tag The unique tag of the component.
-         * @return series<ComponentType, Entities>& 
+         * @return flight_recorder<Updaters, ESA_FLIGHT_RECORDER_FRAMES>& 
          */
-        template<typename ComponentType, uint32_t Size, tag_t Tag>
-        indexed_series<ComponentType, Size> & get_series()
+        [[nodiscard]] flight_recorder<Updaters, ESA_FLIGHT_RECORDER_FRAMES> & recorder()
         {
-            return static_cast<indexed_series<ComponentType, Size> &>(*(_columns[Tag]));
+            return _recorder;
         }
+#endif
 
 
+#ifdef ESA_STATE_HASH
         /**
-         * @brief Add a component to an entity.
+         * @brief Returns a hash of the state of the table, to detect desyncs between machines running the same simulation:
+         * the counters of the table, the pooled IDs, the entities (disabled and marked for destruction), the components, the pending timers,
+         * the entities subscribed to each updater, cached query and cached apply object, and which updaters are active.
+         * Each part keeps a running hash, updated as it changes: the cost depends on what changed since the last call,
+         * not on the number of entities. A component obtained with `get` counts as changed even if it is only read, and is
+         * hashed again: use `read` for read-only accesses. (only with `ESA_STATE_HASH`)
          * 
-         * @tparam ComponentType The type of the component.
-         * @tparam Tag The unique tag of the component.
-         * @param e The ID of the entity.
-         * @param c An instance of the component.
+         * @return uint32_t 
          */
-        template<typename ComponentType, tag_t Tag>
-        void add(entity e, const ComponentType & c)
+        [[nodiscard]] uint32_t state_hash()
         {
-            static_cast<series<ComponentType, Entities>*>(_columns[Tag])->add(e, c);
+            uint32_t h = hash_combine(_size, _used);
+            h = hash_combine(h, _disabled_count);
+            h = hash_combine(h, _frame);
+            h = hash_combine(h, _step);
+            h = hash_combine(h, _accumulator);
+            h = hash_combine(h, _pooled_ids->size());
+            h = hash_combine(h, _pooled_hash);
+            h = hash_combine(h, _row_hash.value([this](entity x) { return _row_entry(x); }));
+            for (uint32_t i = 0; i < _columns.size(); i++)
+                h = hash_combine(h, _columns[i] != nullptr ? _columns[i]->hash() : 0);
+            for (auto u : *_updaters)
+            {
+                h = hash_combine(h, u->tag() | (u->active() ? 0x10000 : 0));
+                h = hash_combine(h, u->subscription_hash());
+            }
+            for (auto q : *_queries)
+                h = hash_combine(h, q->subscription_hash());
+            for (auto a : *_applys)
+                h = hash_combine(h, a->subscription_hash());
+            if (_timers != nullptr)
+            {
+                h = hash_combine(h, _timers->now());
+                h = hash_combine(h, _timers->hash());
+            }
+            return h;
         }
+#endif
 
 
+#ifdef ESA_OP_LOG
         /**
-         * @brief Add an idnexed component to an entity.
+         * @brief Returns the log of the structural operations made on the table (entities created, destroyed,
+         * disabled and enabled, components added, subscriptions, updaters activated and deactivated, frames),
+         * to be replayed on the host with `esa::replay_ops`. (only with `ESA_OP_LOG`)
          * 
-         * @tparam ComponentType The type of the component.
-         * @tparam Size The size of the underline indexed series.
-         * @tparam Tag The unique tag of the component.
-         * @param e The ID of the entity.
-         * @param c An instance of the component.
+         * @return op_log<ESA_OP_LOG_BYTES>& 
          */
-        template<typename ComponentType, uint32_t Size, tag_t Tag>
-        void add(entity e, const ComponentType & c)
+        [[nodiscard]] op_log<ESA_OP_LOG_BYTES> & oplog()
         {
-            static_cast<indexed_series<ComponentType, Size>*>(_columns[Tag])->add(e, c);
+            return _oplog;
         }
+#endif
 
 
+#ifdef ESA_ROLLBACK
         /**
-         * @brief Tells if the entity has a certain component.
+         * @brief Returns the log of the changes made in the last frames. (only with `ESA_ROLLBACK`)
          * 
-         * @tparam Tag The unique tag of the component.
-         * @param e The ID of the entity.
-         * @return true 
-         * @return false 
+         * @return rollback_log& 
          */
-        template<tag_t Tag>
-        [[nodiscard]] bool has(entity e)
+        [[nodiscard]] rollback_log & rollback()
         {
-            return _columns[Tag]->has(e);
+            return _rollback;
         }
 
 
         /**
-         * @brief Tells if the table contains a certain entity.
+         * @brief Bring the table back to its state at the beginning of an earlier call to `update()`: `rewind(1)` undoes
+         * the changes made since the last call to `update()` began, `rewind(n)` the ones of the last `n` frames.
+         * The cost depends on what changed in those frames, not on the size of the table: a component obtained with `get`
+         * is saved once per frame even if it is only read, so use `read` for read-only accesses. Call `update()` again to
+         * simulate the frames again. (only with `ESA_ROLLBACK`)
          * 
-         * @param e The ID of the entity.
-         * @return true 
-         * @return false 
+         * @param frames The number of frames. (at most `rollback().frames()`)
          */
-        [[nodiscard]] bool contains(entity e)
+        void rewind(uint32_t frames)
         {
-            return _emask.contains(e);
+            _rollback.rewind(frames, [this](rollback_kind kind, const unsigned char * data, uint32_t bytes)
+            {
+                _undo(kind, data, bytes);
+            });
         }
+#endif
 
 
+#ifdef ESA_TRACE
         /**
-         * @brief Initialize all the updaters, cached queries and cached apply objects.
+         * @brief Returns the trace buffer, which records the frames, the updaters, the queries, the apply
+         * operations and the destruction pass. No event is recorded until a clock is set. (only with `ESA_TRACE`)
          * 
+         * @return trace_buffer<ESA_TRACE_EVENTS>& 
          */
-        void init()
+        [[nodiscard]] trace_buffer<ESA_TRACE_EVENTS> & trace()
         {
-            for (auto u : *_updaters)
-                u->init();
-            for (auto q : *_queries)
-                q->init();
-            for (auto a : *_applys)
-                a->init();
+            return _trace;
         }
+#endif
 
 
+#ifdef ESA_PROFILER
         /**
-         * @brief Update all updaters, in order of insertion.
+         * @brief Returns the profiler, which times each updater, the end-of-frame destruction and
+         * the subscriptions. No time is recorded until a clock is set. (only with `ESA_PROFILER`)
          * 
+         * @return esa::profiler<Updaters, ESA_PROFILER_FRAMES>& 
          */
-        void update()
+        [[nodiscard]] esa::profiler<Updaters, ESA_PROFILER_FRAMES> & profiler()
         {
-            for (auto u : *_updaters)
-            {
-                if (!(u->active()))
-                    continue;
-                u->update();
-            }
-            for (entity e = 0; e < _used; e++)
-            {
-                if (_destroyed.contains(e))
-                {
-                    _destory(e);
-                    _destroyed.remove(e);
-                }
-            }
+            return _profiler;
         }
+#endif
 
 
         /**
@@ -443,6 +2163,10 @@ namespace esa
          */
         void subscribe(entity e)
         {
+            ESA_LOG_OP(_oplog, entity_op(op_kind::SUBSCRIBE, e));
+            ESA_FLIGHT_COUNT(_recorder, subscribed);
+            _churn.subscribed++;
+            _hook hook(*this, _section::SUBSCRIPTION);
             for (auto u : *_updaters)
             {
                 if (u->subscribable())
@@ -458,6 +2182,39 @@ namespace esa
         }
 
 
+        /**
+         * @brief Subscribe several entities to all the relevant entity updaters, cached queries and cached apply objects.
+         * Each updater, cached query and cached apply object is given the whole batch, and checks its subscribers for
+         * duplicates once instead of once per entity, which is cheaper when many entities are created at once
+         * (e.g. by `esa::level_stream`).
+         * 
+         * @param entities The IDs of the entities.
+         * @param count The number of entities.
+         */
+        void subscribe(const entity * entities, uint32_t count)
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                ESA_LOG_OP(_oplog, entity_op(op_kind::SUBSCRIBE, entities[i]));
+                ESA_FLIGHT_COUNT(_recorder, subscribed);
+            }
+            _churn.subscribed += count;
+            _hook hook(*this, _section::SUBSCRIPTION);
+            for (auto u : *_updaters)
+            {
+                if (u->subscribable())
+                {
+                    isubscribable_updater * su = static_cast<isubscribable_updater *>(u);
+                    su->subscribe(entities, count);
+                }
+            }
+            for (auto q : *_queries)
+                q->subscribe(entities, count);
+            for (auto a : *_applys)
+                a->subscribe(entities, count);
+        }
+
+
         /**
          * @brief Unsubscribe an entity to all the entity updaters, cached queries and cached apply objects.
          * 
@@ -465,6 +2222,8 @@ namespace esa
          */
         void unsubscribe(entity e)
         {
+            ESA_LOG_OP(_oplog, entity_op(op_kind::UNSUBSCRIBE, e));
+            _hook hook(*this, _section::SUBSCRIPTION);
             unsubscribe(e, false);
         }
 
@@ -493,6 +2252,8 @@ namespace esa
          */
         void add_updater(iupdater * u)
         {
+            u->set_filter(_filter());
+            u->track(_rollback_log());
             _updaters->push_back(u);
         }
 
@@ -508,6 +2269,8 @@ namespace esa
         {
             if (!active)
                 u->deactivate();
+            u->set_filter(_filter());
+            u->track(_rollback_log());
             _updaters->push_back(u);
         }
 
@@ -519,6 +2282,8 @@ namespace esa
          */
         void add_query(icached_query* q)
         {
+            q->set_filter(_filter());
+            q->track(_rollback_log());
             _queries->push_back(q);
         }
 
@@ -530,6 +2295,8 @@ namespace esa
          */
         void add_apply(icached_apply* a)
         {
+            a->set_filter(_filter());
+            a->track(_rollback_log());
             _applys->push_back(a);
         }
 
@@ -561,13 +2328,28 @@ namespace esa
         template<tag_t Tag>
         void activate_updater()
         {
+            activate_updater(Tag);
+        }
+
+
+        /**
+         * @brief Make an updater active (its `update` function will be executed).
+         * 
+         * @param tag The unique tag of the updater.
+         */
+        void activate_updater(tag_t tag)
+        {
+            ESA_LOG_OP(_oplog, updater_op(op_kind::ACTIVATE, tag));
             for (auto u : *_updaters)
             {
-                if (u->tag() == Tag)
+                if (u->tag() == tag)
                 {
+                    _touch_active(u);
                     u->activate();
+                    if (_timers != nullptr)
+                        _timers->resume_target(tag);
                     return;
-                }       
+                }
             }
             assert(1 == 2 && "ESA ERROR: updater could not be found!");
         }
@@ -581,10 +2363,23 @@ namespace esa
         template<tag_t Tag>
         void deactivate_updater()
         {
+            deactivate_updater(Tag);
+        }
+
+
+        /**
+         * @brief Make an updater inactive (its `update` function will not be executed).
+         * 
+         * @param tag The unique tag of the updater.
+         */
+        void deactivate_updater(tag_t tag)
+        {
+            ESA_LOG_OP(_oplog, updater_op(op_kind::DEACTIVATE, tag));
             for (auto u : *_updaters)
             {
-                if (u->tag() == Tag)
+                if (u->tag() == tag)
                 {
+                    _touch_active(u);
                     u->deactivate();
                     return;
                 }
@@ -593,14 +2388,79 @@ namespace esa
         }
 
 
+        /**
+         * @brief Assign an updater to a phase of `update()`.
+         * 
+         * @tparam Tag The unique tag of the updater.
+         * @param p The phase.
+         */
+        template<tag_t Tag>
+        void set_updater_phase(esa::phase p)
+        {
+            get_updater<Tag>()->set_phase(p);
+        }
+
+
+        /**
+         * @brief Make an updater run once every `period` ticks of its phase 
+         * (frames, or simulation steps for the `SIM` phase).
+         * 
+         * @tparam Tag The unique tag of the updater.
+         * @param period The number of ticks between two runs.
+         * @param offset The tick on which the updater runs (`0`...`period - 1`).
+         */
+        template<tag_t Tag>
+        void set_updater_rate(uint32_t period, uint32_t offset)
+        {
+            get_updater<Tag>()->set_rate(period, offset);
+        }
+
+
+        /**
+         * @brief Set the maximum number of entities a sliced updater processes per frame.
+         * 
+         * @tparam Tag The unique tag of the sliced updater.
+         * @param entities The number of entities. (`0` = no limit)
+         */
+        template<tag_t Tag>
+        void set_updater_budget(uint32_t entities)
+        {
+            iupdater * u = get_updater<Tag>();
+            assert(u->sliced() && "ESA ERROR: the updater is not a sliced updater!");
+            static_cast<isliced_updater *>(u)->set_budget(entities);
+        }
+
+
+        /**
+         * @brief Set the maximum time a sliced updater spends per frame.
+         * 
+         * @tparam Tag The unique tag of the sliced updater.
+         * @param clock A function returning the current time.
+         * @param budget The time budget, in clock units.
+         */
+        template<tag_t Tag>
+        void set_updater_time_budget(clock_fn clock, uint32_t budget)
+        {
+            iupdater * u = get_updater<Tag>();
+            assert(u->sliced() && "ESA ERROR: the updater is not a sliced updater!");
+            static_cast<isliced_updater *>(u)->set_time_budget(clock, budget);
+        }
+
+
         /**
          * @brief Make all updaters attached to the table active (their `update` function will be executed).
          * 
          */
         void activate_all_updaters()
         {
+            ESA_LOG_OP(_oplog, op(op_kind::ACTIVATE_ALL));
             for (auto u : *_updaters)
+            {
+                _touch_active(u);
                 u->activate();
+                if (_timers != nullptr)
+                    _timers->resume_target(u->tag());
+            }
         }
 
 
@@ -610,8 +2470,12 @@ namespace esa
          */
         void deactivate_all_updaters()
         {
+            ESA_LOG_OP(_oplog, op(op_kind::DEACTIVATE_ALL));
             for (auto u : *_updaters)
+            {
+                _touch_active(u);
                 u->deactivate();
+            }
         }
 
 
@@ -624,9 +2488,22 @@ namespace esa
         template<tag_t Tag>
         void unsubscribe_from_updater(entity e)
         {
+            unsubscribe_from_updater(e, Tag);
+        }
+
+
+        /**
+         * @brief Unsubscribe an entity from an entity udpater.
+         * 
+         * @param e The ID of the entity.
+         * @param tag The unique tag of the updater.
+         */
+        void unsubscribe_from_updater(entity e, tag_t tag)
+        {
+            ESA_LOG_OP(_oplog, subscription_op(op_kind::UNSUBSCRIBE_UPDATER, e, tag));
             for (auto u : *_updaters)
             {
-                if (u->tag() == Tag)
+                if (u->tag() == tag)
                 {
                     isubscribable_updater * su = static_cast<isubscribable_updater *>(u);
                     su->unsubscribe(e);
@@ -646,9 +2523,22 @@ namespace esa
         template<tag_t Tag>
         void subscribe_to_updater(entity e)
         {
+            subscribe_to_updater(e, Tag);
+        }
+
+
+        /**
+         * @brief Subscribe an entity to an entity udpater.
+         * 
+         * @param e The ID of the entity.
+         * @param tag The unique tag of the updater.
+         */
+        void subscribe_to_updater(entity e, tag_t tag)
+        {
+            ESA_LOG_OP(_oplog, subscription_op(op_kind::SUBSCRIBE_UPDATER, e, tag));
             for (auto u : *_updaters)
             {
-                if (u->tag() == Tag)
+                if (u->tag() == tag)
                 {
                     isubscribable_updater* su = static_cast<isubscribable_updater*>(u);
                     su->subscribe(e);
@@ -687,9 +2577,22 @@ namespace esa
         template<tag_t Tag>
         void unsubscribe_from_query(entity e)
         {
+            unsubscribe_from_query(e, Tag);
+        }
+
+
+        /**
+         * @brief Unsubscribe an entity from a cached query.
+         * 
+         * @param e The ID of the entity.
+         * @param tag The unique tag of the cached query.
+         */
+        void unsubscribe_from_query(entity e, tag_t tag)
+        {
+            ESA_LOG_OP(_oplog, subscription_op(op_kind::UNSUBSCRIBE_QUERY, e, tag));
             for (auto q : *_queries)
             {
-                if (q->tag() == Tag)
+                if (q->tag() == tag)
                 {
                     q->unsubscribe(e);
                     return;
@@ -708,9 +2611,22 @@ namespace esa
         template<tag_t Tag>
         void subscribe_to_query(entity e)
         {
+            subscribe_to_query(e, Tag);
+        }
+
+
+        /**
+         * @brief Subscribe an entity to a cached query.
+         * 
+         * @param e The ID of the entity.
+         * @param tag The unique tag of the cached query.
+         */
+        void subscribe_to_query(entity e, tag_t tag)
+        {
+            ESA_LOG_OP(_oplog, subscription_op(op_kind::SUBSCRIBE_QUERY, e, tag));
             for (auto q : *_queries)
             {
-                if (q->tag() == Tag)
+                if (q->tag() == tag)
                 {
                     q->subscribe(e);
                     return;
@@ -748,9 +2664,22 @@ namespace esa
         template<tag_t Tag>
         void unsubscribe_from_apply(entity e)
         {
+            unsubscribe_from_apply(e, Tag);
+        }
+
+
+        /**
+         * @brief Unsubscribe an entity from a cached apply object.
+         * 
+         * @param e The ID of the entity.
+         * @param tag The unique tag of the cached apply object.
+         */
+        void unsubscribe_from_apply(entity e, tag_t tag)
+        {
+            ESA_LOG_OP(_oplog, subscription_op(op_kind::UNSUBSCRIBE_APPLY, e, tag));
             for (auto a : *_applys)
             {
-                if (a->tag() == Tag)
+                if (a->tag() == tag)
                 {
                     a->unsubscribe(e);
                     return;
@@ -769,9 +2698,22 @@ namespace esa
         template<tag_t Tag>
         void subscribe_to_apply(entity e)
         {
+            subscribe_to_apply(e, Tag);
+        }
+
+
+        /**
+         * @brief Subscribe an entity to a cached apply object.
+         * 
+         * @param e The ID of the entity.
+         * @param tag The unique tag of the cached apply object.
+         */
+        void subscribe_to_apply(entity e, tag_t tag)
+        {
+            ESA_LOG_OP(_oplog, subscription_op(op_kind::SUBSCRIBE_APPLY, e, tag));
             for (auto a : *_applys)
             {
-                if (a->tag() == Tag)
+                if (a->tag() == tag)
                 {
                     a->subscribe(e);
                     return;
@@ -793,6 +2735,8 @@ namespace esa
         {
             assert(MaxEntities <= Entities && "ESA ERROR: query cannot ask for more entities than the table contains!");
             vector<entity, MaxEntities> ids;
+            ESA_TRACE_SCOPE(_trace, trace_kind::QUERY, Tag);
+            ESA_FLIGHT_COUNT(_recorder, queried);
             cached_query<MaxEntities> * q = static_cast<cached_query<MaxEntities> *>(get_query<Tag>());
             assert(q != nullptr && "ESA ERROR: cached query could not be found!");
             for (auto e : q->subscribed())
@@ -816,6 +2760,8 @@ namespace esa
         void query(vector<entity, MaxEntities> & ids)
         {
             assert(MaxEntities <= Entities && "ESA ERROR: query cannot ask for more entities than the table contains!");
+            ESA_TRACE_SCOPE(_trace, trace_kind::QUERY, Tag);
+            ESA_FLIGHT_COUNT(_recorder, queried);
             cached_query<MaxEntities> * q = static_cast<cached_query<MaxEntities> *>(get_query<Tag>());
             assert(q != nullptr && "ESA ERROR: cached query could not be found!");
             for (auto e : q->subscribed())
@@ -837,12 +2783,15 @@ namespace esa
         [[nodiscard]] vector<entity, MaxEntities> query(bool (*func) (entity_table<Entities, Components, Updaters, Queries, Applys>&, entity))
         {
             assert(MaxEntities <= Entities && "ESA ERROR: query cannot ask for more entities than the table contains!");
+            ESA_TRACE_SCOPE(_trace, trace_kind::QUERY, trace_event::NO_TAG);
+            ESA_FLIGHT_COUNT(_recorder, queried);
             vector<entity, MaxEntities> ids;
-            for (entity e = 0; e < used(); e++)
+            _scan([&](entity e)
             {
-                if (contains(e) && (*func)((*this), e))
+                if ((*func)((*this), e))
                     ids.push_back(e);
-            }
+                return false;
+            });
             return ids;
         }
 
@@ -860,11 +2809,14 @@ namespace esa
         void query(bool (*func) (entity_table<Entities, Components, Updaters, Queries, Applys>&, entity), vector<entity, MaxEntities> & ids)
         {
             assert(MaxEntities <= Entities && "ESA ERROR: query cannot ask for more entities than the table contains!");
-            for (entity e = 0; e < used(); e++)
+            ESA_TRACE_SCOPE(_trace, trace_kind::QUERY, trace_event::NO_TAG);
+            ESA_FLIGHT_COUNT(_recorder, queried);
+            _scan([&](entity e)
             {
-                if (contains(e) && (*func)((*this), e))
+                if ((*func)((*this), e))
                     ids.push_back(e);
-            }
+                return false;
+            });
         }
 
 
@@ -882,12 +2834,15 @@ namespace esa
         [[nodiscard]] vector<entity, MaxEntities> query(bool (*func) (entity_table<Entities, Components, Updaters, Queries, Applys>&, entity, T&), T& parameter)
         {
             assert(MaxEntities <= Entities && "ESA ERROR: query cannot ask for more entities than the table contains!");
+            ESA_TRACE_SCOPE(_trace, trace_kind::QUERY, trace_event::NO_TAG);
+            ESA_FLIGHT_COUNT(_recorder, queried);
             vector<entity, MaxEntities> ids;
-            for (entity e = 0; e < used(); e++)
+            _scan([&](entity e)
             {
-                if (contains(e) && (*func)((*this), e, parameter))
+                if ((*func)((*this), e, parameter))
                     ids.push_back(e);
-            }
+                return false;
+            });
             return ids;
         }
 
@@ -907,11 +2862,14 @@ namespace esa
         void query(bool (*func) (entity_table<Entities, Components, Updaters, Queries, Applys>&, entity, T&), T& parameter, vector<entity, MaxEntities> & ids)
         {
             assert(MaxEntities <= Entities && "ESA ERROR: query cannot ask for more entities than the table contains!");
-            for (entity e = 0; e < used(); e++)
+            ESA_TRACE_SCOPE(_trace, trace_kind::QUERY, trace_event::NO_TAG);
+            ESA_FLIGHT_COUNT(_recorder, queried);
+            _scan([&](entity e)
             {
-                if (contains(e) && (*func)((*this), e, parameter))
+                if ((*func)((*this), e, parameter))
                     ids.push_back(e);
-            }
+                return false;
+            });
         }
 
 
@@ -924,6 +2882,8 @@ namespace esa
         template<tag_t Tag, uint32_t MaxEntities>
         void apply()
         {
+            ESA_TRACE_SCOPE(_trace, trace_kind::APPLY, Tag);
+            ESA_FLIGHT_COUNT(_recorder, queried);
             cached_apply<MaxEntities> * a = static_cast<cached_apply<MaxEntities> *>(get_apply<Tag>());
             assert(a != nullptr && "ESA ERROR: cached apply object could not be found!");
             for (auto e : a->subscribed())
@@ -941,11 +2901,12 @@ namespace esa
          */
         void apply(bool (*func) (entity_table<Entities, Components, Updaters, Queries, Applys>&, entity))
         {
-            for (entity e = 0; e < used(); e++)
+            ESA_TRACE_SCOPE(_trace, trace_kind::APPLY, trace_event::NO_TAG);
+            ESA_FLIGHT_COUNT(_recorder, queried);
+            _scan([&](entity e)
             {
-                if (contains(e) && (*func)((*this), e))
-                    return;
-            }
+                return (*func)((*this), e);
+            });
         }
 
 
@@ -960,11 +2921,12 @@ namespace esa
         template<typename T>
         void apply(bool (*func) (entity_table<Entities, Components, Updaters, Queries, Applys>&, entity, T&), T& parameter)
         {
-            for (entity e = 0; e < used(); e++)
+            ESA_TRACE_SCOPE(_trace, trace_kind::APPLY, trace_event::NO_TAG);
+            ESA_FLIGHT_COUNT(_recorder, queried);
+            _scan([&](entity e)
             {
-                if (contains(e) && (*func)((*this), e, parameter))
-                    return;
-            }
+                return (*func)((*this), e, parameter);
+            });
         }
 
 
@@ -974,27 +2936,47 @@ namespace esa
          */
         ~entity_table()
         {
-            delete _pooled_ids;
-
+#ifndef ESA_NO_HEAP
             for (uint32_t i = 0; i < _updaters->size(); i++)
-                delete (*_updaters)[i];;
-            delete _updaters;
+                delete (*_updaters)[i];
 
             for (uint32_t i = 0; i < _queries->size(); i++)
                 delete (*_queries)[i];
-            delete _queries;
 
             for (uint32_t i = 0; i < _applys->size(); i++)
                 delete (*_applys)[i];
-            delete _applys;
+#endif
 
             for (uint32_t i = 0; i < _columns.size(); i++)
             {
-                if ((*_components_location)[i] == ram::EWRAM && _columns[i] != nullptr)
-                    delete _columns[i];
+                if ((*_components_location)[i] != ram::EWRAM || _columns[i] == nullptr)
+                    continue;
+                if (_column_arena != nullptr)
+                    iarena::destroy(_columns[i]);
+                else
+                    heap::destroy(_columns[i]);
             }
 
-            delete _components_location;
+            if (_owned)
+            {
+                heap::destroy(_pooled_ids);
+                heap::destroy(_timers);
+                heap::destroy(_updaters);
+                heap::destroy(_queries);
+                heap::destroy(_applys);
+                heap::destroy(_components_location);
+            }
+            else if (_arena != nullptr)
+            {
+                iarena::destroy(_pooled_ids);
+                iarena::destroy(_timers);
+                iarena::destroy(_updaters);
+                iarena::destroy(_queries);
+                iarena::destroy(_applys);
+                iarena::destroy(_components_location);
+                _column_arena->release(_column_mark);
+                _arena->release(_arena_mark);
+            }
         }
 
     };
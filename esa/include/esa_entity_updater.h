@@ -53,7 +53,37 @@ namespace esa
                     return;
             }
             if (select(e))
+            {
+                _touch();
+                _hash_subscription(e);
                 _entities.push_back(e);
+            }
+        }
+
+
+        /**
+         * @brief Subscribe several entities to the updater. The subscribed entities are checked for duplicates
+         * once for the whole batch.
+         * 
+         * @param entities The IDs of the entities.
+         * @param count The number of entities.
+         */
+        void subscribe(const entity * entities, uint32_t count) override
+        {
+            bool batched = for_each_new(_entities, entities, count, [this](entity e)
+            {
+                if (select(e))
+                {
+                    _touch();
+                    _hash_subscription(e);
+                    _entities.push_back(e);
+                }
+            });
+            if (!batched)
+            {
+                for (uint32_t i = 0; i < count; i++)
+                    subscribe(entities[i]);
+            }
         }
 
 
@@ -67,6 +97,8 @@ namespace esa
             {
                 if (_entities[i] == e)
                 {
+                    _touch();
+                    _hash_subscription(e);
                     _entities.erase(i);
                     break;
                 }
@@ -82,12 +114,72 @@ namespace esa
 
         /**
          * @brief Returns a vector with the IDs of the entities currently subscribed to the updater.
+         * Entities disabled in the table are skipped.
          * 
          * @return vector<entity, Entities> 
          */
         [[nodiscard]] vector<entity, Entities> subscribed()
         {
-            return _entities;
+            if (!filtering())
+            {
+                ESA_COPY(sizeof(_entities));
+                return _entities;
+            }
+            ESA_COPY(_entities.size() * sizeof(entity));
+            vector<entity, Entities> ids;
+            for (auto e : _entities)
+            {
+                if (enabled(e))
+                    ids.push_back(e);
+            }
+            return ids;
+        }
+
+
+        /**
+         * @brief Returns the number of entities subscribed to the updater. (including disabled ones)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t count() override
+        {
+            return _entities.size();
+        }
+
+
+        /**
+         * @brief Returns the maximum number of entities that can be subscribed to the updater. (`Entities`)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t capacity() override
+        {
+            return Entities;
+        }
+
+
+        /**
+         * @brief Write the subscribed entities to a snapshot.
+         * 
+         * @param w The snapshot writer.
+         */
+        void save(snapshot_writer & w) override
+        {
+            w.write_vector(_entities);
+        }
+
+
+        /**
+         * @brief Replace the subscribed entities with the ones read from a snapshot.
+         * 
+         * @param r The snapshot reader.
+         */
+        void load(snapshot_reader & r) override
+        {
+            r.read_vector(_entities);
+            _reset_subscription_hash();
+            for (entity e : _entities)
+                _hash_subscription(e);
         }
 
 
@@ -0,0 +1,620 @@
+#ifndef ESA_FLIGHT_RECORDER_H
+#define ESA_FLIGHT_RECORDER_H
+
+#include <cassert>
+
+#include "esa.h"
+
+
+/**
+ * @brief The number of frames kept by the flight recorder of each table (only used with `ESA_FLIGHT_RECORDER`).
+ * 
+ */
+#ifndef ESA_FLIGHT_RECORDER_FRAMES
+    #define ESA_FLIGHT_RECORDER_FRAMES 32
+#endif
+
+
+/**
+ * @brief Count an event (`created`, `destroyed`, `subscribed`, `queried`) in the current frame.
+ * Expands to nothing unless `ESA_FLIGHT_RECORDER` is defined.
+ * 
+ */
+#ifdef ESA_FLIGHT_RECORDER
+    #define ESA_FLIGHT_COUNT(recorder, event) recorder.event()
+#else
+    #define ESA_FLIGHT_COUNT(recorder, event)
+#endif
+
+
+namespace esa
+{
+    /**
+     * @brief A function receiving the dump of a flight recorder (e.g. to copy it to SRAM, or to write it to a file).
+     * 
+     */
+    using dump_fn = void (*)(const void * data, uint32_t bytes);
+
+
+    /**
+     * @brief Header of a flight recorder dump. It is followed by the tags of the updaters
+     * (`updaters` values of type `tag_t`, padded to 4 bytes) and by the frames.
+     * 
+     */
+    struct flight_header
+    {
+        /**
+         * @brief The value of `magic`: the characters "ESAF" in a little-endian word.
+         * 
+         */
+        static constexpr uint32_t MAGIC = 0x46415345;
+
+
+        /**
+         * @brief The version of the dump format.
+         * 
+         */
+        static constexpr uint32_t VERSION = 1;
+
+
+        /**
+         * @brief `MAGIC`.
+         * 
+         */
+        uint32_t magic;
+
+
+        /**
+         * @brief `VERSION`.
+         * 
+         */
+        uint32_t version;
+
+
+        /**
+         * @brief The number of updater slots of each frame.
+         * 
+         */
+        uint32_t updaters;
+
+
+        /**
+         * @brief The maximum number of frames.
+         * 
+         */
+        uint32_t capacity;
+
+
+        /**
+         * @brief Position of the next frame in the ring buffer.
+         * 
+         */
+        uint32_t next;
+
+
+        /**
+         * @brief The number of frames recorded.
+         * 
+         */
+        uint32_t size;
+
+
+        /**
+         * @brief The number of clock ticks in a millisecond.
+         * 
+         */
+        uint32_t ticks_per_ms;
+
+
+        /**
+         * @brief The frame that triggered the dump.
+         * 
+         */
+        uint32_t trigger_frame;
+
+
+        /**
+         * @brief The frame time above which the recorder is triggered. (`0` = never)
+         * 
+         */
+        uint32_t threshold;
+
+
+        /**
+         * @brief The number of updater slots in use. (the number of updaters that ran at least once)
+         * 
+         */
+        uint32_t used;
+    };
+
+
+    /**
+     * @brief What happened during a frame.
+     * 
+     * @tparam Updaters The number of updater slots.
+     */
+    template<uint32_t Updaters>
+    struct flight_frame
+    {
+        /**
+         * @brief The frame number. (`entity_table::frame()`)
+         * 
+         */
+        uint32_t frame;
+
+
+        /**
+         * @brief Duration of `entity_table::update()`.
+         * 
+         */
+        uint32_t ticks;
+
+
+        /**
+         * @brief Duration of the end-of-frame destruction.
+         * 
+         */
+        uint32_t destruction;
+
+
+        /**
+         * @brief The number of entities at the end of the frame.
+         * 
+         */
+        unsigned short entities;
+
+
+        /**
+         * @brief Entities created since the previous frame.
+         * 
+         */
+        unsigned short creates;
+
+
+        /**
+         * @brief Entities destroyed during the frame.
+         * 
+         */
+        unsigned short destroys;
+
+
+        /**
+         * @brief Entities subscribed since the previous frame.
+         * 
+         */
+        unsigned short subscribes;
+
+
+        /**
+         * @brief Queries and apply operations run since the previous frame.
+         * 
+         */
+        unsigned short queries;
+
+
+        /**
+         * @brief Unused, always `0`.
+         * 
+         */
+        unsigned short reserved;
+
+
+        /**
+         * @brief Duration of each updater's `update()`. (`0` if it did not run)
+         * 
+         */
+        uint32_t updaters [ Updaters == 0 ? 1 : Updaters ];
+    };
+
+
+    template<uint32_t Updaters, uint32_t Frames>
+    class flight_recorder
+    {
+        /**
+         * @brief The number of updater slots (at least one, to keep the layout simple).
+         * 
+         */
+        static constexpr uint32_t _slots = Updaters == 0 ? 1 : Updaters;
+
+
+        /**
+         * @brief The header. (must be the first member)
+         * 
+         */
+        flight_header _header;
+
+
+        /**
+         * @brief The tag of the updater of each slot. (padded to 4 bytes)
+         * 
+         */
+        tag_t _tags [ (_slots + 1) & ~1u ];
+
+
+        /**
+         * @brief Ring buffer of the last `Frames` frames.
+         * 
+         */
+        flight_frame<_slots> _frames [ Frames ];
+
+
+        /**
+         * @brief The clock.
+         * 
+         */
+        clock_fn _clock;
+
+
+        /**
+         * @brief Called when the recorder is triggered.
+         * 
+         */
+        dump_fn _dump;
+
+
+        /**
+         * @brief The frame being recorded.
+         * 
+         */
+        flight_frame<_slots> _current;
+
+
+        /**
+         * @brief Time at the beginning of the current frame.
+         * 
+         */
+        uint32_t _start;
+
+
+        /**
+         * @brief Frames still to record after the trigger, before freezing.
+         * 
+         */
+        uint32_t _countdown;
+
+
+        /**
+         * @brief The number of frames to record after the trigger.
+         * 
+         */
+        uint32_t _after;
+
+
+        /**
+         * @brief True after the trigger.
+         * 
+         */
+        bool _triggered;
+
+
+        /**
+         * @brief True when frozen: nothing is recorded until `rearm()`.
+         * 
+         */
+        bool _frozen;
+
+
+        /**
+         * @brief True between `begin_frame` and `end_frame`.
+         * 
+         */
+        bool _in_frame;
+
+
+        /**
+         * @brief True if the recorder was triggered during the current frame, which is then not counted
+         * in the frames recorded after the trigger.
+         * 
+         */
+        bool _triggering;
+
+
+        /**
+         * @brief Clear the frame being recorded.
+         * 
+         */
+        void _reset_current()
+        {
+            _current.ticks = 0;
+            _current.destruction = 0;
+            _current.entities = 0;
+            _current.creates = 0;
+            _current.destroys = 0;
+            _current.subscribes = 0;
+            _current.queries = 0;
+            _current.reserved = 0;
+            for (uint32_t i = 0; i < _slots; i++)
+                _current.updaters[i] = 0;
+        }
+
+
+        /**
+         * @brief Add one to a counter, saturating.
+         * 
+         */
+        static void _count(unsigned short & counter)
+        {
+            if (counter != 0xffff)
+                counter++;
+        }
+
+
+        public:
+
+
+        /**
+         * @brief Constructor. Nothing is recorded until a clock is set.
+         * 
+         */
+        flight_recorder()
+        {
+            _header.magic = flight_header::MAGIC;
+            _header.version = flight_header::VERSION;
+            _header.updaters = _slots;
+            _header.capacity = Frames;
+            _header.ticks_per_ms = 1000;
+            _header.threshold = 0;
+            _header.used = 0;
+            for (uint32_t i = 0; i < ((_slots + 1) & ~1u); i++)
+                _tags[i] = 0;
+            _clock = nullptr;
+            _dump = nullptr;
+            _after = 0;
+            rearm();
+        }
+
+
+        /**
+         * @brief Set the clock, and discard the frames recorded so far.
+         * 
+         * @param clock A function returning the current time.
+         * @param ticks_per_ms The number of clock ticks in a millisecond (e.g. `16777` for GBA cycles).
+         */
+        void set_clock(clock_fn clock, uint32_t ticks_per_ms)
+        {
+            _clock = clock;
+            _header.ticks_per_ms = ticks_per_ms;
+            rearm();
+        }
+
+
+        /**
+         * @brief Set the trigger: when a frame takes longer than `threshold`, `after` more frames are
+         * recorded, then the recorder freezes and `dump` is called with its content.
+         * 
+         * @param threshold The frame time above which the recorder is triggered, in clock ticks. (`0` = never)
+         * @param after The number of frames to record after the slow frame. (less than `Frames`)
+         * @param dump The function receiving the dump. (may be `nullptr`: use `data()` after `frozen()`)
+         */
+        void set_trigger(uint32_t threshold, uint32_t after, dump_fn dump)
+        {
+            assert(after < Frames && "ESA ERROR: too many frames to record after the trigger!");
+            _header.threshold = threshold;
+            _after = after;
+            _dump = dump;
+        }
+
+
+        /**
+         * @brief Trigger the recorder manually (e.g. when the player reports a problem). When called during
+         * a frame, that frame is the one that triggered the recorder; otherwise, it is the last frame recorded.
+         * 
+         */
+        void trigger()
+        {
+            if (_triggered || _frozen)
+                return;
+            _triggered = true;
+            _triggering = _in_frame;
+            _countdown = _after;
+            _header.trigger_frame = _current.frame;
+        }
+
+
+        /**
+         * @brief Discard the recorded frames and start recording again.
+         * 
+         */
+        void rearm()
+        {
+            _header.next = 0;
+            _header.size = 0;
+            _header.trigger_frame = 0;
+            _triggered = false;
+            _frozen = false;
+            _in_frame = false;
+            _triggering = false;
+            _countdown = 0;
+            _start = 0;
+            _current.frame = 0;
+            _reset_current();
+        }
+
+
+        /**
+         * @brief Tells if frames are being recorded.
+         * 
+         */
+        [[nodiscard]] bool recording()
+        {
+            return _clock != nullptr && !_frozen;
+        }
+
+
+        /**
+         * @brief Tells if the recorder was triggered and froze.
+         * 
+         */
+        [[nodiscard]] bool frozen()
+        {
+            return _frozen;
+        }
+
+
+        /**
+         * @brief Returns the current time, or `0` if nothing is being recorded.
+         * 
+         */
+        [[nodiscard]] uint32_t now()
+        {
+            return recording() ? _clock() : 0;
+        }
+
+
+        /**
+         * @brief Start a frame.
+         * 
+         */
+        void begin_frame(uint32_t frame)
+        {
+            _current.frame = frame;
+            _in_frame = true;
+            _start = now();
+        }
+
+
+        /**
+         * @brief Record a call to an updater.
+         * 
+         */
+        void updater_call(uint32_t slot, tag_t tag, uint32_t ticks)
+        {
+            if (slot >= _slots)
+                return;
+            _tags[slot] = tag;
+            _current.updaters[slot] += ticks;
+            if (slot >= _header.used)
+                _header.used = slot + 1;
+        }
+
+
+        /**
+         * @brief Record the end-of-frame destruction.
+         * 
+         */
+        void destruction_call(uint32_t ticks)
+        {
+            _current.destruction += ticks;
+        }
+
+
+        /**
+         * @brief Count a created entity.
+         * 
+         */
+        void created()
+        {
+            _count(_current.creates);
+        }
+
+
+        /**
+         * @brief Count a destroyed entity.
+         * 
+         */
+        void destroyed()
+        {
+            _count(_current.destroys);
+        }
+
+
+        /**
+         * @brief Count a subscribed entity.
+         * 
+         */
+        void subscribed()
+        {
+            _count(_current.subscribes);
+        }
+
+
+        /**
+         * @brief Count a query or apply operation.
+         * 
+         */
+        void queried()
+        {
+            _count(_current.queries);
+        }
+
+
+        /**
+         * @brief End a frame: store it, and check the trigger.
+         * 
+         * @param entities The number of entities in the table.
+         */
+        void end_frame(uint32_t entities)
+        {
+            _in_frame = false;
+            if (!recording())
+            {
+                _triggering = false;
+                _reset_current();
+                return;
+            }
+            _current.ticks = _clock() - _start;
+            _current.entities = entities > 0xffff ? 0xffff : entities;
+            _frames[_header.next] = _current;
+            _header.next = _header.next + 1 == Frames ? 0 : _header.next + 1;
+            if (_header.size < Frames)
+                _header.size++;
+            if (!_triggered && _header.threshold != 0 && _current.ticks > _header.threshold)
+                trigger();
+            else if (_triggered && _countdown > 0 && !_triggering)
+                _countdown--;
+            _triggering = false;
+            _reset_current();
+            if (_triggered && _countdown == 0)
+            {
+                _frozen = true;
+                if (_dump != nullptr)
+                    _dump(data(), bytes());
+            }
+        }
+
+
+        /**
+         * @brief Returns the number of frames recorded. (at most `Frames`)
+         * 
+         */
+        [[nodiscard]] uint32_t size()
+        {
+            return _header.size;
+        }
+
+
+        /**
+         * @brief Returns a recorded frame, from the oldest (`0`) to the most recent (`size() - 1`).
+         * 
+         */
+        [[nodiscard]] flight_frame<_slots> & operator[](uint32_t i)
+        {
+            assert(i < _header.size && "ESA ERROR: flight recorder frame index out of range!");
+            uint32_t first = _header.size < Frames ? 0 : _header.next;
+            uint32_t j = first + i;
+            return _frames[j >= Frames ? j - Frames : j];
+        }
+
+
+        /**
+         * @brief Returns the raw dump (header, tags and frames), to be decoded with `esa_flight2txt`.
+         * 
+         */
+        [[nodiscard]] const void * data()
+        {
+            return &_header;
+        }
+
+
+        /**
+         * @brief Returns the size of the raw dump, in bytes.
+         * 
+         */
+        [[nodiscard]] static constexpr uint32_t bytes()
+        {
+            return sizeof(flight_header) + sizeof(tag_t) * ((_slots + 1) & ~1u) + sizeof(flight_frame<_slots>) * Frames;
+        }
+    };
+}
+
+#endif
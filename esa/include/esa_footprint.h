@@ -0,0 +1,172 @@
+#ifndef ESA_FOOTPRINT_H
+#define ESA_FOOTPRINT_H
+
+#include "esa.h"
+
+
+namespace esa
+{
+    /**
+     * @brief The size of the GBA internal work RAM, in bytes. (shared with the stack and with ARM code)
+     * 
+     */
+    constexpr uint32_t IWRAM_BYTES = 32 * 1024;
+
+
+    /**
+     * @brief The size of the GBA external work RAM, in bytes. (shared with the heap)
+     * 
+     */
+    constexpr uint32_t EWRAM_BYTES = 256 * 1024;
+
+
+    /**
+     * @brief Memory taken up by some objects, split between IWRAM and EWRAM.
+     * All the functions returning a footprint are `constexpr`, so footprints can be checked with `static_assert`.
+     * 
+     */
+    struct footprint
+    {
+        /**
+         * @brief Bytes in IWRAM.
+         * 
+         */
+        uint32_t iwram;
+
+
+        /**
+         * @brief Bytes in EWRAM.
+         * 
+         */
+        uint32_t ewram;
+
+
+        /**
+         * @brief Returns the total number of bytes.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] constexpr uint32_t total() const
+        {
+            return iwram + ewram;
+        }
+
+
+        /**
+         * @brief Tells if the footprint fits in the given budgets.
+         * 
+         * @param iwram_budget The maximum number of bytes in IWRAM.
+         * @param ewram_budget The maximum number of bytes in EWRAM.
+         * @return true
+         * @return false
+         */
+        [[nodiscard]] constexpr bool fits(uint32_t iwram_budget, uint32_t ewram_budget = EWRAM_BYTES) const
+        {
+            return iwram <= iwram_budget && ewram <= ewram_budget;
+        }
+
+
+        /**
+         * @brief Sum of two footprints.
+         * 
+         * @param other The other footprint.
+         * @return footprint
+         */
+        [[nodiscard]] constexpr footprint operator+(footprint other) const
+        {
+            return footprint { iwram + other.iwram, ewram + other.ewram };
+        }
+
+
+        /**
+         * @brief The footprint of `n` copies.
+         * 
+         * @param n The number of copies.
+         * @return footprint
+         */
+        [[nodiscard]] constexpr footprint operator*(uint32_t n) const
+        {
+            return footprint { iwram * n, ewram * n };
+        }
+    };
+
+
+    /**
+     * @brief Returns the footprint of `bytes` bytes placed in a certain memory. (nothing for ROM)
+     * 
+     * @param bytes The number of bytes.
+     * @param where The memory.
+     * @return footprint
+     */
+    [[nodiscard]] constexpr footprint bytes_in(uint32_t bytes, ram where)
+    {
+        if (where == ram::ROM)
+            return footprint { 0, 0 };
+        return where == ram::IWRAM ? footprint { bytes, 0 } : footprint { 0, bytes };
+    }
+
+
+    /**
+     * @brief Returns the footprint of an object of any type (an updater, a cached query, a cached apply object, ...).
+     * Objects created with `new` are in EWRAM, global and stack objects are in IWRAM (with the GBA toolchain defaults).
+     * 
+     * @tparam Type The type of the object.
+     * @param where Where the object is allocated.
+     * @return footprint
+     */
+    template<typename Type>
+    [[nodiscard]] constexpr footprint footprint_of(ram where)
+    {
+        return bytes_in(sizeof(Type), where);
+    }
+
+
+    /**
+     * @brief Returns the footprint of a column. Columns added with `add_component` are in EWRAM,
+     * series added with `add_series` are wherever they were created.
+     * 
+     * @tparam ComponentType The type of the component.
+     * @tparam Entities The maximum number of entities of the table.
+     * @param where Where the series is allocated.
+     * @return footprint
+     */
+    template<typename ComponentType, uint32_t Entities>
+    [[nodiscard]] constexpr footprint series_footprint(ram where)
+    {
+        return footprint_of<series<ComponentType, Entities>>(where);
+    }
+
+
+    /**
+     * @brief Returns the footprint of an indexed column. Columns added with `add_component` are in EWRAM,
+     * indexed series added with `add_indexed_series` are wherever they were created.
+     * 
+     * @tparam ComponentType The type of the component.
+     * @tparam Size The maximum number of entities owning the component.
+     * @param where Where the indexed series is allocated.
+     * @return footprint
+     */
+    template<typename ComponentType, uint32_t Size>
+    [[nodiscard]] constexpr footprint indexed_series_footprint(ram where)
+    {
+        return footprint_of<indexed_series<ComponentType, Size>>(where);
+    }
+
+
+    /**
+     * @brief Returns the footprint of a table, without its columns, updaters, cached queries and cached apply objects:
+     * the table object itself, and the internals it allocates on the heap (EWRAM).
+     * 
+     * @tparam Table The type of the table. (`esa::entity_table<...>`)
+     * @param where Where the table object is allocated.
+     * @param timers True if the table uses timers (`schedule`, `destroy_after`), which allocate a timer wheel.
+     * @return footprint
+     */
+    template<typename Table>
+    [[nodiscard]] constexpr footprint table_footprint(ram where, bool timers = false)
+    {
+        return footprint_of<Table>(where) + Table::heap_footprint(timers);
+    }
+}
+
+#endif
@@ -0,0 +1,190 @@
+#ifndef ESA_HEAP_H
+#define ESA_HEAP_H
+
+#include <cassert>
+
+#include "esa.h"
+
+
+/**
+ * @brief When `ESA_NO_HEAP` is defined, ESA never allocates memory on the heap: tables must be constructed
+ * with a `table_storage`, columns must be added with `add_series` or `add_indexed_series`, and any code
+ * that would allocate (e.g. `add_component`) fails to compile. The table never deletes the updaters,
+ * cached queries and cached apply objects attached to it, which should be static objects.
+ * 
+ */
+namespace esa
+{
+    /**
+     * @brief A function called for each heap allocation (`bytes` > 0) and release (`bytes` = 0) made by ESA.
+     * 
+     */
+    using allocation_fn = void (*)(const void * p, uint32_t bytes);
+
+
+    /**
+     * @brief Heap allocations made by ESA.
+     * 
+     */
+    struct heap_counters
+    {
+        /**
+         * @brief The number of allocations.
+         * 
+         */
+        uint32_t allocations;
+
+
+        /**
+         * @brief The number of releases.
+         * 
+         */
+        uint32_t releases;
+
+
+        /**
+         * @brief The number of bytes allocated. (releases are not subtracted)
+         * 
+         */
+        uint32_t bytes;
+
+
+        /**
+         * @brief The largest number of blocks allocated at the same time.
+         * 
+         */
+        uint32_t peak_blocks;
+
+
+        /**
+         * @brief Returns the number of blocks currently allocated.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t blocks() const
+        {
+            return allocations - releases;
+        }
+    };
+
+
+    /**
+     * @brief The heap used by ESA (global `new` and `delete`). All the allocations and releases
+     * are counted, and reported to an optional hook.
+     * 
+     */
+    class heap
+    {
+        /**
+         * @brief The counters.
+         * 
+         */
+        inline static heap_counters _counters = {};
+
+
+        /**
+         * @brief The hook. (`nullptr` = none)
+         * 
+         */
+        inline static allocation_fn _hook = nullptr;
+
+
+        public:
+
+
+        /**
+         * @brief Create an object on the heap.
+         * Fails to compile when `ESA_NO_HEAP` is defined.
+         * 
+         * @tparam Type The type of the object.
+         * @return Type*
+         */
+        template<typename Type>
+        [[nodiscard]] static Type * create()
+        {
+#ifdef ESA_NO_HEAP
+            static_assert(sizeof(Type) == 0, "ESA ERROR: heap allocation with ESA_NO_HEAP defined!");
+#endif
+            Type * p = new Type();
+            _counters.allocations++;
+            _counters.bytes += sizeof(Type);
+            if (_counters.blocks() > _counters.peak_blocks)
+                _counters.peak_blocks = _counters.blocks();
+            if (_hook != nullptr)
+                _hook(p, sizeof(Type));
+            return p;
+        }
+
+
+        /**
+         * @brief Delete an object created with `create()`. (nothing happens for `nullptr`)
+         * 
+         * @tparam Type The type of the object (or a base class with a virtual destructor).
+         * @param p A pointer to the object.
+         */
+        template<typename Type>
+        static void destroy(Type * p)
+        {
+            if (p == nullptr)
+                return;
+            _counters.releases++;
+            if (_hook != nullptr)
+                _hook(p, 0);
+            delete p;
+        }
+
+
+        /**
+         * @brief Set a function called at each allocation and release. (`nullptr` = none)
+         * For instance, it can assert if something is allocated during a frame.
+         * 
+         * @param hook The function.
+         */
+        static void set_hook(allocation_fn hook)
+        {
+            _hook = hook;
+        }
+
+
+        /**
+         * @brief Returns the counters.
+         * 
+         * @return const heap_counters&
+         */
+        [[nodiscard]] static const heap_counters & counters()
+        {
+            return _counters;
+        }
+
+
+        /**
+         * @brief Reset the counters.
+         * 
+         */
+        static void reset_counters()
+        {
+            _counters = heap_counters {};
+        }
+    };
+
+
+    /**
+     * @brief Storage for the internals of a table (pooled IDs, column locations, lists of updaters,
+     * cached queries and cached apply objects, timers), to be defined as a static object and passed to the
+     * constructor of `entity_table`: the table then allocates nothing on the heap.
+     * The template parameters must match the ones of the table.
+     * 
+     */
+    template<uint32_t Entities, uint32_t Components, uint32_t Updaters, uint32_t Queries, uint32_t Applys>
+    struct table_storage
+    {
+        vector<entity, Entities> pooled_ids;
+        array<ram, Components> components_location;
+        vector<iupdater *, Updaters> updaters;
+        vector<icached_query *, Queries> queries;
+        vector<icached_apply *, Applys> applys;
+        table_timer_wheel<Entities> timers;
+    };
+}
+
+#endif
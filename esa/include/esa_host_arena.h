@@ -0,0 +1,624 @@
+#ifndef ESA_HOST_ARENA_H
+#define ESA_HOST_ARENA_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "esa.h"
+
+
+/**
+ * @brief Arenas for host builds (Linux and other POSIX systems): the memory is mapped with `mmap`,
+ * on huge pages when possible, so that a table and its columns sit in a few TLB entries, or from a file,
+ * so that the columns persist from one run to the next.
+ * 
+ */
+namespace esa
+{
+    class huge_page_arena : public linear_arena
+    {
+        /**
+         * @brief A mapping, and whether it is on explicit huge pages.
+         * 
+         */
+        struct mapping
+        {
+            void * address;
+            bool huge;
+        };
+
+
+        /**
+         * @brief The mapped memory. (`nullptr` if the mapping failed)
+         * 
+         */
+        void * _mapping;
+
+
+        /**
+         * @brief The size of the mapping, in bytes.
+         * 
+         */
+        unsigned long _bytes;
+
+
+        /**
+         * @brief True if the memory is on explicit huge pages (`MAP_HUGETLB`).
+         * 
+         */
+        bool _huge;
+
+
+        /**
+         * @brief Round a size up to a multiple of `PAGE_BYTES`.
+         * 
+         */
+        static unsigned long _round(uint32_t bytes)
+        {
+            return (bytes + PAGE_BYTES - 1) / PAGE_BYTES * PAGE_BYTES;
+        }
+
+
+        /**
+         * @brief Map the memory, trying explicit huge pages first, then transparent huge pages.
+         * 
+         */
+        static mapping _map(unsigned long bytes)
+        {
+            int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_POPULATE
+            flags |= MAP_POPULATE; // touch the pages now, from this thread (first-touch NUMA placement)
+#endif
+#ifdef MAP_HUGETLB
+            void * p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED)
+                return mapping { p, true };
+#endif
+            void * q = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+            if (q == MAP_FAILED)
+                return mapping { nullptr, false };
+#ifdef MADV_HUGEPAGE
+            madvise(q, bytes, MADV_HUGEPAGE);
+#endif
+            return mapping { q, false };
+        }
+
+
+        /**
+         * @brief Constructor, from a mapping.
+         * 
+         */
+        huge_page_arena(uint32_t bytes, mapping m)
+            : linear_arena(m.address, m.address != nullptr ? bytes : 0)
+        {
+            _mapping = m.address;
+            _bytes = _round(bytes);
+            _huge = m.huge;
+        }
+
+
+        public:
+
+
+        /**
+         * @brief The size of a huge page. (the size of the mapping is rounded up to a multiple of it)
+         * 
+         */
+        static constexpr unsigned long PAGE_BYTES = 2 * 1024 * 1024;
+
+
+        /**
+         * @brief Constructor. The pages are populated by the calling thread, so on NUMA machines
+         * they are placed on the node of the thread that will use the table.
+         * If the memory cannot be mapped, the arena is empty (see `mapped()`).
+         * 
+         * @param bytes The size of the arena.
+         */
+        huge_page_arena(uint32_t bytes)
+            : huge_page_arena(bytes, _map(_round(bytes)))
+        {
+
+        }
+
+
+        huge_page_arena(const huge_page_arena &) = delete;
+        huge_page_arena & operator=(const huge_page_arena &) = delete;
+
+
+        /**
+         * @brief Destructor: unmap the memory.
+         * 
+         */
+        ~huge_page_arena()
+        {
+            if (_mapping != nullptr)
+                munmap(_mapping, _bytes);
+        }
+
+
+        /**
+         * @brief Tells if the memory could be mapped.
+         * 
+         * @return true
+         * @return false
+         */
+        [[nodiscard]] bool mapped() const
+        {
+            return _mapping != nullptr;
+        }
+
+
+        /**
+         * @brief Tells if the memory is on explicit huge pages. Otherwise, transparent huge pages were requested
+         * (`madvise`), and the kernel may or may not use them.
+         * 
+         * @return true
+         * @return false
+         */
+        [[nodiscard]] bool huge() const
+        {
+            return _huge;
+        }
+    };
+
+    class mapped_arena : public linear_arena
+    {
+        /**
+         * @brief The maximum number of blocks that can be allocated from the arena.
+         * 
+         */
+        static constexpr uint32_t _max_blocks = 1000;
+
+
+        /**
+         * @brief The first page of the file.
+         * 
+         */
+        struct header
+        {
+            /**
+             * @brief Identifies a mapped arena ("ESAM").
+             * 
+             */
+            static constexpr uint32_t MAGIC = 0x4d415345;
+
+
+            /**
+             * @brief The version of the format.
+             * 
+             */
+            static constexpr uint32_t VERSION = 1;
+
+
+            uint32_t magic;
+            uint32_t version;
+
+
+            /**
+             * @brief The key passed to the constructor, e.g. a version of the game data.
+             * 
+             */
+            uint32_t key;
+
+
+            /**
+             * @brief The size of the arena, and the size of the region holding the rest of the table.
+             * 
+             */
+            uint32_t bytes;
+            uint32_t state_bytes;
+
+
+            /**
+             * @brief The size of the rest of the table saved by `save()`. (`0` = none)
+             * 
+             */
+            uint32_t state_size;
+
+
+            /**
+             * @brief `1` if the columns were not changed after `save()`.
+             * 
+             */
+            uint32_t clean;
+
+
+            /**
+             * @brief The number of blocks allocated when the table was saved, and their sizes.
+             * 
+             */
+            uint32_t blocks;
+            uint32_t sizes [ _max_blocks ];
+        };
+
+
+        /**
+         * @brief The size of the first page of the file.
+         * 
+         */
+        static constexpr unsigned long _header_bytes = 4096;
+
+
+        /**
+         * @brief The open file, and its mapping.
+         * 
+         */
+        struct mapping
+        {
+            int fd;
+            unsigned char * address;
+            unsigned long bytes;
+            bool reopened;
+        };
+
+
+        /**
+         * @brief The file. (`-1` if it could not be opened)
+         * 
+         */
+        int _fd;
+
+
+        /**
+         * @brief The mapped file. (`nullptr` if the mapping failed)
+         * 
+         */
+        unsigned char * _mapping;
+
+
+        /**
+         * @brief The size of the mapping, in bytes.
+         * 
+         */
+        unsigned long _bytes;
+
+
+        /**
+         * @brief The region of the file holding the rest of the table, saved by `save()`.
+         * 
+         */
+        unsigned char * _state;
+
+
+        /**
+         * @brief The size of `_state`.
+         * 
+         */
+        uint32_t _state_bytes;
+
+
+        /**
+         * @brief True if the file was written by a previous run with the same sizes and key.
+         * 
+         */
+        bool _reopened;
+
+
+        /**
+         * @brief True while the blocks allocated match the ones of the previous run.
+         * 
+         */
+        bool _reattaching;
+
+
+        /**
+         * @brief True if the last block allocated holds the object of the previous run.
+         * 
+         */
+        bool _last;
+
+
+        /**
+         * @brief The number of blocks allocated.
+         * 
+         */
+        uint32_t _blocks;
+
+
+        /**
+         * @brief The size of each block, and the position of the arena before it.
+         * 
+         */
+        uint32_t _sizes [ _max_blocks ];
+        uint32_t _marks [ _max_blocks ];
+
+
+        /**
+         * @brief Round a size up to a multiple of `_header_bytes`.
+         * 
+         */
+        static unsigned long _round(unsigned long bytes)
+        {
+            return (bytes + _header_bytes - 1) / _header_bytes * _header_bytes;
+        }
+
+
+        /**
+         * @brief Returns the header of the file.
+         * 
+         */
+        header * _header()
+        {
+            return reinterpret_cast<header *>(_mapping);
+        }
+
+
+        /**
+         * @brief Clear a flag on the next change to any column of a table. (`nullptr` = stop watching)
+         * 
+         * @param table The table.
+         * @param flag The flag.
+         */
+        template<uint32_t Entities, uint32_t Components, uint32_t Updaters, uint32_t Queries, uint32_t Applys>
+        static void _watch(entity_table<Entities, Components, Updaters, Queries, Applys> & table, uint32_t * flag)
+        {
+            for (tag_t tag = 0; tag < Components; tag++)
+            {
+                if (table.column(tag) != nullptr)
+                    table.column(tag)->watch(flag);
+            }
+        }
+
+
+        /**
+         * @brief Open and map the file. If it was not written by an arena with the same sizes and key,
+         * it is emptied first.
+         * 
+         */
+        static mapping _open(const char * path, uint32_t bytes, uint32_t state_bytes, uint32_t key)
+        {
+            static_assert(sizeof(header) <= _header_bytes, "ESA ERROR: mapped arena header is too large!");
+            unsigned long total = _header_bytes + _round(state_bytes) + _round(bytes);
+            int fd = open(path, O_RDWR | O_CREAT, 0644);
+            if (fd < 0)
+                return mapping { -1, nullptr, 0, false };
+            header h {};
+            struct stat st;
+            bool reopened = fstat(fd, &st) == 0 && (unsigned long) st.st_size == total
+                && pread(fd, &h, sizeof(h), 0) == (long) sizeof(h) && h.magic == header::MAGIC && h.version == header::VERSION
+                && h.key == key && h.bytes == bytes && h.state_bytes == state_bytes;
+            if (!reopened && (ftruncate(fd, 0) != 0 || ftruncate(fd, (off_t) total) != 0))
+            {
+                close(fd);
+                return mapping { -1, nullptr, 0, false };
+            }
+            void * p = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                close(fd);
+                return mapping { -1, nullptr, 0, false };
+            }
+            if (!reopened)
+            {
+                header * fresh = static_cast<header *>(p);
+                fresh->magic = header::MAGIC;
+                fresh->version = header::VERSION;
+                fresh->key = key;
+                fresh->bytes = bytes;
+                fresh->state_bytes = state_bytes;
+            }
+            return mapping { fd, static_cast<unsigned char *>(p), total, reopened };
+        }
+
+
+        /**
+         * @brief Constructor, from a mapping.
+         * 
+         */
+        mapped_arena(uint32_t bytes, uint32_t state_bytes, mapping m)
+            : linear_arena(m.address != nullptr ? m.address + _header_bytes + _round(state_bytes) : nullptr, m.address != nullptr ? bytes : 0)
+        {
+            _fd = m.fd;
+            _mapping = m.address;
+            _bytes = m.bytes;
+            _state = m.address != nullptr ? m.address + _header_bytes : nullptr;
+            _state_bytes = state_bytes;
+            _reopened = m.reopened;
+            _reattaching = m.reopened;
+            _last = false;
+            _blocks = 0;
+        }
+
+
+        public:
+
+
+        /**
+         * @brief Constructor. Opens the file, or creates it. If it was written by an arena with the same sizes and key,
+         * the columns allocated in the same order as in the previous run are kept (see `load()`); otherwise, the file is emptied.
+         * If the file cannot be opened or mapped, the arena is empty (see `mapped()`).
+         * 
+         * @param path The path of the file.
+         * @param bytes The size of the arena, for the columns.
+         * @param state_bytes The size of the region holding the rest of the table. (at least `table.snapshot_size(false)`)
+         * @param key Any number, e.g. a version of the game data: a file written with another key is emptied.
+         */
+        mapped_arena(const char * path, uint32_t bytes, uint32_t state_bytes, uint32_t key = 0)
+            : mapped_arena(bytes, state_bytes, _open(path, bytes, state_bytes, key))
+        {
+
+        }
+
+
+        mapped_arena(const mapped_arena &) = delete;
+        mapped_arena & operator=(const mapped_arena &) = delete;
+
+
+        /**
+         * @brief Destructor: unmap the memory and close the file. What was written to the columns is in the file,
+         * but the rest of the table is only saved by `save()`.
+         * 
+         */
+        ~mapped_arena()
+        {
+            if (_mapping != nullptr)
+            {
+                munmap(_mapping, _bytes);
+                close(_fd);
+            }
+        }
+
+
+        /**
+         * @brief Allocate a block of memory, right after the previous one. While the blocks have the same sizes
+         * as in the previous run, they hold the objects of the previous run (see `reattached()`).
+         * 
+         * @param bytes The size of the block.
+         * @param alignment The alignment of the block. (a power of two)
+         * @return void* The block, or `nullptr` if the arena is full.
+         */
+        [[nodiscard]] void * allocate(uint32_t bytes, uint32_t alignment) override
+        {
+            uint32_t position = mark();
+            void * p = linear_arena::allocate(bytes, alignment);
+            _last = false;
+            if (p == nullptr)
+                return nullptr;
+            assert(_blocks < _max_blocks && "ESA ERROR: too many blocks in a mapped arena!");
+            _reattaching = _reattaching && _blocks < _header()->blocks && _header()->sizes[_blocks] == bytes;
+            _last = _reattaching;
+            _sizes[_blocks] = bytes;
+            _marks[_blocks] = position;
+            _blocks++;
+            return p;
+        }
+
+
+        /**
+         * @brief Release all the blocks allocated after a certain position. The blocks allocated after it
+         * no longer hold the objects of the previous run.
+         * 
+         * @param mark A position returned by `mark()`.
+         */
+        void release(uint32_t mark) override
+        {
+            linear_arena::release(mark);
+            while (_blocks > 0 && _marks[_blocks - 1] >= mark)
+                _blocks--;
+            _reattaching = false;
+            _last = false;
+        }
+
+
+        /**
+         * @brief Release all the blocks.
+         * 
+         */
+        void reset()
+        {
+            release(0);
+        }
+
+
+        /**
+         * @brief Tells if the last block allocated holds the object created by the previous run.
+         * 
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool reattached() override
+        {
+            return _last;
+        }
+
+
+        /**
+         * @brief Save the rest of the table (everything but its columns, which are already in the file) in the file.
+         * Call it before the program exits, once the table is in a consistent state (e.g. after `update()`).
+         * 
+         * @param table The table, whose columns were added with this arena.
+         * @return true 
+         * @return false The arena is not mapped, or the region for the rest of the table is too small.
+         */
+        template<typename Table>
+        bool save(Table & table)
+        {
+            if (_mapping == nullptr)
+                return false;
+            uint32_t size = table.snapshot_size(false);
+            if (size > _state_bytes)
+                return false;
+            table.snapshot(_state, size, false);
+            header * h = _header();
+            h->state_size = size;
+            h->blocks = _blocks;
+            for (uint32_t i = 0; i < _blocks; i++)
+                h->sizes[i] = _sizes[i];
+            h->clean = 1;
+            _watch(table, &h->clean);
+            return true;
+        }
+
+
+        /**
+         * @brief Load the rest of the table saved by the previous run, once its columns, updaters, cached queries and cached apply
+         * objects are added in the same order. The components are not copied: they stay in the file, and are paged in when used.
+         * If the file holds no table matching this one (or the previous run did not call `save()` after changing the columns),
+         * the columns are emptied and the table must be built from scratch.
+         * 
+         * @param table The table, whose columns were added with this arena.
+         * @return true The table was loaded.
+         * @return false The table is empty.
+         */
+        template<uint32_t Entities, uint32_t Components, uint32_t Updaters, uint32_t Queries, uint32_t Applys>
+        bool load(entity_table<Entities, Components, Updaters, Queries, Applys> & table)
+        {
+            if (_mapping == nullptr)
+                return false;
+            header * h = _header();
+            bool loaded = _reopened && _reattaching && _blocks == h->blocks && h->clean == 1 && h->state_size > 0
+                && table.restore(_state, h->state_size, false);
+            if (!loaded)
+            {
+                for (tag_t tag = 0; tag < Components; tag++)
+                {
+                    if (table.column(tag) != nullptr)
+                        table.column(tag)->clear();
+                }
+            }
+            h->clean = 0;
+            _watch(table, nullptr);
+            return loaded;
+        }
+
+
+        /**
+         * @brief Write the changes to the file now, instead of letting the system do it.
+         * 
+         * @return true 
+         * @return false 
+         */
+        bool flush()
+        {
+            return _mapping != nullptr && msync(_mapping, _bytes, MS_SYNC) == 0;
+        }
+
+
+        /**
+         * @brief Tells if the file could be opened and mapped.
+         * 
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool mapped() const
+        {
+            return _mapping != nullptr;
+        }
+
+
+        /**
+         * @brief Tells if the file was written by a previous run with the same sizes and key.
+         * 
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool reopened() const
+        {
+            return _reopened;
+        }
+    };
+}
+
+#endif
@@ -69,7 +69,11 @@ namespace esa
                     return;
             }
             if (select(e))
+            {
+                _touch();
+                _hash_subscription(i);
                 _indexes.push_back(i);
+            }
         }
 
 
@@ -84,6 +88,8 @@ namespace esa
                 index i = _indexes[j];
                 if (series.id(i) == e)
                 {
+                    _touch();
+                    _hash_subscription(i);
                     _indexes.erase(j);
                     return;
                 }
@@ -103,11 +109,17 @@ namespace esa
                 index i = _indexes[j];
                 if (series.id(i) == e)
                 {
+                    _touch();
+                    _hash_subscription(i);
                     _indexes.erase(j);
                     for (uint32_t jj = 0; jj < _indexes.size(); jj++)
                     {
                         if (_indexes[jj] > i)
+                        {
+                            _hash_subscription(_indexes[jj]);
                             _indexes[jj]--;
+                            _hash_subscription(_indexes[jj]);
+                        }
                     }
                     return;
                 }
@@ -117,12 +129,72 @@ namespace esa
 
         /**
          * @brief Returns a vector with the indexes of the entities currently subscribed to the entity updater.
+         * Entities disabled in the table are skipped.
          * 
          * @return vector<entity, Size> 
          */
         [[nodiscard]] vector<index, Size> subscribed()
         {
-            return _indexes;
+            if (!filtering())
+            {
+                ESA_COPY(sizeof(_indexes));
+                return _indexes;
+            }
+            ESA_COPY(_indexes.size() * sizeof(index));
+            vector<index, Size> ids;
+            for (auto i : _indexes)
+            {
+                if (enabled(series.id(i)))
+                    ids.push_back(i);
+            }
+            return ids;
+        }
+
+
+        /**
+         * @brief Returns the number of entities subscribed to the updater. (including disabled ones)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t count() override
+        {
+            return _indexes.size();
+        }
+
+
+        /**
+         * @brief Returns the maximum number of entities that can be subscribed to the updater. (`Size`)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t capacity() override
+        {
+            return Size;
+        }
+
+
+        /**
+         * @brief Write the subscribed indexes to a snapshot.
+         * 
+         * @param w The snapshot writer.
+         */
+        void save(snapshot_writer & w) override
+        {
+            w.write_vector(_indexes);
+        }
+
+
+        /**
+         * @brief Replace the subscribed indexes with the ones read from a snapshot.
+         * 
+         * @param r The snapshot reader.
+         */
+        void load(snapshot_reader & r) override
+        {
+            r.read_vector(_indexes);
+            _reset_subscription_hash();
+            for (index i : _indexes)
+                _hash_subscription(i);
         }
 
 
@@ -13,6 +13,45 @@ namespace esa
     template<typename ComponentType, uint32_t Size>
     class indexed_series : public iseries
     {
+#ifdef ESA_ROLLBACK
+        /**
+         * @brief The rollback epoch in which the series was last saved. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        uint32_t _saved = 0;
+
+
+        /**
+         * @brief The entities whose component was saved alone in the rollback log in the current epoch. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        vector<entity, Size> _touched;
+
+
+        /**
+         * @brief The rollback epoch of `_touched`. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        uint32_t _touched_epoch = 0;
+#endif
+
+
+#ifdef ESA_STATE_HASH
+        /**
+         * @brief The entities whose component changed since the last call to `hash()`. (only with `ESA_STATE_HASH`)
+         * 
+         */
+        vector<entity, Size> _changed;
+
+
+        /**
+         * @brief The hash of the components not changed. (only with `ESA_STATE_HASH`)
+         * 
+         */
+        uint32_t _hash = 0;
+#endif
+
+
         /**
          * @brief Entity IDs associated to each index.
          * 
@@ -27,9 +66,185 @@ namespace esa
         vector<ComponentType, Size> _data;
 
 
+        /**
+         * @brief Returns the size of the entity IDs and of the components, which are contiguous
+         * (without the padding at the end of the indexed series, which depends on the platform).
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t _state_bytes()
+        {
+            return uint32_t(reinterpret_cast<unsigned char *>(&_data + 1) - reinterpret_cast<unsigned char *>(&_entities));
+        }
+
+
+        /**
+         * @brief Save the whole series in the rollback log of the table, before it is changed
+         * for the first time in a frame. Does nothing unless `ESA_ROLLBACK` is defined.
+         * 
+         */
+        void _touch()
+        {
+            _notify_change();
+#ifdef ESA_ROLLBACK
+            if (_rollback != nullptr)
+                _rollback->save(rollback_kind::COLUMN, _rollback_tag, this, _saved);
+#endif
+        }
+
+
+        /**
+         * @brief Save the component at an index in the rollback log of the table, before it is changed for the first
+         * time in a frame: only its bytes, unless the whole series was already saved in the frame (or the component
+         * is not trivially copyable, and the whole series is saved). Does nothing unless `ESA_ROLLBACK` is defined.
+         * 
+         * @param i The index of the component.
+         */
+        void _touch(index i)
+        {
+#ifdef ESA_ROLLBACK
+            if constexpr (__is_trivially_copyable(ComponentType))
+            {
+                _notify_change();
+                if (_rollback == nullptr || !_rollback->recording() || _saved == _rollback->epoch())
+                    return;
+                if (_touched_epoch != _rollback->epoch())
+                {
+                    _touched.clear();
+                    _touched_epoch = _rollback->epoch();
+                }
+                for (entity t : _touched)
+                {
+                    if (t == _entities[i])
+                        return;
+                }
+                _touched.push_back(_entities[i]);
+                rollback_slot s { _rollback_tag, _entities[i], true };
+                _rollback->record(rollback_kind::SLOT, &s, sizeof(s), &_data[i], sizeof(ComponentType));
+            }
+            else
+                _touch();
+#else
+            (void) i;
+            _notify_change();
+#endif
+        }
+
+
+#ifdef ESA_STATE_HASH
+        /**
+         * @brief Returns the entry of a component in the hash: the ID of its entity and its bytes
+         * (only the ID for components that are not trivially copyable). (only with `ESA_STATE_HASH`)
+         * 
+         * @param i The index of the component.
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t _entry(index i)
+        {
+            if constexpr (__is_trivially_copyable(ComponentType))
+                return hash_entry(_entities[i], &_data[i], sizeof(ComponentType));
+            else
+                return hash_entry(_entities[i], nullptr, 0);
+        }
+
+
+        /**
+         * @brief Tells if the component of an entity changed since the last call to `hash()`, and forgets it
+         * if `forget` is true. (only with `ESA_STATE_HASH`)
+         * 
+         * @param e The ID of the entity.
+         * @param forget True to forget the change.
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool _was_changed(entity e, bool forget)
+        {
+            for (uint32_t j = 0; j < _changed.size(); j++)
+            {
+                if (_changed[j] == e)
+                {
+                    if (forget)
+                        _changed.erase(j);
+                    return true;
+                }
+            }
+            return false;
+        }
+#endif
+
+
+        /**
+         * @brief Remove a component from the hash, before it changes. It is added back by `hash()`.
+         * Does nothing unless `ESA_STATE_HASH` is defined.
+         * 
+         * @param i The index of the component.
+         */
+        void _unhash(index i)
+        {
+#ifdef ESA_STATE_HASH
+            if (_was_changed(_entities[i], false))
+                return;
+            _hash ^= _entry(i);
+            _changed.push_back(_entities[i]);
+#endif
+        }
+
+
+        /**
+         * @brief Remove a component from the hash, before it is removed from the series.
+         * Does nothing unless `ESA_STATE_HASH` is defined.
+         * 
+         * @param i The index of the component.
+         */
+        void _hash_remove(index i)
+        {
+#ifdef ESA_STATE_HASH
+            if (!_was_changed(_entities[i], true))
+                _hash ^= _entry(i);
+#endif
+        }
+
+
+        /**
+         * @brief Add the last component to the hash, after it is added to the series.
+         * Does nothing unless `ESA_STATE_HASH` is defined.
+         * 
+         */
+        void _hash_added()
+        {
+#ifdef ESA_STATE_HASH
+            _hash ^= _entry(_entities.size() - 1);
+#endif
+        }
+
+
         public:
 
 
+        /**
+         * @brief Constructor.
+         * 
+         */
+        indexed_series() = default;
+
+
+        /**
+         * @brief Constructor keeping the entity IDs and the components already in memory, e.g. in a file
+         * mapped by `esa::mapped_arena` (see `reattach_t`). Only for trivial components (trivially copyable,
+         * with no default member initializers).
+         * 
+         */
+        indexed_series(reattach_t r) : _entities(r), _data(r)
+        {
+            assert(__is_trivially_copyable(ComponentType) && __is_trivially_constructible(ComponentType)
+                && "ESA ERROR: only columns of trivial components can be reattached!");
+#ifdef ESA_STATE_HASH
+            for (index i = 0; i < _entities.size(); i++)
+                _hash ^= _entry(i);
+#endif
+        }
+
+
         /**
          * @brief Add a component to the entity.
          * 
@@ -39,8 +254,141 @@ namespace esa
         void add(entity e, const ComponentType & c)
         {
             assert(!_entities.full() && "ESA ERROR: indexed series is full!");
+            ESA_ACCESS(_column, _where, access_kind::WRITE, sizeof(entity));
+            ESA_ACCESS(_column, _where, access_kind::WRITE, sizeof(ComponentType));
+            _touch();
             _entities.push_back(e);
             _data.push_back(c);
+            _hash_added();
+        }
+
+
+        /**
+         * @brief Add a component to an entity, copying its bytes. Only for trivially copyable components.
+         * 
+         * @param e The ID of the entity.
+         * @param data The bytes of the component.
+         * @param bytes The size of the component. (must be `sizeof(ComponentType)`)
+         */
+        void add_bytes(entity e, const void * data, uint32_t bytes) override
+        {
+            assert(bytes == sizeof(ComponentType) && "ESA ERROR: wrong component size!");
+            assert(__is_trivially_copyable(ComponentType) && "ESA ERROR: the component is not trivially copyable!");
+            if constexpr (__is_trivially_copyable(ComponentType))
+            {
+                alignas(ComponentType) unsigned char c [ sizeof(ComponentType) ];
+                __builtin_memcpy(c, data, sizeof(ComponentType));
+                add(e, *reinterpret_cast<const ComponentType *>(c));
+            }
+        }
+
+
+        /**
+         * @brief Write the content of the indexed series to a snapshot. Trivially copyable components are written
+         * together with the entity IDs, in one copy; other components are written by `snapshot_hooks`.
+         * 
+         * @param w The snapshot writer.
+         */
+        void save(snapshot_writer & w) override
+        {
+            if constexpr (__is_trivially_copyable(ComponentType))
+                w.write(&_entities, _state_bytes());
+            else
+            {
+                w.write_value(_entities);
+                for (index i = 0; i < _data.size(); i++)
+                    snapshot_hooks<ComponentType>::save(w, _data[i]);
+            }
+        }
+
+
+        /**
+         * @brief Replace the content of the indexed series with the one read from a snapshot.
+         * 
+         * @param r The snapshot reader.
+         */
+        void load(snapshot_reader & r) override
+        {
+            _notify_change();
+            if constexpr (__is_trivially_copyable(ComponentType))
+                r.read(&_entities, _state_bytes());
+            else
+            {
+                for (index i = 0; i < _data.size(); i++)
+                    _data[i].~ComponentType();
+                _data.clear();
+                r.read_value(_entities);
+                for (index i = 0; i < _entities.size(); i++)
+                {
+                    _data.push_back(ComponentType());
+                    snapshot_hooks<ComponentType>::load(r, _data[i]);
+                }
+            }
+#ifdef ESA_STATE_HASH
+            _changed.clear();
+            _hash = 0;
+            for (index i = 0; i < _entities.size(); i++)
+                _hash ^= _entry(i);
+#endif
+        }
+
+
+        /**
+         * @brief Restore the component of an entity saved in a rollback log. Only for trivially copyable components.
+         * 
+         * @param e The ID of the entity.
+         * @param owned True if the entity owned the component. (always, for an indexed series)
+         * @param data The bytes of the component.
+         */
+        void rewind(entity e, bool owned, const void * data) override
+        {
+            if constexpr (__is_trivially_copyable(ComponentType))
+            {
+                for (index i = 0; i < _entities.size(); i++)
+                {
+                    if (_entities[i] == e)
+                    {
+                        _notify_change();
+                        _unhash(i);
+                        __builtin_memcpy(static_cast<void*>(&_data[i]), data, sizeof(ComponentType));
+                        return;
+                    }
+                }
+            }
+        }
+
+
+#ifdef ESA_STATE_HASH
+        /**
+         * @brief Returns the hash of the components (of the entities owning them, and of their bytes).
+         * The cost depends on the number of components changed since the last call. (only with `ESA_STATE_HASH`)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t hash() override
+        {
+            for (entity e : _changed)
+            {
+                for (index i = 0; i < _entities.size(); i++)
+                {
+                    if (_entities[i] == e)
+                        _hash ^= _entry(i);
+                }
+            }
+            _changed.clear();
+            return _hash;
+        }
+#endif
+
+
+        /**
+         * @brief Remove the component from all the entities.
+         * 
+         */
+        void clear() override
+        {
+            while (!_entities.empty())
+                remove(_entities.back());
         }
 
 
@@ -55,6 +403,10 @@ namespace esa
             {
                 if (_entities[i] == e)
                 {
+                    ESA_ACCESS(_column, _where, access_kind::READ, (i + 1) * sizeof(entity));
+                    ESA_ACCESS(_column, _where, access_kind::MODIFY, (_entities.size() - i) * (sizeof(entity) + sizeof(ComponentType)));
+                    _touch();
+                    _hash_remove(i);
                     _entities.erase(i);
                     _data.erase(i);
                     return;
@@ -72,11 +424,15 @@ namespace esa
          */
         [[nodiscard]] bool has(entity e) override
         {
-            for (entity id : _entities)
+            for (index i = 0; i < _entities.size(); i++)
             {
-                if (id == e)
+                if (_entities[i] == e)
+                {
+                    ESA_ACCESS(_column, _where, access_kind::READ, (i + 1) * sizeof(entity));
                     return true;
+                }
             }
+            ESA_ACCESS(_column, _where, access_kind::READ, _entities.size() * sizeof(entity));
             return false;
         }
         
@@ -90,6 +446,9 @@ namespace esa
         [[nodiscard]] ComponentType & get(index i)
         {
             assert(i < _entities.size() && "ESA ERROR: indexed series index is out of bounds!");
+            ESA_ACCESS(_column, _where, access_kind::MODIFY, sizeof(ComponentType));
+            _touch(i);
+            _unhash(i);
             return _data[i];
         }
 
@@ -105,9 +464,39 @@ namespace esa
             for (index i = 0; i < _entities.size(); i++)
             {
                 if (e == _entities[i])
+                {
+                    ESA_ACCESS(_column, _where, access_kind::READ, (i + 1) * sizeof(entity));
+                    ESA_ACCESS(_column, _where, access_kind::MODIFY, sizeof(ComponentType));
+                    _touch(i);
+                    _unhash(i);
                     return _data[i];
+                }
             }
             assert(1 == 2 && "ESA ERROR: entity does not own this indexed component!");
+            return _data[0];
+        }
+
+
+        /**
+         * @brief Returns a constant reference to the component based on an entity ID.
+         * Same as `lookup`, but not treated as a change by the rollback log and the state hash,
+         * and reported as a read when `ESA_INSTRUMENT` is defined.
+         * 
+         * @param e The ID of the entity.
+         * @return const ComponentType& 
+         */
+        [[nodiscard]] const ComponentType & read(entity e)
+        {
+            for (index i = 0; i < _entities.size(); i++)
+            {
+                if (e == _entities[i])
+                {
+                    ESA_ACCESS(_column, _where, access_kind::READ, (i + 1) * sizeof(entity) + sizeof(ComponentType));
+                    return _data[i];
+                }
+            }
+            assert(1 == 2 && "ESA ERROR: entity does not own this indexed component!");
+            return _data[0];
         }
 
 
@@ -120,6 +509,7 @@ namespace esa
         [[nodiscard]] entity id(index i)
         {
             assert(i < _entities.size() && "ESA ERROR: indexed series index is out of bounds!");
+            ESA_ACCESS(_column, _where, access_kind::READ, sizeof(entity));
             return _entities[i];
         }
 
@@ -135,7 +525,10 @@ namespace esa
             for (index i = 0; i < _entities.size(); i++)
             {
                 if (_entities[i] == e)
+                {
+                    ESA_ACCESS(_column, _where, access_kind::READ, (i + 1) * sizeof(entity));
                     return i;
+                }
             }
             assert(1 == 2 && "ESA ERROR: entity does not own this indexed component!");
             return 0;
@@ -151,6 +544,9 @@ namespace esa
         [[nodiscard]] ComponentType & operator[](index i)
         {
             assert(i < _entities.size() && "ECSA ERROR: indexed series index out of range!");
+            ESA_ACCESS(_column, _where, access_kind::MODIFY, sizeof(ComponentType));
+            _touch(i);
+            _unhash(i);
             return _data[i];
         }
 
@@ -165,6 +561,61 @@ namespace esa
             return _entities.size();
         }
 
+
+        /**
+         * @brief Returns the number of entities owning this component. (same as `size()`)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t count() override
+        {
+            return _entities.size();
+        }
+
+
+        /**
+         * @brief Returns the maximum number of entities that can own this component. (`Size`)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t capacity() override
+        {
+            return Size;
+        }
+
+
+        /**
+         * @brief Returns the size of the indexed series, in bytes.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t bytes() override
+        {
+            return sizeof(indexed_series<ComponentType, Size>);
+        }
+
+
+        /**
+         * @brief Returns the size of the entity IDs and of the components in a snapshot.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t state_bytes() override
+        {
+            return _state_bytes();
+        }
+
+
+        /**
+         * @brief Tells if this is an indexed series. (always true)
+         * 
+         * @return true 
+         */
+        [[nodiscard]] bool indexed() override
+        {
+            return true;
+        }
+
     };
 
 }
@@ -0,0 +1,230 @@
+#ifndef ESA_INSTRUMENT_H
+#define ESA_INSTRUMENT_H
+
+#include <cassert>
+
+#include "esa.h"
+
+
+/**
+ * @brief The maximum number of access observers attached at the same time (only used with `ESA_INSTRUMENT`).
+ * 
+ */
+#ifndef ESA_INSTRUMENT_OBSERVERS
+    #define ESA_INSTRUMENT_OBSERVERS 4
+#endif
+
+
+/**
+ * @brief Report an access to a column or to a subscriber list to the attached observers.
+ * Expands to nothing unless `ESA_INSTRUMENT` is defined.
+ * 
+ */
+#ifdef ESA_INSTRUMENT
+    #define ESA_ACCESS(column, where, kind, bytes) esa::instrument::access(column, where, kind, bytes)
+#else
+    #define ESA_ACCESS(column, where, kind, bytes)
+#endif
+
+
+/**
+ * @brief Report the copy of a subscriber list to the attached observers.
+ * Expands to nothing unless `ESA_INSTRUMENT` is defined.
+ * 
+ */
+#ifdef ESA_INSTRUMENT
+    #define ESA_COPY(bytes) esa::instrument::copy(bytes)
+#else
+    #define ESA_COPY(bytes)
+#endif
+
+
+namespace esa
+{
+    /**
+     * @brief How memory is accessed.
+     * 
+     */
+    enum class access_kind : unsigned char
+    {
+        READ,
+        WRITE,
+        MODIFY
+    };
+
+
+    class iaccess_observer
+    {
+        public:
+
+
+        /**
+         * @brief Called for each access.
+         * 
+         * @param updater The tag of the updater running (`instrument::NO_TAG` outside updaters).
+         * @param column The tag of the column (`instrument::SUBSCRIBERS` for subscriber lists).
+         * @param where Where the memory is.
+         * @param kind `READ`, `WRITE`, or `MODIFY` for a mutable reference (assumed to be read and written).
+         * @param bytes The number of bytes.
+         */
+        virtual void access(tag_t updater, tag_t column, ram where, access_kind kind, uint32_t bytes) = 0;
+
+
+        /**
+         * @brief Called at the end of each frame of a table.
+         * 
+         */
+        virtual void end_frame()
+        {
+
+        }
+
+
+        /**
+         * @brief Virtual destructor.
+         * 
+         */
+        virtual ~iaccess_observer() = default;
+    };
+
+
+    /**
+     * @brief Dispatches the accesses made by all the tables to the attached observers, with the tag
+     * of the updater running. Accesses are only reported when `ESA_INSTRUMENT` is defined.
+     * 
+     */
+    class instrument
+    {
+        /**
+         * @brief The observers.
+         * 
+         */
+        inline static iaccess_observer * _observers [ ESA_INSTRUMENT_OBSERVERS ] = {};
+
+
+        /**
+         * @brief The number of observers.
+         * 
+         */
+        inline static uint32_t _count = 0;
+
+
+        /**
+         * @brief The tag of the updater running.
+         * 
+         */
+        inline static tag_t _updater = 0xffff;
+
+
+        public:
+
+
+        /**
+         * @brief Tag used for accesses made outside updaters.
+         * 
+         */
+        static constexpr tag_t NO_TAG = 0xffff;
+
+
+        /**
+         * @brief Column tag used for the subscriber lists of updaters, cached queries and cached apply objects.
+         * 
+         */
+        static constexpr tag_t SUBSCRIBERS = 0xfffe;
+
+
+        /**
+         * @brief Attach an observer.
+         * 
+         * @param o A pointer to the observer.
+         */
+        static void attach(iaccess_observer * o)
+        {
+            assert(_count < ESA_INSTRUMENT_OBSERVERS && "ESA ERROR: too many access observers!");
+            _observers[_count] = o;
+            _count++;
+        }
+
+
+        /**
+         * @brief Detach an observer.
+         * 
+         * @param o A pointer to the observer.
+         */
+        static void detach(iaccess_observer * o)
+        {
+            for (uint32_t i = 0; i < _count; i++)
+            {
+                if (_observers[i] == o)
+                {
+                    _observers[i] = _observers[_count - 1];
+                    _count--;
+                    return;
+                }
+            }
+        }
+
+
+        /**
+         * @brief Set the updater running.
+         * 
+         * @param tag The tag of the updater. (`NO_TAG` = none)
+         */
+        static void set_updater(tag_t tag)
+        {
+            _updater = tag;
+        }
+
+
+        /**
+         * @brief Returns the tag of the updater running. (`NO_TAG` = none)
+         * 
+         * @return tag_t
+         */
+        [[nodiscard]] static tag_t updater()
+        {
+            return _updater;
+        }
+
+
+        /**
+         * @brief Report an access. (it can also be called by user code, e.g. for lookup tables in ROM)
+         * 
+         * @param column The tag of the column.
+         * @param where Where the memory is.
+         * @param kind The kind of access.
+         * @param bytes The number of bytes.
+         */
+        static void access(tag_t column, ram where, access_kind kind, uint32_t bytes)
+        {
+            for (uint32_t i = 0; i < _count; i++)
+                _observers[i]->access(_updater, column, where, kind, bytes);
+        }
+
+
+        /**
+         * @brief Report the copy of a subscriber list (`subscribed()`): read from the object holding it,
+         * written to the stack.
+         * 
+         * @param bytes The number of bytes copied.
+         */
+        static void copy(uint32_t bytes)
+        {
+            access(SUBSCRIBERS, ram::EWRAM, access_kind::READ, bytes);
+            access(SUBSCRIBERS, ram::IWRAM, access_kind::WRITE, bytes);
+        }
+
+
+        /**
+         * @brief Report the end of a frame.
+         * 
+         */
+        static void end_frame()
+        {
+            for (uint32_t i = 0; i < _count; i++)
+                _observers[i]->end_frame();
+        }
+    };
+}
+
+#endif
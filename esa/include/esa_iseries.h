@@ -10,9 +10,184 @@ namespace esa
 {
     class iseries
     {
+#ifdef ESA_INSTRUMENT
+        protected:
+
+
+        /**
+         * @brief The tag of the column, reported with each access. (only with `ESA_INSTRUMENT`)
+         * 
+         */
+        tag_t _column = instrument::NO_TAG;
+
+
+        /**
+         * @brief Where the series is, reported with each access. (only with `ESA_INSTRUMENT`)
+         * 
+         */
+        ram _where = ram::EWRAM;
+#endif
+
+
+#ifdef ESA_ROLLBACK
+        protected:
+
+
+        /**
+         * @brief The rollback log of the table. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        rollback_log * _rollback = nullptr;
+
+
+        /**
+         * @brief The tag of the column, stored in the rollback log. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        tag_t _rollback_tag = 0;
+#endif
+
+
+        protected:
+
+
+        /**
+         * @brief A flag cleared by the first change to the series after `watch()`. (`nullptr` = none)
+         * 
+         */
+        uint32_t * _watched = nullptr;
+
+
+        /**
+         * @brief Clear the watched flag, if any, before the series changes. Only the first change
+         * after `watch()` clears it: the next ones only test a pointer.
+         * 
+         */
+        void _notify_change()
+        {
+            if (_watched != nullptr)
+            {
+                *_watched = 0;
+                _watched = nullptr;
+            }
+        }
+
+
         public:
 
 
+        /**
+         * @brief Clear a flag on the next change to the series (a component added, removed or accessed for writing,
+         * or the series restored), e.g. to tell that a file holding the series no longer matches a saved state.
+         * 
+         * @param flag The flag. (`nullptr` = none)
+         */
+        void watch(uint32_t * flag)
+        {
+            _watched = flag;
+        }
+
+
+        /**
+         * @brief Record the tag of the column and where the series is, to report the accesses
+         * when `ESA_INSTRUMENT` is defined. Called by the table when the column is added.
+         * 
+         * @param column The tag of the column.
+         * @param where Where the series is.
+         */
+        void locate(tag_t column, ram where)
+        {
+#ifdef ESA_INSTRUMENT
+            _column = column;
+            _where = where;
+#endif
+        }
+
+
+#ifdef ESA_INSTRUMENT
+        /**
+         * @brief Returns where the series is, as recorded by the table. (only with `ESA_INSTRUMENT`)
+         * 
+         * @return ram
+         */
+        [[nodiscard]] ram location()
+        {
+            return _where;
+        }
+#endif
+
+
+        /**
+         * @brief Record the changes to the series in a rollback log when `ESA_ROLLBACK` is defined.
+         * Called by the table when the column is added.
+         * 
+         * @param log The rollback log.
+         * @param column The tag of the column.
+         */
+        void track(rollback_log * log, tag_t column)
+        {
+#ifdef ESA_ROLLBACK
+            _rollback = log;
+            _rollback_tag = column;
+#endif
+        }
+
+
+        /**
+         * @brief Restore the component of an entity saved in a rollback log. Only for series of trivially copyable components.
+         * 
+         * @param e The ID of the entity.
+         * @param owned True if the entity owned the component.
+         * @param data The bytes of the component.
+         */
+        virtual void rewind(entity e, bool owned, const void * data)
+        {
+            assert(1 == 2 && "ESA ERROR: the series cannot restore single components!");
+        }
+
+
+        /**
+         * @brief Add a component to an entity, copying its bytes. Only for trivially copyable components.
+         * 
+         * @param e The ID of the entity.
+         * @param data The bytes of the component.
+         * @param bytes The size of the component. (must match the type of the series)
+         */
+        virtual void add_bytes(entity e, const void * data, uint32_t bytes)
+        {
+            assert(1 == 2 && "ESA ERROR: the series cannot add components from bytes!");
+        }
+
+
+        /**
+         * @brief Write the content of the series (which entities own the component, and their components) to a snapshot.
+         * 
+         * @param w The snapshot writer.
+         */
+        virtual void save(snapshot_writer & w)
+        {
+
+        }
+
+
+        /**
+         * @brief Replace the content of the series with the one read from a snapshot.
+         * 
+         * @param r The snapshot reader.
+         */
+        virtual void load(snapshot_reader & r)
+        {
+
+        }
+
+
+        /**
+         * @brief Remove the component from all the entities.
+         * 
+         */
+        virtual void clear() = 0;
+
+
         /**
          * @brief Mark an entity as not owning this component.
          * 
@@ -34,6 +209,76 @@ namespace esa
         }
 
 
+        /**
+         * @brief Returns the number of entities owning this component.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] virtual uint32_t count()
+        {
+            return 0;
+        }
+
+
+        /**
+         * @brief Returns the maximum number of entities that can own this component.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] virtual uint32_t capacity()
+        {
+            return 0;
+        }
+
+
+        /**
+         * @brief Returns the size of the series, in bytes.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] virtual uint32_t bytes()
+        {
+            return 0;
+        }
+
+
+        /**
+         * @brief Returns the size of the content of the series (its entities and components) in a snapshot.
+         * Unlike `bytes()`, it does not depend on the size of pointers, so it is the same on the host and on the GBA.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] virtual uint32_t state_bytes()
+        {
+            return 0;
+        }
+
+
+#ifdef ESA_STATE_HASH
+        /**
+         * @brief Returns the hash of the content of the series. (only with `ESA_STATE_HASH`)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] virtual uint32_t hash()
+        {
+            return 0;
+        }
+#endif
+
+
+        /**
+         * @brief Tells if this is an indexed series.
+         * 
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] virtual bool indexed()
+        {
+            return false;
+        }
+
+
         /**
          * @brief Virtual destructor.
          * 
@@ -1,6 +1,8 @@
 #ifndef ESA_IUPDATER_H
 #define ESA_IUPDATER_H
 
+#include <cassert>
+
 #include "esa.h"
 
 
@@ -23,6 +25,116 @@ namespace esa
         bool _active;
 
 
+        /**
+         * @brief The phase of `entity_table::update()` in which the updater runs.
+         * 
+         */
+        esa::phase _phase;
+
+
+        /**
+         * @brief The updater runs once every `_period` ticks of its phase.
+         * 
+         */
+        uint32_t _period;
+
+
+        /**
+         * @brief The tick (`0`...`_period - 1`) on which the updater runs.
+         * 
+         */
+        uint32_t _offset;
+
+
+        /**
+         * @brief Filter skipping the entities disabled in the table.
+         * 
+         */
+        entity_filter _disabled;
+
+
+#ifdef ESA_ROLLBACK
+        /**
+         * @brief The rollback log of the table. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        rollback_log * _rollback = nullptr;
+
+
+        /**
+         * @brief The rollback epoch in which the state was last saved. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        uint32_t _saved = 0;
+#endif
+
+
+#ifdef ESA_STATE_HASH
+        /**
+         * @brief The hash of the subscribed entities. (only with `ESA_STATE_HASH`)
+         * 
+         */
+        uint32_t _subscribed_hash = 0;
+#endif
+
+
+        protected:
+
+
+        /**
+         * @brief Save the state of the updater in the rollback log of the table, before it is changed
+         * for the first time in a frame. Does nothing unless `ESA_ROLLBACK` is defined.
+         * 
+         */
+        void _touch()
+        {
+#ifdef ESA_ROLLBACK
+            if (_rollback != nullptr)
+                _rollback->save(rollback_kind::UPDATER, _tag, this, _saved);
+#endif
+        }
+
+
+#ifdef ESA_ROLLBACK
+        /**
+         * @brief Returns the rollback log of the table. (`nullptr` = none) (only with `ESA_ROLLBACK`)
+         * 
+         * @return rollback_log* 
+         */
+        [[nodiscard]] rollback_log * _rollback_log()
+        {
+            return _rollback;
+        }
+#endif
+
+
+        /**
+         * @brief Add an entity to the hash of the subscribed entities when it subscribes, or remove it
+         * when it unsubscribes. Does nothing unless `ESA_STATE_HASH` is defined.
+         * 
+         * @param e The ID of the entity. (its index, for index updaters)
+         */
+        void _hash_subscription(entity e)
+        {
+#ifdef ESA_STATE_HASH
+            _subscribed_hash ^= hash_entry(e, nullptr, 0);
+#endif
+        }
+
+
+        /**
+         * @brief Clear the hash of the subscribed entities, before they are added again (e.g. after restoring a snapshot).
+         * Does nothing unless `ESA_STATE_HASH` is defined.
+         * 
+         */
+        void _reset_subscription_hash()
+        {
+#ifdef ESA_STATE_HASH
+            _subscribed_hash = 0;
+#endif
+        }
+
+
         public:
 
 
@@ -35,6 +147,9 @@ namespace esa
         {
             _tag = tag;
             _active = true;
+            _phase = esa::phase::SIM;
+            _period = 1;
+            _offset = 0;
         }
 
 
@@ -84,6 +199,143 @@ namespace esa
         }
 
 
+#ifdef ESA_STATE_HASH
+        /**
+         * @brief Returns the hash of the entities subscribed to the updater, in any order. (only with `ESA_STATE_HASH`)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t subscription_hash()
+        {
+            return _subscribed_hash;
+        }
+#endif
+
+
+        /**
+         * @brief Record the changes to the updater in a rollback log when `ESA_ROLLBACK` is defined.
+         * Called by the table when the updater is added.
+         * 
+         * @param log The rollback log.
+         */
+        void track(rollback_log * log)
+        {
+#ifdef ESA_ROLLBACK
+            _rollback = log;
+#endif
+        }
+
+
+        /**
+         * @brief Attach the filter of the entities disabled in the table.
+         * 
+         * @param f The filter.
+         */
+        void set_filter(entity_filter f)
+        {
+            _disabled = f;
+        }
+
+
+        /**
+         * @brief Tells if some entity is currently disabled in the table.
+         * 
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool filtering()
+        {
+            return _disabled.active();
+        }
+
+
+        /**
+         * @brief Tells if an entity is enabled (not disabled in the table).
+         * 
+         * @param e The ID of the entity.
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool enabled(entity e)
+        {
+            return !_disabled.excludes(e);
+        }
+
+
+        /**
+         * @brief Returns the phase of `entity_table::update()` in which the updater runs.
+         * 
+         * @return esa::phase 
+         */
+        [[nodiscard]] esa::phase phase()
+        {
+            return _phase;
+        }
+
+
+        /**
+         * @brief Assign the updater to a phase of `entity_table::update()`.
+         * 
+         * @param p The phase.
+         */
+        void set_phase(esa::phase p)
+        {
+            _phase = p;
+        }
+
+
+        /**
+         * @brief Make the updater run once every `period` ticks of its phase 
+         * (frames, or simulation steps for the `SIM` phase). Updaters with the same
+         * period and different offsets are staggered across frames.
+         * 
+         * @param period The number of ticks between two runs. (`1` = every tick)
+         * @param offset The tick on which the updater runs (`0`...`period - 1`).
+         */
+        void set_rate(uint32_t period, uint32_t offset)
+        {
+            assert(period > 0 && "ESA ERROR: updater period must be larger than zero!");
+            assert(offset < period && "ESA ERROR: updater offset must be smaller than its period!");
+            _period = period;
+            _offset = offset;
+        }
+
+
+        /**
+         * @brief Returns the number of ticks between two runs of the updater.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t period()
+        {
+            return _period;
+        }
+
+
+        /**
+         * @brief Returns the tick on which the updater runs.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t offset()
+        {
+            return _offset;
+        }
+
+
+        /**
+         * @brief Tells if the updater is due to run at a certain tick of its phase.
+         * 
+         * @param tick The tick counter of the phase.
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool due(uint32_t tick)
+        {
+            return _period == 1 || tick % _period == _offset;
+        }
+
+
         /**
          * @brief Initialzie the updater.
          * 
@@ -94,6 +346,31 @@ namespace esa
         }
 
 
+        /**
+         * @brief Called when a timer scheduled for this updater with
+         * `entity_table::schedule` expires. Timers are processed at the 
+         * beginning of `entity_table::update()`, before any phase.
+         * 
+         * @param e The ID of the entity the timer was scheduled for.
+         */
+        virtual void expired(entity e)
+        {
+
+        }
+
+
+        /**
+         * @brief Called when an entity disabled in the table is enabled again
+         * with `entity_table::enable`.
+         * 
+         * @param e The ID of the entity.
+         */
+        virtual void reenabled(entity e)
+        {
+
+        }
+
+
         /**
          * @brief Execute update logic.
          * 
@@ -113,6 +390,62 @@ namespace esa
         }
 
 
+        /**
+         * @brief Returns the number of entities subscribed to the updater. (`0` for table updaters)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] virtual uint32_t count()
+        {
+            return 0;
+        }
+
+
+        /**
+         * @brief Returns the maximum number of entities that can be subscribed to the updater. (`0` for table updaters)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] virtual uint32_t capacity()
+        {
+            return 0;
+        }
+
+
+        /**
+         * @brief Write the state of the updater (e.g. its subscribed entities; nothing for table updaters) to a snapshot.
+         * 
+         * @param w The snapshot writer.
+         */
+        virtual void save(snapshot_writer & w)
+        {
+
+        }
+
+
+        /**
+         * @brief Replace the state of the updater with the one read from a snapshot.
+         * 
+         * @param r The snapshot reader.
+         */
+        virtual void load(snapshot_reader & r)
+        {
+
+        }
+
+
+        /**
+         * @brief Tells if the updater processes its entities across frames.
+         * 
+         * @return true 
+         * @return false 
+         */
+        virtual bool sliced()
+        {
+            return false;
+        }
+
+
         /**
          * @brief Virtual destructor.
          * 
@@ -146,6 +479,19 @@ namespace esa
         virtual void subscribe(entity e) = 0;
 
 
+        /**
+         * @brief Subscribe several entities to the updater. By default they are subscribed one by one.
+         * 
+         * @param entities The IDs of the entities.
+         * @param count The number of entities.
+         */
+        virtual void subscribe(const entity * entities, uint32_t count)
+        {
+            for (uint32_t i = 0; i < count; i++)
+                subscribe(entities[i]);
+        }
+
+
         /**
          * @brief Unsubscribe an entity from an updater.
          * 
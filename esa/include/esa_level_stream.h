@@ -0,0 +1,618 @@
+#ifndef ESA_LEVEL_STREAM_H
+#define ESA_LEVEL_STREAM_H
+
+#include <cassert>
+
+#include "esa.h"
+
+
+namespace esa
+{
+    /**
+     * @brief The header of a level stream. It is followed by the prefabs, then by the entities.
+     * 
+     * A prefab is the number of its components (2 bytes), followed by the components. An entity is
+     * its prefab (2 bytes, `0` = none, `1` = the first prefab, ...), its priority (2 bytes) and the number
+     * of its components (2 bytes), followed by the components. A component is its tag (2 bytes), its size
+     * (2 bytes) and its bytes. All the numbers are little-endian.
+     * 
+     */
+    struct level_header
+    {
+        /**
+         * @brief Identifies a level stream ("ESAV").
+         * 
+         */
+        static constexpr uint32_t MAGIC = 0x56415345;
+
+
+        /**
+         * @brief The version of the format.
+         * 
+         */
+        static constexpr uint32_t VERSION = 1;
+
+
+        uint32_t magic;
+        uint32_t version;
+
+
+        /**
+         * @brief The size of the stream, in bytes (header included).
+         * 
+         */
+        uint32_t bytes;
+
+
+        /**
+         * @brief The number of prefabs, and of entities.
+         * 
+         */
+        uint32_t prefabs;
+        uint32_t entities;
+    };
+
+
+    /**
+     * @brief Writes a level stream to a buffer (e.g. in a host tool, or in the game to generate a level).
+     * Without a buffer, it only counts the bytes.
+     * 
+     */
+    class level_writer
+    {
+        /**
+         * @brief The buffer. (`nullptr` = count only)
+         * 
+         */
+        unsigned char * _buffer;
+
+
+        /**
+         * @brief The size of the buffer.
+         * 
+         */
+        uint32_t _capacity;
+
+
+        /**
+         * @brief The number of bytes written (or counted).
+         * 
+         */
+        uint32_t _size;
+
+
+        /**
+         * @brief The position of the component count of the current prefab or entity.
+         * 
+         */
+        uint32_t _record;
+
+
+        /**
+         * @brief The header, written to the buffer by `finish()`.
+         * 
+         */
+        level_header _header;
+
+
+        /**
+         * @brief Write a 16-bit number at a position. Nothing is written past the end of the buffer.
+         * 
+         */
+        void _put(uint32_t position, uint32_t value)
+        {
+            if (_buffer != nullptr && position + 2 <= _capacity)
+            {
+                _buffer[position] = (unsigned char) value;
+                _buffer[position + 1] = (unsigned char) (value >> 8);
+            }
+        }
+
+
+        /**
+         * @brief Write a 16-bit number.
+         * 
+         */
+        void _write16(uint32_t value)
+        {
+            _put(_size, value);
+            _size += 2;
+        }
+
+
+        /**
+         * @brief Increment the component count of the current prefab or entity.
+         * 
+         */
+        void _count()
+        {
+            if (_buffer != nullptr && _record + 2 <= _capacity)
+                _put(_record, (_buffer[_record] | (_buffer[_record + 1] << 8)) + 1);
+        }
+
+
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         * @param buffer The buffer. (`nullptr` to only count the bytes)
+         * @param bytes The size of the buffer.
+         */
+        level_writer(void * buffer, uint32_t bytes)
+        {
+            _buffer = static_cast<unsigned char *>(buffer);
+            _capacity = bytes;
+            _size = sizeof(level_header);
+            _record = 0;
+            _header = level_header { level_header::MAGIC, level_header::VERSION, 0, 0, 0 };
+        }
+
+
+        /**
+         * @brief Begin a prefab: the components written next belong to it. All the prefabs must be written
+         * before the first entity.
+         * 
+         * @return uint32_t The reference to the prefab, to be passed to `begin_entity()`.
+         */
+        uint32_t begin_prefab()
+        {
+            assert(_header.entities == 0 && "ESA ERROR: prefabs must be written before the entities!");
+            _record = _size;
+            _write16(0);
+            return ++_header.prefabs;
+        }
+
+
+        /**
+         * @brief Begin an entity: the components written next belong to it.
+         * 
+         * @param priority The priority of the entity: entities with a lower value are loaded first
+         * (e.g. the distance from the spawn point of the player).
+         * @param prefab The prefab of the entity, whose components it gets unless it has its own. (`0` = none)
+         */
+        void begin_entity(uint32_t priority = 0, uint32_t prefab = 0)
+        {
+            assert(prefab <= _header.prefabs && "ESA ERROR: prefab could not be found!");
+            assert(priority <= 0xffff && "ESA ERROR: entity priority is too large!");
+            _write16(prefab);
+            _write16(priority);
+            _record = _size;
+            _write16(0);
+            _header.entities++;
+        }
+
+
+        /**
+         * @brief Write a component of the current prefab or entity. Only for trivially copyable components.
+         * 
+         * @param tag The unique tag of the component.
+         * @param data The bytes of the component.
+         * @param bytes The size of the component.
+         */
+        void component(tag_t tag, const void * data, uint32_t bytes)
+        {
+            assert(_header.prefabs + _header.entities > 0 && "ESA ERROR: component written outside of a prefab or entity!");
+            assert(bytes <= 0xffff && "ESA ERROR: component too large for a level stream!");
+            _count();
+            _write16(tag);
+            _write16(bytes);
+            if (_buffer != nullptr && _size + bytes <= _capacity)
+                __builtin_memcpy(_buffer + _size, data, bytes);
+            _size += bytes;
+        }
+
+
+        /**
+         * @brief Write a component of the current prefab or entity.
+         * 
+         * @tparam ComponentType The type of the component.
+         * @param tag The unique tag of the component.
+         * @param c The component.
+         */
+        template<typename ComponentType>
+        void component(tag_t tag, const ComponentType & c)
+        {
+            static_assert(__is_trivially_copyable(ComponentType), "ESA ERROR: the component is not trivially copyable!");
+            component(tag, &c, sizeof(ComponentType));
+        }
+
+
+        /**
+         * @brief Write the header, once all the prefabs and entities are written.
+         * 
+         * @return uint32_t The size of the stream, or `0` if the buffer is too small.
+         */
+        uint32_t finish()
+        {
+            _header.bytes = _size;
+            if (_buffer == nullptr || _size > _capacity)
+                return _buffer == nullptr ? _size : 0;
+            __builtin_memcpy(_buffer, &_header, sizeof(level_header));
+            return _size;
+        }
+
+
+        /**
+         * @brief Returns the number of bytes written (or counted).
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t size()
+        {
+            return _size;
+        }
+    };
+
+
+    /**
+     * @brief Loads a level stream into a table across frames: each call to `update()` creates at most a certain
+     * number of entities, or spends at most a certain time, so that a large level does not stall a single frame.
+     * The entities are loaded by priority (then in the order of the stream), and the entities created by each
+     * call are subscribed together, updater by updater (see `entity_table::subscribe(const entity *, uint32_t)`).
+     * 
+     * @tparam Table The type of the table.
+     * @tparam Records The maximum number of entities in a stream.
+     * @tparam Prefabs The maximum number of prefabs in a stream.
+     */
+    template<typename Table, uint32_t Records, uint32_t Prefabs = 32>
+    class level_stream
+    {
+        /**
+         * @brief An entity not loaded yet.
+         * 
+         */
+        struct pending
+        {
+            uint32_t offset;
+            uint32_t priority;
+        };
+
+
+        /**
+         * @brief The table.
+         * 
+         */
+        Table & _table;
+
+
+        /**
+         * @brief The stream. (`nullptr` = none)
+         * 
+         */
+        const unsigned char * _data;
+
+
+        /**
+         * @brief The offset of each prefab in the stream.
+         * 
+         */
+        vector<uint32_t, Prefabs> _prefabs;
+
+
+        /**
+         * @brief The entities not loaded yet: a heap, whose first element is the next entity to load.
+         * 
+         */
+        vector<pending, Records> _pending;
+
+
+        /**
+         * @brief The entities created by the last call to `update()`.
+         * 
+         */
+        vector<entity, Records> _created;
+
+
+        /**
+         * @brief The number of entities in the stream.
+         * 
+         */
+        uint32_t _total;
+
+
+        /**
+         * @brief Maximum number of entities created per call to `update()`. (`0` = no limit)
+         * 
+         */
+        uint32_t _budget;
+
+
+        /**
+         * @brief Clock used for the time budget. (`nullptr` = no time budget)
+         * 
+         */
+        clock_fn _clock;
+
+
+        /**
+         * @brief Maximum time spent per call to `update()`, in clock units.
+         * 
+         */
+        uint32_t _time_budget;
+
+
+        /**
+         * @brief Read a 16-bit number.
+         * 
+         */
+        [[nodiscard]] uint32_t _get(uint32_t offset)
+        {
+            return _data[offset] | (_data[offset + 1] << 8);
+        }
+
+
+        /**
+         * @brief Tells if an entity must be loaded before another one.
+         * 
+         */
+        [[nodiscard]] static bool _before(const pending & a, const pending & b)
+        {
+            return a.priority < b.priority || (a.priority == b.priority && a.offset < b.offset);
+        }
+
+
+        /**
+         * @brief Move an element of the heap down to its place.
+         * 
+         */
+        void _sift(uint32_t i)
+        {
+            uint32_t size = _pending.size();
+            while (true)
+            {
+                uint32_t first = i;
+                uint32_t left = 2 * i + 1;
+                if (left < size && _before(_pending[left], _pending[first]))
+                    first = left;
+                if (left + 1 < size && _before(_pending[left + 1], _pending[first]))
+                    first = left + 1;
+                if (first == i)
+                    return;
+                pending p = _pending[i];
+                _pending[i] = _pending[first];
+                _pending[first] = p;
+                i = first;
+            }
+        }
+
+
+        /**
+         * @brief Check the components of a prefab or entity, and return the offset after them (`0` = truncated).
+         * 
+         */
+        [[nodiscard]] uint32_t _skip(uint32_t offset, uint32_t bytes)
+        {
+            if (offset + 2 > bytes)
+                return 0;
+            uint32_t components = _get(offset);
+            offset += 2;
+            for (uint32_t c = 0; c < components; c++)
+            {
+                if (offset + 4 > bytes || offset + 4 + _get(offset + 2) > bytes)
+                    return 0;
+                offset += 4 + _get(offset + 2);
+            }
+            return offset;
+        }
+
+
+        /**
+         * @brief Add the components of a prefab or entity to an entity, except the ones it already has.
+         * 
+         */
+        void _add(entity e, uint32_t offset)
+        {
+            uint32_t components = _get(offset);
+            offset += 2;
+            for (uint32_t c = 0; c < components; c++)
+            {
+                tag_t tag = tag_t(_get(offset));
+                uint32_t bytes = _get(offset + 2);
+                iseries * column = _table.column(tag);
+                assert(column != nullptr && "ESA ERROR: component could not be found!");
+                if (!column->has(e))
+                    _table.add_bytes(e, tag, _data + offset + 4, bytes);
+                offset += 4 + bytes;
+            }
+        }
+
+
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         * @param table The table in which the entities are created.
+         */
+        level_stream(Table & table) : _table(table)
+        {
+            _data = nullptr;
+            _total = 0;
+            _budget = 0;
+            _clock = nullptr;
+            _time_budget = 0;
+        }
+
+
+        /**
+         * @brief Start loading a stream (e.g. a `const` array in ROM, which must stay valid until the stream is loaded).
+         * The stream is checked and its entities are sorted by priority, but no entity is created yet.
+         * 
+         * @param data The stream.
+         * @param bytes The size of the stream, in bytes.
+         * @return true 
+         * @return false The stream is not a valid level stream, or it has too many entities or prefabs.
+         */
+        bool open(const void * data, uint32_t bytes)
+        {
+            close();
+            level_header h;
+            if (bytes < sizeof(level_header))
+                return false;
+            __builtin_memcpy(&h, data, sizeof(level_header));
+            if (h.magic != level_header::MAGIC || h.version != level_header::VERSION || h.bytes > bytes
+                || h.prefabs > Prefabs || h.entities > Records)
+                return false;
+            _data = static_cast<const unsigned char *>(data);
+            uint32_t offset = sizeof(level_header);
+            for (uint32_t i = 0; i < h.prefabs && offset != 0; i++)
+            {
+                _prefabs.push_back(offset);
+                offset = _skip(offset, h.bytes);
+            }
+            for (uint32_t i = 0; i < h.entities && offset != 0; i++)
+            {
+                if (offset + 4 > h.bytes || _get(offset) > h.prefabs)
+                    offset = 0;
+                else
+                {
+                    _pending.push_back(pending { offset, _get(offset + 2) });
+                    offset = _skip(offset + 4, h.bytes);
+                }
+            }
+            if (offset == 0)
+            {
+                close();
+                return false;
+            }
+            for (uint32_t i = _pending.size() / 2; i > 0; i--)
+                _sift(i - 1);
+            _total = h.entities;
+            return true;
+        }
+
+
+        /**
+         * @brief Stop loading the current stream. The entities already created stay in the table.
+         * 
+         */
+        void close()
+        {
+            _data = nullptr;
+            _prefabs.clear();
+            _pending.clear();
+            _created.clear();
+            _total = 0;
+        }
+
+
+        /**
+         * @brief Set the maximum number of entities created per call to `update()`.
+         * 
+         * @param entities The number of entities. (`0` = no limit)
+         */
+        void set_budget(uint32_t entities)
+        {
+            _budget = entities;
+        }
+
+
+        /**
+         * @brief Set the maximum time spent per call to `update()`. The budget is checked after
+         * each entity, so at least one entity is always created.
+         * 
+         * @param clock A function returning the current time. (a GBA timer, `clock_gettime`, ...)
+         * @param budget The time budget, in clock units.
+         */
+        void set_time_budget(clock_fn clock, uint32_t budget)
+        {
+            _clock = clock;
+            _time_budget = budget;
+        }
+
+
+        /**
+         * @brief Create the next entities of the stream, with their components, within the budget, then subscribe them.
+         * Call it once per frame (e.g. before `entity_table::update()`) until `done()`. When the table is full,
+         * no entity is created: the rest of the stream is loaded by the next calls, once entities are destroyed.
+         * 
+         * @return uint32_t The number of entities created.
+         */
+        uint32_t update()
+        {
+            _created.clear();
+            uint32_t start = _clock != nullptr ? (*_clock)() : 0;
+            while (!_pending.empty() && !_table.full())
+            {
+                uint32_t offset = _pending[0].offset;
+                _pending[0] = _pending.back();
+                _pending.pop_back();
+                _sift(0);
+                entity e = _table.create();
+                uint32_t prefab = _get(offset);
+                _add(e, offset + 4);
+                if (prefab > 0)
+                    _add(e, _prefabs[prefab - 1]);
+                _created.push_back(e);
+                if (_budget > 0 && _created.size() >= _budget)
+                    break;
+                if (_clock != nullptr && (*_clock)() - start >= _time_budget)
+                    break;
+            }
+            _table.subscribe(_created.begin(), _created.size());
+            return _created.size();
+        }
+
+
+        /**
+         * @brief Returns the entities created by the last call to `update()`, e.g. to link them to other entities.
+         * 
+         * @return vector<entity, Records>& 
+         */
+        [[nodiscard]] vector<entity, Records> & created()
+        {
+            return _created;
+        }
+
+
+        /**
+         * @brief Tells if all the entities of the stream were created.
+         * 
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool done()
+        {
+            return _pending.empty();
+        }
+
+
+        /**
+         * @brief Returns the number of entities in the stream.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t total()
+        {
+            return _total;
+        }
+
+
+        /**
+         * @brief Returns the number of entities created so far.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t loaded()
+        {
+            return _total - _pending.size();
+        }
+
+
+        /**
+         * @brief Returns the priority of the next entity to be created, e.g. to wait until all the entities
+         * near the player are loaded before starting the level. (`0xffffffff` when done)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t next_priority()
+        {
+            return _pending.empty() ? 0xffffffffu : _pending[0].priority;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,347 @@
+#ifndef ESA_MEMORY_SIM_H
+#define ESA_MEMORY_SIM_H
+
+#include <cassert>
+
+#include "esa.h"
+
+
+namespace esa
+{
+    /**
+     * @brief The cost of accessing a memory region: the width of its bus, and the cycles taken by each transfer
+     * (1 + the number of wait states).
+     * 
+     */
+    struct wait_states
+    {
+        /**
+         * @brief The number of bytes moved by each transfer.
+         * 
+         */
+        uint32_t bus_bytes;
+
+
+        /**
+         * @brief The number of cycles taken by each transfer.
+         * 
+         */
+        uint32_t cycles;
+    };
+
+
+    /**
+     * @brief The accesses made to a memory region.
+     * 
+     */
+    struct region_counters
+    {
+        /**
+         * @brief The number of reads.
+         * 
+         */
+        uint32_t reads;
+
+
+        /**
+         * @brief The number of writes.
+         * 
+         */
+        uint32_t writes;
+
+
+        /**
+         * @brief The number of bytes read.
+         * 
+         */
+        unsigned long long read_bytes;
+
+
+        /**
+         * @brief The number of bytes written.
+         * 
+         */
+        unsigned long long write_bytes;
+
+
+        /**
+         * @brief The estimated number of cycles.
+         * 
+         */
+        unsigned long long cycles;
+    };
+
+
+    /**
+     * @brief Estimates the cycles spent accessing IWRAM, EWRAM and ROM by each updater, from the accesses
+     * reported when `ESA_INSTRUMENT` is defined. It runs on any host: attach it with `instrument::attach`,
+     * run some frames, then compare the cycles of the updaters with the columns placed in different memories.
+     * 
+     * @tparam Updaters The maximum number of updaters tracked.
+     * @tparam Frames The number of frames kept for each updater. (64 by default)
+     */
+    template<uint32_t Updaters, uint32_t Frames>
+    class memory_sim : public iaccess_observer
+    {
+        /**
+         * @brief The wait states of IWRAM, EWRAM and ROM.
+         * 
+         */
+        wait_states _model [ 3 ];
+
+
+        /**
+         * @brief The accesses made to IWRAM, EWRAM and ROM.
+         * 
+         */
+        region_counters _regions [ 3 ];
+
+
+        /**
+         * @brief The tag of the updater tracked in each slot, in order of first access.
+         * 
+         */
+        tag_t _tags [ Updaters == 0 ? 1 : Updaters ];
+
+
+        /**
+         * @brief Cycles spent by each updater.
+         * 
+         */
+        profile_samples<Frames> _updaters [ Updaters == 0 ? 1 : Updaters ];
+
+
+        /**
+         * @brief Cycles spent outside updaters (creating entities, subscribing, destroying, ...).
+         * 
+         */
+        profile_samples<Frames> _outside;
+
+
+        /**
+         * @brief The number of slots in use.
+         * 
+         */
+        uint32_t _slots;
+
+
+        /**
+         * @brief The number of frames recorded.
+         * 
+         */
+        uint32_t _frames;
+
+
+        /**
+         * @brief Find the slot of an updater, adding it if it was never seen.
+         * 
+         * @param tag The tag of the updater.
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t _slot(tag_t tag)
+        {
+            for (uint32_t i = 0; i < _slots; i++)
+            {
+                if (_tags[i] == tag)
+                    return i;
+            }
+            assert(_slots < Updaters && "ESA ERROR: too many updaters for the memory simulator!");
+            _tags[_slots] = tag;
+            _slots++;
+            return _slots - 1;
+        }
+
+
+        /**
+         * @brief Find the slot of an updater.
+         * 
+         * @param tag The tag of the updater.
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t _find(tag_t tag)
+        {
+            for (uint32_t i = 0; i < _slots; i++)
+            {
+                if (_tags[i] == tag)
+                    return i;
+            }
+            assert(1 == 2 && "ESA ERROR: the updater made no accesses yet!");
+            return 0;
+        }
+
+
+        public:
+
+
+        /**
+         * @brief Constructor. The default model is the GBA one: IWRAM has a 32-bit bus and no wait states,
+         * EWRAM a 16-bit bus and 2 wait states, ROM a 16-bit bus and 4 wait states (sequential accesses are not modelled).
+         * 
+         */
+        memory_sim()
+        {
+            set_model(ram::IWRAM, 4, 1);
+            set_model(ram::EWRAM, 2, 3);
+            set_model(ram::ROM, 2, 5);
+            _slots = 0;
+            reset();
+        }
+
+
+        /**
+         * @brief Set the cost of accessing a memory region.
+         * 
+         * @param where The memory region.
+         * @param bus_bytes The number of bytes moved by each transfer.
+         * @param cycles The number of cycles taken by each transfer.
+         */
+        void set_model(ram where, uint32_t bus_bytes, uint32_t cycles)
+        {
+            assert(bus_bytes > 0 && "ESA ERROR: the bus of a memory region cannot be empty!");
+            _model[uint32_t(where)] = wait_states { bus_bytes, cycles };
+        }
+
+
+        /**
+         * @brief Returns the estimated number of cycles of an access. (a `MODIFY` access is a read plus a write)
+         * 
+         * @param where The memory region.
+         * @param kind The kind of access.
+         * @param bytes The number of bytes.
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t cost(ram where, access_kind kind, uint32_t bytes)
+        {
+            const wait_states & m = _model[uint32_t(where)];
+            uint32_t cycles = (bytes + m.bus_bytes - 1) / m.bus_bytes * m.cycles;
+            return kind == access_kind::MODIFY ? 2 * cycles : cycles;
+        }
+
+
+        /**
+         * @brief Count an access.
+         * 
+         */
+        void access(tag_t updater, tag_t column, ram where, access_kind kind, uint32_t bytes) override
+        {
+            (void) column;
+            region_counters & r = _regions[uint32_t(where)];
+            if (kind != access_kind::WRITE)
+            {
+                r.reads++;
+                r.read_bytes += bytes;
+            }
+            if (kind != access_kind::READ)
+            {
+                r.writes++;
+                r.write_bytes += bytes;
+            }
+            uint32_t cycles = cost(where, kind, bytes);
+            r.cycles += cycles;
+            if (updater == instrument::NO_TAG)
+                _outside.add(cycles);
+            else
+                _updaters[_slot(updater)].add(cycles);
+        }
+
+
+        /**
+         * @brief Close the current frame. Updaters store a sample only for the frames in which they made accesses.
+         * 
+         */
+        void end_frame() override
+        {
+            for (uint32_t i = 0; i < _slots; i++)
+                _updaters[i].commit(false);
+            _outside.commit(true);
+            _frames++;
+        }
+
+
+        /**
+         * @brief Discard all the counters and samples. (the model is kept)
+         * 
+         */
+        void reset()
+        {
+            for (uint32_t i = 0; i < 3; i++)
+                _regions[i] = region_counters {};
+            for (uint32_t i = 0; i < Updaters; i++)
+                _updaters[i].reset();
+            _outside.reset();
+            _frames = 0;
+        }
+
+
+        /**
+         * @brief Returns the number of frames recorded.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t frames()
+        {
+            return _frames;
+        }
+
+
+        /**
+         * @brief Returns the accesses made to a memory region.
+         * 
+         * @param where The memory region.
+         * @return const region_counters&
+         */
+        [[nodiscard]] const region_counters & region(ram where)
+        {
+            return _regions[uint32_t(where)];
+        }
+
+
+        /**
+         * @brief Returns the estimated cycles per frame of an updater.
+         * 
+         * @param tag The tag of the updater.
+         * @return profile_samples<Frames>&
+         */
+        [[nodiscard]] profile_samples<Frames> & updater(tag_t tag)
+        {
+            return _updaters[_find(tag)];
+        }
+
+
+        /**
+         * @brief Returns the estimated cycles per frame spent outside updaters.
+         * 
+         * @return profile_samples<Frames>&
+         */
+        [[nodiscard]] profile_samples<Frames> & outside()
+        {
+            return _outside;
+        }
+
+
+        /**
+         * @brief Returns the number of updaters that made accesses.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t updaters()
+        {
+            return _slots;
+        }
+
+
+        /**
+         * @brief Returns the tag of the updater in a certain slot (in order of first access).
+         * 
+         * @param slot The slot.
+         * @return tag_t
+         */
+        [[nodiscard]] tag_t tag(uint32_t slot)
+        {
+            assert(slot < _slots && "ESA ERROR: memory simulator slot out of range!");
+            return _tags[slot];
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,453 @@
+#ifndef ESA_OP_LOG_H
+#define ESA_OP_LOG_H
+
+#include <cassert>
+
+#include "esa.h"
+
+
+/**
+ * @brief The size of the buffer of the operation log of each table, in bytes (only used with `ESA_OP_LOG`).
+ * 
+ */
+#ifndef ESA_OP_LOG_BYTES
+    #define ESA_OP_LOG_BYTES 4096
+#endif
+
+
+/**
+ * @brief Record a structural operation in the operation log of a table.
+ * Expands to nothing unless `ESA_OP_LOG` is defined.
+ * 
+ */
+#ifdef ESA_OP_LOG
+    #define ESA_LOG_OP(log, op) log.op
+#else
+    #define ESA_LOG_OP(log, op)
+#endif
+
+
+namespace esa
+{
+    /**
+     * @brief The structural operations recorded by an operation log.
+     * 
+     */
+    enum class op_kind : unsigned char
+    {
+        CREATE,
+        DESTROY,
+        DISABLE,
+        ENABLE,
+        ADD,
+        SUBSCRIBE,
+        UNSUBSCRIBE,
+        ACTIVATE,
+        DEACTIVATE,
+        ACTIVATE_ALL,
+        DEACTIVATE_ALL,
+        DESTROY_AFTER,
+        FRAME,
+        FRAME_ELAPSED,
+        SUBSCRIBE_UPDATER,
+        UNSUBSCRIBE_UPDATER,
+        SUBSCRIBE_QUERY,
+        UNSUBSCRIBE_QUERY,
+        SUBSCRIBE_APPLY,
+        UNSUBSCRIBE_APPLY
+    };
+
+
+    /**
+     * @brief The header at the start of an operation stream.
+     * 
+     */
+    struct op_log_header
+    {
+        /**
+         * @brief Identifies an operation stream ("ESAL").
+         * 
+         */
+        static constexpr uint32_t MAGIC = 0x4c415345;
+
+
+        /**
+         * @brief The version of the format.
+         * 
+         */
+        static constexpr uint32_t VERSION = 2;
+
+
+        /**
+         * @brief The size of the header in the stream, in bytes.
+         * 
+         */
+        static constexpr uint32_t BYTES = 8;
+
+
+        /**
+         * @brief Bit set in the kind of the operations made during `update()` (by updaters, or by timers).
+         * 
+         */
+        static constexpr unsigned char INNER = 0x80;
+    };
+
+
+    /**
+     * @brief Records the structural operations made on a table (entities created, destroyed, disabled and enabled,
+     * components added with their bytes, subscriptions to all or to single updaters, cached queries and cached apply objects,
+     * updaters activated and deactivated, frames) in a compact
+     * binary stream, which can be replayed on the host with `esa::replay_ops` (`esa_op_replay.h`).
+     * When the buffer is full, it is passed to a sink (if any) and emptied; without a sink, the recording stops,
+     * so that the stream is always a valid prefix of the session.
+     * 
+     * Stream: an `op_log_header` ("ESAL", version as 4 bytes), then one record per operation: the kind (1 byte,
+     * `op_log_header::INNER` set for operations made during `update()`), then its arguments, little endian:
+     * the entity (2 bytes), the tag of the updater, cached query, cached apply object or component (2 bytes), the size of the component (2 bytes)
+     * followed by its bytes, the frames of `destroy_after` or the elapsed time of `update(elapsed)` (4 bytes).
+     * 
+     * @tparam Bytes The size of the buffer.
+     */
+    template<uint32_t Bytes>
+    class op_log
+    {
+        /**
+         * @brief The buffer.
+         * 
+         */
+        unsigned char _buffer [ Bytes ];
+
+
+        /**
+         * @brief The number of bytes in the buffer.
+         * 
+         */
+        uint32_t _size;
+
+
+        /**
+         * @brief The total number of bytes recorded (including the ones passed to the sink).
+         * 
+         */
+        uint32_t _total;
+
+
+        /**
+         * @brief The number of operations recorded.
+         * 
+         */
+        uint32_t _ops;
+
+
+        /**
+         * @brief The number of operations dropped because the buffer was full (and all the ones after the first one dropped).
+         * 
+         */
+        uint32_t _dropped;
+
+
+        /**
+         * @brief True while the table is updating.
+         * 
+         */
+        bool _inner;
+
+
+        /**
+         * @brief True if the operations are recorded.
+         * 
+         */
+        bool _enabled;
+
+
+        /**
+         * @brief The function receiving the buffer when it is full. (`nullptr` = none)
+         * 
+         */
+        dump_fn _sink;
+
+
+        /**
+         * @brief Append a value to the buffer, little endian.
+         * 
+         */
+        void _put(uint32_t value, uint32_t bytes)
+        {
+            for (uint32_t i = 0; i < bytes; i++)
+                _buffer[_size++] = (unsigned char) (value >> (8 * i));
+        }
+
+
+        /**
+         * @brief Start a record of a certain size, flushing the buffer if needed.
+         * 
+         * @return true There is room for the record.
+         * @return false The record is dropped.
+         */
+        [[nodiscard]] bool _begin(op_kind kind, uint32_t bytes)
+        {
+            if (!_enabled)
+                return false;
+            if (_dropped == 0 && _size + bytes > Bytes && _sink != nullptr)
+                flush();
+            if (_dropped > 0 || _size + bytes > Bytes)
+            {
+                _dropped++;
+                return false;
+            }
+            _put((unsigned char) kind | (_inner ? op_log_header::INNER : 0), 1);
+            _total += bytes;
+            _ops++;
+            return true;
+        }
+
+
+        public:
+
+
+        /**
+         * @brief Constructor. The operations are recorded from the start.
+         * 
+         */
+        op_log()
+        {
+            _sink = nullptr;
+            _enabled = true;
+            _inner = false;
+            clear();
+        }
+
+
+        /**
+         * @brief Start or stop the recording.
+         * 
+         * @param enabled True to record the operations.
+         */
+        void set_enabled(bool enabled)
+        {
+            _enabled = enabled;
+        }
+
+
+        /**
+         * @brief Set a function receiving the buffer each time it is full, e.g. to copy it to SRAM
+         * or to send it to the host. (`nullptr` = none)
+         * 
+         * @param sink The function.
+         */
+        void set_sink(dump_fn sink)
+        {
+            _sink = sink;
+        }
+
+
+        /**
+         * @brief Pass the content of the buffer to the sink (if any), and empty it.
+         * The header is only at the start of the first block.
+         * 
+         */
+        void flush()
+        {
+            if (_sink != nullptr && _size > 0)
+                _sink(_buffer, _size);
+            _size = 0;
+        }
+
+
+        /**
+         * @brief Discard everything, and start a new stream.
+         * 
+         */
+        void clear()
+        {
+            _size = 0;
+            _ops = 0;
+            _dropped = 0;
+            _put(op_log_header::MAGIC, 4);
+            _put(op_log_header::VERSION, 4);
+            _total = _size;
+        }
+
+
+        /**
+         * @brief Mark the operations that follow as made during `update()`, or not.
+         * 
+         * @param inner True during `update()`.
+         */
+        void set_inner(bool inner)
+        {
+            _inner = inner;
+        }
+
+
+        /**
+         * @brief Record an operation on an entity (`CREATE`, `DESTROY`, `DISABLE`, `ENABLE`, `SUBSCRIBE`, `UNSUBSCRIBE`).
+         * 
+         * @param kind The operation.
+         * @param e The ID of the entity.
+         */
+        void entity_op(op_kind kind, entity e)
+        {
+            if (_begin(kind, 3))
+                _put(e, 2);
+        }
+
+
+        /**
+         * @brief Record an operation on an updater (`ACTIVATE`, `DEACTIVATE`).
+         * 
+         * @param kind The operation.
+         * @param tag The tag of the updater.
+         */
+        void updater_op(op_kind kind, tag_t tag)
+        {
+            if (_begin(kind, 3))
+                _put(tag, 2);
+        }
+
+
+        /**
+         * @brief Record the subscription of an entity to a single updater, cached query or cached apply object, or its unsubscription
+         * (`SUBSCRIBE_UPDATER`, `UNSUBSCRIBE_UPDATER`, `SUBSCRIBE_QUERY`, `UNSUBSCRIBE_QUERY`, `SUBSCRIBE_APPLY`, `UNSUBSCRIBE_APPLY`).
+         * 
+         * @param kind The operation.
+         * @param e The ID of the entity.
+         * @param tag The tag of the updater, cached query or cached apply object.
+         */
+        void subscription_op(op_kind kind, entity e, tag_t tag)
+        {
+            if (!_begin(kind, 5))
+                return;
+            _put(e, 2);
+            _put(tag, 2);
+        }
+
+
+        /**
+         * @brief Record an operation without arguments (`ACTIVATE_ALL`, `DEACTIVATE_ALL`, `FRAME`).
+         * 
+         * @param kind The operation.
+         */
+        void op(op_kind kind)
+        {
+            (void) _begin(kind, 1);
+        }
+
+
+        /**
+         * @brief Record a component added to an entity, with its bytes.
+         * 
+         * @param e The ID of the entity.
+         * @param tag The tag of the component.
+         * @param data The component.
+         * @param bytes The size of the component.
+         */
+        void add(entity e, tag_t tag, const void * data, uint32_t bytes)
+        {
+            assert(bytes <= 0xffff && "ESA ERROR: component too large for the operation log!");
+            if (!_begin(op_kind::ADD, 7 + bytes))
+                return;
+            _put(e, 2);
+            _put(tag, 2);
+            _put(bytes, 2);
+            const unsigned char * p = static_cast<const unsigned char *>(data);
+            for (uint32_t i = 0; i < bytes; i++)
+                _buffer[_size++] = p[i];
+        }
+
+
+        /**
+         * @brief Record a call to `destroy_after`.
+         * 
+         * @param e The ID of the entity.
+         * @param frames The number of frames.
+         */
+        void destroy_after(entity e, uint32_t frames)
+        {
+            if (!_begin(op_kind::DESTROY_AFTER, 7))
+                return;
+            _put(e, 2);
+            _put(frames, 4);
+        }
+
+
+        /**
+         * @brief Record a call to `update()`.
+         * 
+         */
+        void frame()
+        {
+            op(op_kind::FRAME);
+        }
+
+
+        /**
+         * @brief Record a call to `update(elapsed)`.
+         * 
+         * @param elapsed The elapsed time.
+         */
+        void frame(uint32_t elapsed)
+        {
+            if (_begin(op_kind::FRAME_ELAPSED, 5))
+                _put(elapsed, 4);
+        }
+
+
+        /**
+         * @brief Returns the buffer.
+         * 
+         * @return const void*
+         */
+        [[nodiscard]] const void * data()
+        {
+            return _buffer;
+        }
+
+
+        /**
+         * @brief Returns the number of bytes in the buffer.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t size()
+        {
+            return _size;
+        }
+
+
+        /**
+         * @brief Returns the total number of bytes of the stream (including the ones passed to the sink).
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t total()
+        {
+            return _total;
+        }
+
+
+        /**
+         * @brief Returns the number of operations recorded.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t ops()
+        {
+            return _ops;
+        }
+
+
+        /**
+         * @brief Returns the number of operations dropped (`0` if the stream is complete). Once an operation is dropped
+         * because the buffer is full, all the operations after it are dropped too, so that the stream stays a valid prefix.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t dropped()
+        {
+            return _dropped;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,217 @@
+#ifndef ESA_OP_REPLAY_H
+#define ESA_OP_REPLAY_H
+
+#include <vector>
+
+#include "esa.h"
+
+
+/**
+ * @brief Replay of the operation streams recorded with `ESA_OP_LOG`, e.g. to profile a session captured
+ * on a device or an emulator. Host builds only (uses the C++ standard library).
+ * 
+ */
+namespace esa
+{
+    /**
+     * @brief The result of a replay.
+     * 
+     */
+    struct replay_result
+    {
+        /**
+         * @brief False if the stream is not a valid operation stream, or is truncated.
+         * 
+         */
+        bool valid;
+
+
+        /**
+         * @brief The number of operations executed.
+         * 
+         */
+        uint32_t ops;
+
+
+        /**
+         * @brief The number of operations skipped. (made during `update()`, or activations when replaying the inner operations)
+         * 
+         */
+        uint32_t skipped;
+
+
+        /**
+         * @brief The number of frames executed.
+         * 
+         */
+        uint32_t frames;
+    };
+
+
+    /**
+     * @brief Execute an operation stream against a table, at full speed. The table must have the same columns
+     * (and, to replay the frames faithfully, the same updaters) as the one that recorded the stream.
+     * 
+     * The operations made during `update()` (by the updaters, or by timers) are marked in the stream. If the table
+     * has the same updaters, they make these operations again, and `inner` should be false. To replay only the
+     * structural churn, `inner` should be true, and the table should have no active updaters: the updaters
+     * are then never activated or deactivated.
+     * The entity IDs created by the replay are mapped to the recorded ones, so they do not need to match.
+     * 
+     * @tparam Table The type of the table.
+     * @param table The table.
+     * @param data The stream.
+     * @param bytes The size of the stream, in bytes.
+     * @param inner True to also execute the operations made during `update()`.
+     * @return replay_result
+     */
+    template<typename Table>
+    replay_result replay_ops(Table & table, const void * data, unsigned long bytes, bool inner = false)
+    {
+        const unsigned char * p = static_cast<const unsigned char *>(data);
+        const unsigned char * end = p + bytes;
+        replay_result result { false, 0, 0, 0 };
+
+        auto get = [&](uint32_t n) -> uint32_t
+        {
+            uint32_t value = 0;
+            for (uint32_t i = 0; i < n; i++)
+                value |= uint32_t(p[i]) << (8 * i);
+            p += n;
+            return value;
+        };
+
+        if (bytes < op_log_header::BYTES || get(4) != op_log_header::MAGIC || get(4) != op_log_header::VERSION)
+            return result;
+
+        std::vector<entity> ids(0x10000);
+        for (uint32_t i = 0; i < ids.size(); i++)
+            ids[i] = entity(i);
+
+        while (p < end)
+        {
+            unsigned char kind = *p;
+            op_kind op = op_kind(kind & ~op_log_header::INNER);
+            bool activation = op >= op_kind::ACTIVATE && op <= op_kind::DEACTIVATE_ALL;
+            bool skip = inner ? activation : (kind & op_log_header::INNER) != 0;
+            uint32_t size = op == op_kind::ADD ? 7 : op == op_kind::DESTROY_AFTER ? 7 : op >= op_kind::FRAME_ELAPSED ? 5
+                : op == op_kind::ACTIVATE_ALL || op == op_kind::DEACTIVATE_ALL || op == op_kind::FRAME ? 1 : 3;
+            if (op > op_kind::UNSUBSCRIBE_APPLY || end - p < long(size))
+                return result;
+            if (op == op_kind::ADD && end - p < long(size + (p[5] | (p[6] << 8))))
+                return result;
+            p++;
+            if (skip)
+            {
+                // an entity created by the updaters of the replay: assumed to get the recorded ID
+                if (op == op_kind::CREATE)
+                    ids[p[0] | (p[1] << 8)] = entity(p[0] | (p[1] << 8));
+                p += size - 1;
+                if (op == op_kind::ADD)
+                    p += p[-2] | (p[-1] << 8);
+                result.skipped++;
+                continue;
+            }
+            switch (op)
+            {
+                case op_kind::CREATE:
+                {
+                    entity recorded = entity(get(2));
+                    ids[recorded] = table.create();
+                    break;
+                }
+                case op_kind::DESTROY:
+                    table.destroy(ids[get(2)]);
+                    break;
+                case op_kind::DISABLE:
+                    table.disable(ids[get(2)]);
+                    break;
+                case op_kind::ENABLE:
+                    table.enable(ids[get(2)]);
+                    break;
+                case op_kind::ADD:
+                {
+                    entity e = ids[get(2)];
+                    tag_t tag = tag_t(get(2));
+                    uint32_t n = get(2);
+                    table.add_bytes(e, tag, p, n);
+                    p += n;
+                    break;
+                }
+                case op_kind::SUBSCRIBE:
+                    table.subscribe(ids[get(2)]);
+                    break;
+                case op_kind::UNSUBSCRIBE:
+                    table.unsubscribe(ids[get(2)]);
+                    break;
+                case op_kind::ACTIVATE:
+                    table.activate_updater(tag_t(get(2)));
+                    break;
+                case op_kind::DEACTIVATE:
+                    table.deactivate_updater(tag_t(get(2)));
+                    break;
+                case op_kind::ACTIVATE_ALL:
+                    table.activate_all_updaters();
+                    break;
+                case op_kind::DEACTIVATE_ALL:
+                    table.deactivate_all_updaters();
+                    break;
+                case op_kind::DESTROY_AFTER:
+                {
+                    entity e = ids[get(2)];
+                    table.destroy_after(e, get(4));
+                    break;
+                }
+                case op_kind::FRAME:
+                    table.update();
+                    result.frames++;
+                    break;
+                case op_kind::FRAME_ELAPSED:
+                    table.update(get(4));
+                    result.frames++;
+                    break;
+                case op_kind::SUBSCRIBE_UPDATER:
+                {
+                    entity e = ids[get(2)];
+                    table.subscribe_to_updater(e, tag_t(get(2)));
+                    break;
+                }
+                case op_kind::UNSUBSCRIBE_UPDATER:
+                {
+                    entity e = ids[get(2)];
+                    table.unsubscribe_from_updater(e, tag_t(get(2)));
+                    break;
+                }
+                case op_kind::SUBSCRIBE_QUERY:
+                {
+                    entity e = ids[get(2)];
+                    table.subscribe_to_query(e, tag_t(get(2)));
+                    break;
+                }
+                case op_kind::UNSUBSCRIBE_QUERY:
+                {
+                    entity e = ids[get(2)];
+                    table.unsubscribe_from_query(e, tag_t(get(2)));
+                    break;
+                }
+                case op_kind::SUBSCRIBE_APPLY:
+                {
+                    entity e = ids[get(2)];
+                    table.subscribe_to_apply(e, tag_t(get(2)));
+                    break;
+                }
+                case op_kind::UNSUBSCRIBE_APPLY:
+                {
+                    entity e = ids[get(2)];
+                    table.unsubscribe_from_apply(e, tag_t(get(2)));
+                    break;
+                }
+            }
+            result.ops++;
+        }
+        result.valid = true;
+        return result;
+    }
+}
+
+#endif
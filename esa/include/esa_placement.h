@@ -0,0 +1,321 @@
+#ifndef ESA_PLACEMENT_H
+#define ESA_PLACEMENT_H
+
+#include <cassert>
+
+#include "esa.h"
+
+
+namespace esa
+{
+    /**
+     * @brief The recommended placement of a column.
+     * 
+     */
+    struct column_placement
+    {
+        /**
+         * @brief The tag of the column.
+         * 
+         */
+        tag_t column;
+
+
+        /**
+         * @brief True for an indexed series.
+         * 
+         */
+        bool indexed;
+
+
+        /**
+         * @brief The capacity of the column. (`Entities` for series, `Size` for indexed series)
+         * 
+         */
+        uint32_t capacity;
+
+
+        /**
+         * @brief The size of the column, in bytes.
+         * 
+         */
+        uint32_t bytes;
+
+
+        /**
+         * @brief The number of bytes accessed, as reported by the accessors.
+         * 
+         */
+        unsigned long long accessed_bytes;
+
+
+        /**
+         * @brief Where the column was during the recording.
+         * 
+         */
+        ram current;
+
+
+        /**
+         * @brief Where the column should go.
+         * 
+         */
+        ram recommended;
+
+
+        /**
+         * @brief Returns the number of bytes accessed per byte of the column, times 1000.
+         * 
+         * @return unsigned long long
+         */
+        [[nodiscard]] unsigned long long hotness() const
+        {
+            return bytes == 0 ? 0 : accessed_bytes * 1000 / bytes;
+        }
+    };
+
+
+    /**
+     * @brief A placement plan: the columns of a table, from the hottest per byte to the coldest.
+     * 
+     * @tparam Components The maximum number of components of the table.
+     */
+    template<uint32_t Components>
+    struct placement_plan
+    {
+        /**
+         * @brief The columns, from the hottest per byte to the coldest.
+         * 
+         */
+        column_placement columns [ Components == 0 ? 1 : Components ];
+
+
+        /**
+         * @brief The number of columns.
+         * 
+         */
+        uint32_t size;
+
+
+        /**
+         * @brief The IWRAM budget.
+         * 
+         */
+        uint32_t budget;
+
+
+        /**
+         * @brief The bytes of IWRAM taken up by the columns recommended for IWRAM.
+         * 
+         */
+        uint32_t iwram_bytes;
+
+
+        /**
+         * @brief The number of frames recorded.
+         * 
+         */
+        uint32_t frames;
+    };
+
+
+    /**
+     * @brief Records how many bytes of each column of a table are accessed (`get`, `has`, the `[]` operators of the series, ...)
+     * when `ESA_INSTRUMENT` is defined, and recommends which columns to place in IWRAM with a certain budget:
+     * the columns with the most bytes accessed per byte go first. Accesses are weighted by their bytes, so an accessor
+     * reporting its mask and its component separately counts the same as one reporting them together.
+     * 
+     * @tparam Components The maximum number of components of the table.
+     */
+    template<uint32_t Components>
+    class placement_advisor : public iaccess_observer
+    {
+        /**
+         * @brief The number of bytes accessed in each column.
+         * 
+         */
+        unsigned long long _accessed_bytes [ Components ];
+
+
+        /**
+         * @brief Where each column is.
+         * 
+         */
+        ram _where [ Components ];
+
+
+        /**
+         * @brief The size of each column, in bytes. (0 = not measured)
+         * 
+         */
+        uint32_t _bytes [ Components ];
+
+
+        /**
+         * @brief The capacity of each column.
+         * 
+         */
+        uint32_t _capacity [ Components ];
+
+
+        /**
+         * @brief True for the indexed columns.
+         * 
+         */
+        bool _indexed [ Components ];
+
+
+        /**
+         * @brief The number of frames recorded.
+         * 
+         */
+        uint32_t _frames;
+
+
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         */
+        placement_advisor()
+        {
+            for (uint32_t i = 0; i < Components; i++)
+            {
+                _bytes[i] = 0;
+                _capacity[i] = 0;
+                _indexed[i] = false;
+                _where[i] = ram::EWRAM;
+            }
+            reset();
+        }
+
+
+        /**
+         * @brief Count the bytes of an access. Subscriber lists and accesses reported by user code with unknown tags are ignored.
+         * 
+         */
+        void access(tag_t updater, tag_t column, ram where, access_kind kind, uint32_t bytes) override
+        {
+            (void) updater;
+            (void) kind;
+            if (column >= Components)
+                return;
+            _accessed_bytes[column] += bytes;
+            _where[column] = where;
+        }
+
+
+        /**
+         * @brief Count a frame.
+         * 
+         */
+        void end_frame() override
+        {
+            _frames++;
+        }
+
+
+        /**
+         * @brief Discard the accesses recorded so far. (the sizes of the columns are kept)
+         * 
+         */
+        void reset()
+        {
+            for (uint32_t i = 0; i < Components; i++)
+                _accessed_bytes[i] = 0;
+            _frames = 0;
+        }
+
+
+        /**
+         * @brief Read the size of the columns of a table. Must be called once the columns are added.
+         * 
+         * @param table The table.
+         */
+        template<uint32_t Entities, uint32_t Updaters, uint32_t Queries, uint32_t Applys>
+        void measure(entity_table<Entities, Components, Updaters, Queries, Applys> & table)
+        {
+            for (tag_t tag = 0; tag < Components; tag++)
+            {
+                iseries * s = table.column(tag);
+                if (s == nullptr)
+                    continue;
+                _bytes[tag] = s->bytes();
+                _capacity[tag] = s->capacity();
+                _indexed[tag] = s->indexed();
+#ifdef ESA_INSTRUMENT
+                _where[tag] = s->location();
+#endif
+            }
+        }
+
+
+        /**
+         * @brief Returns the number of bytes accessed in a column.
+         * 
+         * @param column The tag of the column.
+         * @return unsigned long long
+         */
+        [[nodiscard]] unsigned long long accessed_bytes(tag_t column)
+        {
+            assert(column < Components && "ESA ERROR: component tag out of range!");
+            return _accessed_bytes[column];
+        }
+
+
+        /**
+         * @brief Returns the number of frames recorded.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t frames()
+        {
+            return _frames;
+        }
+
+
+        /**
+         * @brief Returns a placement plan for a certain IWRAM budget. The columns are sorted by bytes accessed per byte,
+         * and each one is placed in IWRAM if it still fits in the budget (columns never accessed stay in EWRAM).
+         * 
+         * @param budget The bytes of IWRAM available for the columns.
+         * @return placement_plan<Components>
+         */
+        [[nodiscard]] placement_plan<Components> plan(uint32_t budget)
+        {
+            placement_plan<Components> p;
+            p.size = 0;
+            p.budget = budget;
+            p.iwram_bytes = 0;
+            p.frames = _frames;
+            for (tag_t tag = 0; tag < Components; tag++)
+            {
+                if (_bytes[tag] == 0)
+                    continue;
+                column_placement c { tag, _indexed[tag], _capacity[tag], _bytes[tag], _accessed_bytes[tag], _where[tag], ram::EWRAM };
+                // insertion sort, by bytes accessed per byte (cross-multiplied to avoid rounding)
+                uint32_t j = p.size;
+                while (j > 0 && p.columns[j - 1].accessed_bytes * c.bytes < c.accessed_bytes * p.columns[j - 1].bytes)
+                {
+                    p.columns[j] = p.columns[j - 1];
+                    j--;
+                }
+                p.columns[j] = c;
+                p.size++;
+            }
+            for (uint32_t i = 0; i < p.size; i++)
+            {
+                column_placement & c = p.columns[i];
+                if (c.accessed_bytes == 0 || p.iwram_bytes + c.bytes > budget)
+                    continue;
+                c.recommended = ram::IWRAM;
+                p.iwram_bytes += c.bytes;
+            }
+            return p;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef ESA_PLACEMENT_HEADER_H
+#define ESA_PLACEMENT_HEADER_H
+
+#include <cstdio>
+
+#include "esa.h"
+
+
+/**
+ * @brief Export of placement plans as a C++ header declaring the IWRAM series.
+ * Host builds only (uses the C standard library).
+ * 
+ */
+namespace esa
+{
+    /**
+     * @brief The names of a column in the source code: the name of its tag and the name of its component type.
+     * 
+     */
+    struct column_names
+    {
+        const char * tag;
+        const char * type;
+    };
+
+
+    /**
+     * @brief A function returning the names of a column. A `nullptr` name is replaced by a default one
+     * (e.g. "3" for the tag and "component_3" for the type).
+     * 
+     */
+    using column_names_fn = column_names (*)(tag_t column);
+
+
+    /**
+     * @brief Write a placement plan as a header: a comment with the bytes accessed per byte of each column and
+     * the recommended placement, the declarations of the series to place in IWRAM, and a function adding
+     * them to a table (to call instead of the `add_component` of those columns).
+     * 
+     * @tparam Components The maximum number of components of the table.
+     * @param out The output file.
+     * @param plan The plan, as returned by `placement_advisor::plan()`.
+     * @param names The names of the columns. (`nullptr` = default names)
+     */
+    template<uint32_t Components>
+    void write_placement_header(std::FILE * out, const placement_plan<Components> & plan, column_names_fn names = nullptr)
+    {
+        char tag_buffer [ 16 ];
+        char type_buffer [ 32 ];
+        auto name = [&](tag_t column) -> column_names
+        {
+            column_names n = names != nullptr ? names(column) : column_names { nullptr, nullptr };
+            if (n.tag == nullptr)
+            {
+                std::snprintf(tag_buffer, sizeof(tag_buffer), "%u", unsigned(column));
+                n.tag = tag_buffer;
+            }
+            if (n.type == nullptr)
+            {
+                std::snprintf(type_buffer, sizeof(type_buffer), "component_%u", unsigned(column));
+                n.type = type_buffer;
+            }
+            return n;
+        };
+        auto memory = [](ram where) -> const char *
+        {
+            return where == ram::IWRAM ? "IWRAM" : where == ram::EWRAM ? "EWRAM" : "ROM";
+        };
+
+        std::fprintf(out, "// ESA placement plan: %u / %u bytes of IWRAM, %u frames recorded\n",
+            unsigned(plan.iwram_bytes), unsigned(plan.budget), unsigned(plan.frames));
+        std::fprintf(out, "//\n// %-24s %10s %14s %12s %8s %8s\n", "column", "bytes", "accessed", "per byte", "now", "plan");
+        for (uint32_t i = 0; i < plan.size; i++)
+        {
+            const column_placement & c = plan.columns[i];
+            unsigned long long h = c.hotness();
+            std::fprintf(out, "// %-24s %10u %14llu %8llu.%03llu %8s %8s\n", name(c.column).tag, unsigned(c.bytes),
+                c.accessed_bytes, h / 1000, h % 1000, memory(c.current), memory(c.recommended));
+        }
+        for (uint32_t i = 0; i < plan.size; i++)
+        {
+            const column_placement & c = plan.columns[i];
+            if (c.current == ram::IWRAM && c.recommended != ram::IWRAM)
+                std::fprintf(out, "// move to EWRAM: table.add_component<%s>(%s)\n", name(c.column).type, name(c.column).tag);
+        }
+
+        std::fprintf(out, "\n#ifndef ESA_PLACEMENT_PLAN_H\n#define ESA_PLACEMENT_PLAN_H\n\n");
+        for (uint32_t i = 0; i < plan.size; i++)
+        {
+            const column_placement & c = plan.columns[i];
+            if (c.recommended != ram::IWRAM)
+                continue;
+            std::fprintf(out, "inline esa::%s<%s, %u> iwram_column_%u;\n", c.indexed ? "indexed_series" : "series",
+                name(c.column).type, unsigned(c.capacity), unsigned(c.column));
+        }
+        std::fprintf(out, "\ntemplate<typename Table>\nvoid add_iwram_columns(Table & table)\n{\n");
+        for (uint32_t i = 0; i < plan.size; i++)
+        {
+            const column_placement & c = plan.columns[i];
+            if (c.recommended != ram::IWRAM)
+                continue;
+            std::fprintf(out, "    table.%s(&iwram_column_%u, %s);\n", c.indexed ? "add_indexed_series" : "add_series",
+                unsigned(c.column), name(c.column).tag);
+        }
+        std::fprintf(out, "}\n\n#endif\n");
+    }
+}
+
+#endif
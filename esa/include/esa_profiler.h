@@ -0,0 +1,549 @@
+#ifndef ESA_PROFILER_H
+#define ESA_PROFILER_H
+
+#include <cassert>
+
+#include "esa.h"
+
+
+/**
+ * @brief The number of frames kept by the profiler of each table (only used with `ESA_PROFILER`).
+ * 
+ */
+#ifndef ESA_PROFILER_FRAMES
+    #define ESA_PROFILER_FRAMES 64
+#endif
+
+
+namespace esa
+{
+    template<uint32_t Frames>
+    class profile_samples
+    {
+        /**
+         * @brief Ring buffer of the last `Frames` samples.
+         * 
+         */
+        uint32_t _samples [ Frames ];
+
+
+        /**
+         * @brief Position of the next sample in the ring buffer.
+         * 
+         */
+        uint32_t _next;
+
+
+        /**
+         * @brief The number of samples in the ring buffer.
+         * 
+         */
+        uint32_t _size;
+
+
+        /**
+         * @brief Time accumulated during the current frame.
+         * 
+         */
+        uint32_t _pending;
+
+
+        /**
+         * @brief The number of calls during the current frame.
+         * 
+         */
+        uint32_t _pending_calls;
+
+
+        /**
+         * @brief The number of calls during the last recorded frame.
+         * 
+         */
+        uint32_t _calls;
+
+
+        /**
+         * @brief The total number of calls.
+         * 
+         */
+        uint32_t _total_calls;
+
+
+        /**
+         * @brief The total time of all the recorded frames.
+         * 
+         */
+        unsigned long long _total;
+
+
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         */
+        profile_samples()
+        {
+            reset();
+        }
+
+
+        /**
+         * @brief Add the duration of a call to the current frame.
+         * 
+         * @param ticks The duration of the call, in clock ticks.
+         */
+        void add(uint32_t ticks)
+        {
+            _pending += ticks;
+            _pending_calls++;
+        }
+
+
+        /**
+         * @brief Close the current frame and store its time as a sample.
+         * If `always` is false, frames without calls are not stored.
+         * 
+         * @param always Store the sample even if there were no calls.
+         */
+        void commit(bool always)
+        {
+            if (_pending_calls == 0 && !always)
+                return;
+            _samples[_next] = _pending;
+            _next = _next + 1 == Frames ? 0 : _next + 1;
+            if (_size < Frames)
+                _size++;
+            _calls = _pending_calls;
+            _total_calls += _pending_calls;
+            _total += _pending;
+            _pending = 0;
+            _pending_calls = 0;
+        }
+
+
+        /**
+         * @brief Discard all the samples.
+         * 
+         */
+        void reset()
+        {
+            _next = 0;
+            _size = 0;
+            _pending = 0;
+            _pending_calls = 0;
+            _calls = 0;
+            _total_calls = 0;
+            _total = 0;
+        }
+
+
+        /**
+         * @brief Returns the number of samples available. (at most `Frames`)
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t size()
+        {
+            return _size;
+        }
+
+
+        /**
+         * @brief Returns the most recent sample.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t last()
+        {
+            if (_size == 0)
+                return 0;
+            return _samples[_next == 0 ? Frames - 1 : _next - 1];
+        }
+
+
+        /**
+         * @brief Returns the smallest sample.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t min()
+        {
+            uint32_t m = _size == 0 ? 0 : _samples[0];
+            for (uint32_t i = 1; i < _size; i++)
+                m = _samples[i] < m ? _samples[i] : m;
+            return m;
+        }
+
+
+        /**
+         * @brief Returns the average of the samples.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t avg()
+        {
+            if (_size == 0)
+                return 0;
+            unsigned long long total = 0;
+            for (uint32_t i = 0; i < _size; i++)
+                total += _samples[i];
+            return uint32_t(total / _size);
+        }
+
+
+        /**
+         * @brief Returns the largest sample.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t max()
+        {
+            uint32_t m = 0;
+            for (uint32_t i = 0; i < _size; i++)
+                m = _samples[i] > m ? _samples[i] : m;
+            return m;
+        }
+
+
+        /**
+         * @brief Returns the 99th percentile of the samples (nearest rank).
+         * With less than 100 samples, this is the largest sample.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t p99()
+        {
+            if (_size == 0)
+                return 0;
+            uint32_t sorted [ Frames ];
+            for (uint32_t i = 0; i < _size; i++)
+            {
+                uint32_t j = i;
+                while (j > 0 && sorted[j - 1] > _samples[i])
+                {
+                    sorted[j] = sorted[j - 1];
+                    j--;
+                }
+                sorted[j] = _samples[i];
+            }
+            return sorted[(_size * 99 + 99) / 100 - 1];
+        }
+
+
+        /**
+         * @brief Returns the number of calls during the last recorded frame.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t calls()
+        {
+            return _calls;
+        }
+
+
+        /**
+         * @brief Returns the total time of all the recorded frames (not only the last `Frames`).
+         * 
+         * @return unsigned long long 
+         */
+        [[nodiscard]] unsigned long long total()
+        {
+            return _total;
+        }
+
+
+        /**
+         * @brief Returns the total number of calls.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t total_calls()
+        {
+            return _total_calls;
+        }
+    };
+
+
+    template<uint32_t Updaters, uint32_t Frames>
+    class profiler
+    {
+        /**
+         * @brief The clock used to time the updaters.
+         * 
+         */
+        clock_fn _clock;
+
+
+        /**
+         * @brief The number of frames recorded.
+         * 
+         */
+        uint32_t _frames;
+
+
+        /**
+         * @brief The tag of the updater profiled in each slot. (same order as the table's updaters)
+         * 
+         */
+        tag_t _tags [ Updaters == 0 ? 1 : Updaters ];
+
+
+        /**
+         * @brief The number of entities subscribed to each updater, at the end of the last frame.
+         * 
+         */
+        uint32_t _subscribed [ Updaters == 0 ? 1 : Updaters ];
+
+
+        /**
+         * @brief Time spent by each updater.
+         * 
+         */
+        profile_samples<Frames> _updaters [ Updaters == 0 ? 1 : Updaters ];
+
+
+        /**
+         * @brief Time spent destroying the entities at the end of the frame.
+         * 
+         */
+        profile_samples<Frames> _destruction;
+
+
+        /**
+         * @brief Time spent subscribing and unsubscribing entities.
+         * 
+         */
+        profile_samples<Frames> _subscription;
+
+
+        /**
+         * @brief The number of slots in use.
+         * 
+         */
+        uint32_t _slots;
+
+
+        /**
+         * @brief Find the slot of an updater.
+         * 
+         * @param tag The tag of the updater.
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t _find(tag_t tag)
+        {
+            for (uint32_t i = 0; i < _slots; i++)
+            {
+                if (_tags[i] == tag)
+                    return i;
+            }
+            assert(1 == 2 && "ESA ERROR: the updater was not profiled yet!");
+            return 0;
+        }
+
+
+        public:
+
+
+        /**
+         * @brief Constructor. No time is recorded until a clock is set.
+         * 
+         */
+        profiler()
+        {
+            _clock = nullptr;
+            _frames = 0;
+            _slots = 0;
+        }
+
+
+        /**
+         * @brief Set the clock used to time the updaters, and discard the samples taken so far.
+         * 
+         * @param clock A function returning the current time. (GBA timer ticks, nanoseconds, ...)
+         */
+        void set_clock(clock_fn clock)
+        {
+            _clock = clock;
+            reset();
+        }
+
+
+        /**
+         * @brief Returns the current time, or `0` if no clock is set.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t now()
+        {
+            return _clock != nullptr ? _clock() : 0;
+        }
+
+
+        /**
+         * @brief Record a call to an updater.
+         * 
+         * @param slot The position of the updater in the table.
+         * @param tag The tag of the updater.
+         * @param ticks The duration of the call.
+         */
+        void updater_call(uint32_t slot, tag_t tag, uint32_t ticks)
+        {
+            assert(slot < Updaters && "ESA ERROR: updater slot out of range!");
+            _tags[slot] = tag;
+            _updaters[slot].add(ticks);
+        }
+
+
+        /**
+         * @brief Record the destruction of the entities marked for destruction.
+         * 
+         * @param ticks The duration of the destruction.
+         */
+        void destruction_call(uint32_t ticks)
+        {
+            _destruction.add(ticks);
+        }
+
+
+        /**
+         * @brief Record a subscription or unsubscription.
+         * 
+         * @param ticks The duration of the call.
+         */
+        void subscription_call(uint32_t ticks)
+        {
+            _subscription.add(ticks);
+        }
+
+
+        /**
+         * @brief Store the subscribed count of an updater at the end of the frame.
+         * 
+         * @param slot The position of the updater in the table.
+         * @param tag The tag of the updater.
+         * @param subscribed The number of entities subscribed to the updater.
+         */
+        void updater_count(uint32_t slot, tag_t tag, uint32_t subscribed)
+        {
+            assert(slot < Updaters && "ESA ERROR: updater slot out of range!");
+            _tags[slot] = tag;
+            _subscribed[slot] = subscribed;
+            if (slot >= _slots)
+                _slots = slot + 1;
+        }
+
+
+        /**
+         * @brief Close the current frame. Updaters store a sample only for the frames in which they ran,
+         * destruction and subscription store a sample for every frame.
+         * 
+         */
+        void end_frame()
+        {
+            for (uint32_t i = 0; i < _slots; i++)
+                _updaters[i].commit(false);
+            _destruction.commit(true);
+            _subscription.commit(true);
+            _frames++;
+        }
+
+
+        /**
+         * @brief Discard all the samples.
+         * 
+         */
+        void reset()
+        {
+            for (uint32_t i = 0; i < Updaters; i++)
+                _updaters[i].reset();
+            _destruction.reset();
+            _subscription.reset();
+            _frames = 0;
+        }
+
+
+        /**
+         * @brief Returns the number of frames recorded.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t frames()
+        {
+            return _frames;
+        }
+
+
+        /**
+         * @brief Returns the time samples of an updater.
+         * 
+         * @param tag The tag of the updater.
+         * @return profile_samples<Frames>&
+         */
+        [[nodiscard]] profile_samples<Frames> & updater(tag_t tag)
+        {
+            return _updaters[_find(tag)];
+        }
+
+
+        /**
+         * @brief Returns the number of entities subscribed to an updater, at the end of the last frame.
+         * 
+         * @param tag The tag of the updater.
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t subscribed(tag_t tag)
+        {
+            return _subscribed[_find(tag)];
+        }
+
+
+        /**
+         * @brief Returns the time samples of the end-of-frame destruction.
+         * 
+         * @return profile_samples<Frames>&
+         */
+        [[nodiscard]] profile_samples<Frames> & destruction()
+        {
+            return _destruction;
+        }
+
+
+        /**
+         * @brief Returns the time samples of subscriptions and unsubscriptions.
+         * 
+         * @return profile_samples<Frames>&
+         */
+        [[nodiscard]] profile_samples<Frames> & subscription()
+        {
+            return _subscription;
+        }
+
+
+        /**
+         * @brief Returns the number of updaters profiled.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t size()
+        {
+            return _slots;
+        }
+
+
+        /**
+         * @brief Returns the tag of the updater profiled in a slot. (same order as the table's updaters)
+         * 
+         * @param slot The slot.
+         * @return tag_t
+         */
+        [[nodiscard]] tag_t tag(uint32_t slot)
+        {
+            assert(slot < _slots && "ESA ERROR: profiler slot out of range!");
+            return _tags[slot];
+        }
+    };
+}
+
+#endif
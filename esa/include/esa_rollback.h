@@ -0,0 +1,641 @@
+#ifndef ESA_ROLLBACK_H
+#define ESA_ROLLBACK_H
+
+#include <cassert>
+
+#include "esa.h"
+
+
+/**
+ * @brief The size of the rollback buffer of each table, in bytes (only used with `ESA_ROLLBACK`).
+ * 
+ */
+#ifndef ESA_ROLLBACK_BYTES
+    #define ESA_ROLLBACK_BYTES 16384
+#endif
+
+
+/**
+ * @brief The maximum number of frames kept by the rollback buffer of each table (only used with `ESA_ROLLBACK`).
+ * 
+ */
+#ifndef ESA_ROLLBACK_FRAMES
+    #define ESA_ROLLBACK_FRAMES 8
+#endif
+
+
+namespace esa
+{
+    /**
+     * @brief The kinds of records of a rollback log. Each record holds the state of something
+     * before it was first changed in a frame.
+     * 
+     */
+    enum class rollback_kind : unsigned char
+    {
+        FRAME,
+        SLOT,
+        COLUMN,
+        ROW,
+        POOLED,
+        ACTIVE,
+        UPDATER,
+        QUERY,
+        APPLY,
+        TIMER,
+        TIMER_FIRST,
+        TIMER_HEAD,
+        TIMER_STATE,
+        SLICE
+    };
+
+
+    /**
+     * @brief The counters of the table at the beginning of a frame (`rollback_kind::FRAME`).
+     * 
+     */
+    struct rollback_frame
+    {
+        uint32_t size;
+        uint32_t used;
+        uint32_t disabled;
+        uint32_t frame;
+        uint32_t step;
+        uint32_t accumulator;
+        uint32_t pooled;
+    };
+
+
+    /**
+     * @brief A component of an entity in a series, followed by its bytes (`rollback_kind::SLOT`).
+     * 
+     */
+    struct rollback_slot
+    {
+        tag_t column;
+        entity e;
+        bool owned;
+    };
+
+
+    /**
+     * @brief The state of an entity in the table (`rollback_kind::ROW`).
+     * 
+     */
+    struct rollback_row
+    {
+        entity e;
+        bool contained;
+        bool destroyed;
+        bool disabled;
+    };
+
+
+    /**
+     * @brief Tells if an updater was active (`rollback_kind::ACTIVE`).
+     * 
+     */
+    struct rollback_active
+    {
+        tag_t updater;
+        bool active;
+    };
+
+
+    /**
+     * @brief The position of a sliced updater in its sweep (`rollback_kind::SLICE`).
+     * 
+     */
+    struct rollback_slice
+    {
+        tag_t updater;
+        uint32_t cursor;
+        uint32_t sweeps;
+    };
+
+
+    /**
+     * @brief An entity ID overwritten in the pool of IDs (`rollback_kind::POOLED`).
+     * 
+     */
+    struct rollback_pooled
+    {
+        uint32_t position;
+        entity e;
+    };
+
+
+    /**
+     * @brief A timer of a timer wheel (`rollback_kind::TIMER`).
+     * 
+     */
+    struct rollback_timer
+    {
+        unsigned short timer;
+        unsigned short next;
+        unsigned short prev;
+        unsigned short sibling;
+        unsigned short slot;
+        entity e;
+        tag_t target;
+        uint32_t expiry;
+    };
+
+
+    /**
+     * @brief The first timer of an entity (`rollback_kind::TIMER_FIRST`) or of a slot (`rollback_kind::TIMER_HEAD`) of a timer wheel.
+     * 
+     */
+    struct rollback_link
+    {
+        unsigned short position;
+        unsigned short timer;
+    };
+
+
+    /**
+     * @brief The counters of a timer wheel (`rollback_kind::TIMER_STATE`).
+     * 
+     */
+    struct rollback_wheel
+    {
+        uint32_t now;
+        uint32_t size;
+        unsigned short free;
+        uint32_t hash;
+    };
+
+
+    /**
+     * @brief A log of the changes made to a table in the last frames, kept in a ring buffer, to rewind the table.
+     * For each frame, it holds the state of what was changed, saved before the first change: the counters of the table,
+     * the entity slots of the series that were written, the indexed series, subscriber lists and timers that were changed,
+     * and the entities created, destroyed, disabled or enabled. The oldest frames are dropped to make room for new ones.
+     * The memory is provided by `rollback_buffer`.
+     * 
+     * Each record is made of its kind (1 byte), its bytes, and their number (4 bytes), so that the records
+     * of a frame can be read backwards.
+     * 
+     */
+    class rollback_log
+    {
+        /**
+         * @brief The buffer.
+         * 
+         */
+        unsigned char * _data;
+
+
+        /**
+         * @brief The size of the buffer.
+         * 
+         */
+        uint32_t _bytes;
+
+
+        /**
+         * @brief The position of the first record of each frame. (ring)
+         * 
+         */
+        uint32_t * _starts;
+
+
+        /**
+         * @brief The maximum number of frames.
+         * 
+         */
+        uint32_t _capacity;
+
+
+        /**
+         * @brief The slot of the oldest frame in `_starts`.
+         * 
+         */
+        uint32_t _first;
+
+
+        /**
+         * @brief The number of frames in the log (including the current one).
+         * 
+         */
+        uint32_t _count;
+
+
+        /**
+         * @brief Where the next record is written.
+         * 
+         */
+        uint32_t _head;
+
+
+        /**
+         * @brief Where the oldest frame starts.
+         * 
+         */
+        uint32_t _tail;
+
+
+        /**
+         * @brief Where the records stop before continuing from the start of the buffer. (only if `_wrapped`)
+         * 
+         */
+        uint32_t _wrap;
+
+
+        /**
+         * @brief True if the newest records are at the start of the buffer, before `_tail`.
+         * 
+         */
+        bool _wrapped;
+
+
+        /**
+         * @brief True while the table is rewinding. (nothing is recorded)
+         * 
+         */
+        bool _rewinding;
+
+
+        /**
+         * @brief Changes each time a frame begins or the table is rewound: the state of something
+         * is saved only once per epoch.
+         * 
+         */
+        uint32_t _epoch;
+
+
+        /**
+         * @brief The number of frames that did not fit in the buffer.
+         * 
+         */
+        uint32_t _overflows;
+
+
+        /**
+         * @brief Forget all the frames.
+         * 
+         */
+        void _reset()
+        {
+            _first = 0;
+            _count = 0;
+            _head = 0;
+            _tail = 0;
+            _wrap = 0;
+            _wrapped = false;
+        }
+
+
+        /**
+         * @brief Drop the oldest frame, unless it is the current one.
+         * 
+         * @return true The frame was dropped.
+         * @return false Only the current frame is left.
+         */
+        [[nodiscard]] bool _evict()
+        {
+            if (_count <= 1)
+                return false;
+            uint32_t previous = _tail;
+            _first = (_first + 1) % _capacity;
+            _count--;
+            _tail = _starts[_first];
+            if (_wrapped && (_tail >= _wrap || _tail < previous))
+            {
+                // no records are left before the wrap point
+                if (_tail >= _wrap)
+                {
+                    _tail = 0;
+                    _starts[_first] = 0;
+                }
+                _wrapped = false;
+            }
+            return true;
+        }
+
+
+        /**
+         * @brief Reserve room for a record, dropping the oldest frames if needed.
+         * If the current frame does not fit, all the frames are dropped.
+         * 
+         * @param bytes The size of the record.
+         * @return unsigned char* (`nullptr` if it does not fit)
+         */
+        [[nodiscard]] unsigned char * _reserve(uint32_t bytes)
+        {
+            while (bytes <= _bytes)
+            {
+                if (!_wrapped)
+                {
+                    if (_head + bytes <= _bytes)
+                    {
+                        unsigned char * p = _data + _head;
+                        _head += bytes;
+                        return p;
+                    }
+                    _wrap = _head;
+                    _head = 0;
+                    _wrapped = true;
+                }
+                else if (_head + bytes < _tail)
+                {
+                    unsigned char * p = _data + _head;
+                    _head += bytes;
+                    return p;
+                }
+                else if (!_evict())
+                    break;
+            }
+            _reset();
+            _overflows++;
+            return nullptr;
+        }
+
+
+        /**
+         * @brief Undo the newest frame, calling `f(kind, bytes, size)` for each of its records, newest first.
+         * 
+         */
+        template<typename Function>
+        void _undo(Function && f)
+        {
+            uint32_t start = _starts[(_first + _count - 1) % _capacity];
+            uint32_t p = _head;
+            while (p != start)
+            {
+                if (p == 0 && _wrapped)
+                {
+                    p = _wrap;
+                    _wrapped = false;
+                    continue;
+                }
+                uint32_t size;
+                __builtin_memcpy(&size, _data + p - 4, 4);
+                p -= size + 5;
+                f(rollback_kind(_data[p]), static_cast<const unsigned char *>(_data + p + 1), size);
+            }
+            _head = start;
+            _count--;
+            if (_count == 0)
+                _reset();
+        }
+
+
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         * @param data The buffer.
+         * @param bytes The size of the buffer.
+         * @param starts The array of the frame positions.
+         * @param frames The size of `starts`, that is the maximum number of frames.
+         */
+        rollback_log(unsigned char * data, uint32_t bytes, uint32_t * starts, uint32_t frames)
+        {
+            assert(frames > 0 && "ESA ERROR: a rollback log needs at least one frame!");
+            _data = data;
+            _bytes = bytes;
+            _starts = starts;
+            _capacity = frames;
+            _rewinding = false;
+            _epoch = 1;
+            _overflows = 0;
+            _reset();
+        }
+
+
+        /**
+         * @brief Start recording a new frame, dropping the oldest one if the log is full.
+         * 
+         */
+        void begin_frame()
+        {
+            if (_count == _capacity && !_evict())
+                _reset();
+            _starts[(_first + _count) % _capacity] = _head;
+            if (_count == 0)
+                _tail = _head;
+            _count++;
+            _epoch++;
+        }
+
+
+        /**
+         * @brief Tells if changes are being recorded (a frame has begun, and the table is not rewinding).
+         * 
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool recording()
+        {
+            return _count > 0 && !_rewinding;
+        }
+
+
+        /**
+         * @brief Tells if something must be saved in the current frame, and marks it as saved.
+         * 
+         * @param stamp The epoch in which it was last saved.
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool first(uint32_t & stamp)
+        {
+            if (!recording() || stamp == _epoch)
+                return false;
+            stamp = _epoch;
+            return true;
+        }
+
+
+        /**
+         * @brief Returns the current epoch.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t epoch()
+        {
+            return _epoch;
+        }
+
+
+        /**
+         * @brief Record some bytes, after a header.
+         * 
+         * @param kind The kind of record.
+         * @param header The header.
+         * @param header_bytes The size of the header.
+         * @param data The bytes. (`nullptr` = none)
+         * @param bytes The number of bytes.
+         */
+        void record(rollback_kind kind, const void * header, uint32_t header_bytes, const void * data, uint32_t bytes)
+        {
+            if (!recording())
+                return;
+            uint32_t size = header_bytes + bytes;
+            unsigned char * p = _reserve(size + 5);
+            if (p == nullptr)
+                return;
+            p[0] = (unsigned char) kind;
+            __builtin_memcpy(p + 1, header, header_bytes);
+            if (data != nullptr)
+                __builtin_memcpy(p + 1 + header_bytes, data, bytes);
+            __builtin_memcpy(p + 1 + size, &size, 4);
+        }
+
+
+        /**
+         * @brief Record a value of any trivially copyable type.
+         * 
+         * @param kind The kind of record.
+         * @param value The value.
+         */
+        template<typename Type>
+        void record(rollback_kind kind, const Type & value)
+        {
+            static_assert(__is_trivially_copyable(Type), "ESA ERROR: the type is not trivially copyable!");
+            record(kind, &value, sizeof(Type), nullptr, 0);
+        }
+
+
+        /**
+         * @brief Record the state of an object through its `save` function (an indexed series, an updater, a cached
+         * query, a cached apply object), once per frame.
+         * 
+         * @tparam Object The type of the object.
+         * @param kind The kind of record.
+         * @param tag The tag of the object.
+         * @param o The object.
+         * @param stamp The epoch in which the object was last saved.
+         */
+        template<typename Object>
+        void save(rollback_kind kind, tag_t tag, Object * o, uint32_t & stamp)
+        {
+            if (!first(stamp))
+                return;
+            snapshot_writer counter(nullptr, 0);
+            o->save(counter);
+            uint32_t size = sizeof(tag_t) + counter.size();
+            unsigned char * p = _reserve(size + 5);
+            if (p == nullptr)
+                return;
+            p[0] = (unsigned char) kind;
+            __builtin_memcpy(p + 1, &tag, sizeof(tag_t));
+            snapshot_writer w(p + 1 + sizeof(tag_t), counter.size());
+            o->save(w);
+            __builtin_memcpy(p + 1 + size, &size, 4);
+        }
+
+
+        /**
+         * @brief Undo the last frames, calling `f(kind, bytes, size)` for each record, newest first.
+         * 
+         * @tparam Function The type of the function.
+         * @param frames The number of frames. (at most `frames()`)
+         * @param f The function.
+         */
+        template<typename Function>
+        void rewind(uint32_t frames, Function && f)
+        {
+            assert(frames <= _count && "ESA ERROR: not enough frames to rewind!");
+            _rewinding = true;
+            for (uint32_t i = 0; i < frames; i++)
+                _undo(f);
+            _rewinding = false;
+            _epoch++;
+        }
+
+
+        /**
+         * @brief Forget all the frames.
+         * 
+         */
+        void clear()
+        {
+            _reset();
+            _epoch++;
+        }
+
+
+        /**
+         * @brief Returns the number of frames that can be rewound (including the current one).
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t frames()
+        {
+            return _count;
+        }
+
+
+        /**
+         * @brief Returns the number of bytes used by the frames.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t used()
+        {
+            if (_count == 0)
+                return 0;
+            return _wrapped ? _wrap - _tail + _head : _head - _tail;
+        }
+
+
+        /**
+         * @brief Returns the number of frames that did not fit in the buffer (all the frames are dropped when it happens).
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t overflows()
+        {
+            return _overflows;
+        }
+    };
+
+
+    /**
+     * @brief A rollback log with its own memory.
+     * 
+     * @tparam Bytes The size of the buffer.
+     * @tparam Frames The maximum number of frames.
+     */
+    template<uint32_t Bytes, uint32_t Frames>
+    class rollback_buffer : public rollback_log
+    {
+        /**
+         * @brief The buffer.
+         * 
+         */
+        unsigned char _buffer [ Bytes ];
+
+
+        /**
+         * @brief The positions of the frames.
+         * 
+         */
+        uint32_t _positions [ Frames == 0 ? 1 : Frames ];
+
+
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         */
+        rollback_buffer() : rollback_log(_buffer, Bytes, _positions, Frames)
+        {
+
+        }
+
+
+        rollback_buffer(const rollback_buffer &) = delete;
+
+
+        rollback_buffer & operator=(const rollback_buffer &) = delete;
+    };
+}
+
+#endif
@@ -13,6 +13,31 @@ namespace esa
     template<typename ComponentType, uint32_t Entities>
     class series : public iseries
     {
+#ifdef ESA_ROLLBACK
+        /**
+         * @brief The components saved in the rollback log in the current epoch. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        entity_mask<Entities> _touched;
+
+
+        /**
+         * @brief The rollback epoch of `_touched`. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        uint32_t _touched_epoch = 0;
+#endif
+
+
+#ifdef ESA_STATE_HASH
+        /**
+         * @brief The running hash of the components. (only with `ESA_STATE_HASH`)
+         * 
+         */
+        running_hash<Entities> _hash;
+#endif
+
+
         /**
          * @brief Entity mask.
          * 
@@ -27,9 +52,106 @@ namespace esa
         ComponentType _data [ Entities ];
 
 
+        /**
+         * @brief Returns the size of the entity mask and of the components, which are contiguous
+         * (without the padding at the end of the series, which depends on the platform).
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t _state_bytes()
+        {
+            return uint32_t(reinterpret_cast<unsigned char *>(_data + Entities) - reinterpret_cast<unsigned char *>(&_emask));
+        }
+
+
+        /**
+         * @brief Save the component of an entity in the rollback log of the table, before it is changed
+         * for the first time in a frame. Does nothing unless `ESA_ROLLBACK` is defined.
+         * 
+         * @param e The ID of the entity.
+         */
+        void _touch(entity e)
+        {
+            _notify_change();
+#ifdef ESA_ROLLBACK
+            if (_rollback == nullptr || !_rollback->recording())
+                return;
+            if (_touched_epoch != _rollback->epoch())
+            {
+                _touched = entity_mask<Entities>();
+                _touched_epoch = _rollback->epoch();
+            }
+            if (_touched.contains(e))
+                return;
+            assert(__is_trivially_copyable(ComponentType) && "ESA ERROR: rollback needs trivially copyable components!");
+            _touched.add(e);
+            rollback_slot s { _rollback_tag, e, _emask.contains(e) };
+            _rollback->record(rollback_kind::SLOT, &s, sizeof(s), _data + e, sizeof(ComponentType));
+#endif
+        }
+
+
+#ifdef ESA_STATE_HASH
+        /**
+         * @brief Returns the entry of an entity in the hash: its ID and the bytes of its component
+         * (only the ID for components that are not trivially copyable), or `0` if it does not own the component.
+         * (only with `ESA_STATE_HASH`)
+         * 
+         * @param e The ID of the entity.
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t _entry(entity e)
+        {
+            if (!_emask.contains(e))
+                return 0;
+            if constexpr (__is_trivially_copyable(ComponentType))
+                return hash_entry(e, _data + e, sizeof(ComponentType));
+            else
+                return hash_entry(e, nullptr, 0);
+        }
+#endif
+
+
+        /**
+         * @brief Remove the component of an entity from the hash, before it changes. It is added back
+         * by `hash()`. Does nothing unless `ESA_STATE_HASH` is defined.
+         * 
+         * @param e The ID of the entity.
+         */
+        void _unhash(entity e)
+        {
+#ifdef ESA_STATE_HASH
+            _hash.change(e, [this](entity x) { return _entry(x); });
+#endif
+        }
+
+
         public:
 
 
+        /**
+         * @brief Constructor.
+         * 
+         */
+        series() = default;
+
+
+        /**
+         * @brief Constructor keeping the entity mask and the components already in memory, e.g. in a file
+         * mapped by `esa::mapped_arena` (see `reattach_t`). Only for trivial components (trivially copyable,
+         * with no default member initializers).
+         * 
+         */
+        series(reattach_t r) : _emask(r)
+        {
+            assert(__is_trivially_copyable(ComponentType) && __is_trivially_constructible(ComponentType)
+                && "ESA ERROR: only columns of trivial components can be reattached!");
+#ifdef ESA_STATE_HASH
+            _hash.reset([this](entity x) { return _entry(x); });
+#endif
+        }
+
+
         /**
          * @brief Add a compoennt to the entity.
          * 
@@ -38,11 +160,143 @@ namespace esa
          */
         void add(entity e, const ComponentType & c)
         {
+            ESA_ACCESS(_column, _where, access_kind::WRITE, 4);
+            ESA_ACCESS(_column, _where, access_kind::WRITE, sizeof(ComponentType));
+            _touch(e);
+            _unhash(e);
             _emask.add(e);
             ::new(static_cast<void*>(_data + e)) ComponentType(c);
         }
 
 
+        /**
+         * @brief Add a component to an entity, copying its bytes. Only for trivially copyable components.
+         * 
+         * @param e The ID of the entity.
+         * @param data The bytes of the component.
+         * @param bytes The size of the component. (must be `sizeof(ComponentType)`)
+         */
+        void add_bytes(entity e, const void * data, uint32_t bytes) override
+        {
+            assert(bytes == sizeof(ComponentType) && "ESA ERROR: wrong component size!");
+            assert(__is_trivially_copyable(ComponentType) && "ESA ERROR: the component is not trivially copyable!");
+            if constexpr (__is_trivially_copyable(ComponentType))
+            {
+                ESA_ACCESS(_column, _where, access_kind::WRITE, 4);
+                ESA_ACCESS(_column, _where, access_kind::WRITE, sizeof(ComponentType));
+                _touch(e);
+                _unhash(e);
+                _emask.add(e);
+                __builtin_memcpy(static_cast<void*>(_data + e), data, sizeof(ComponentType));
+            }
+        }
+
+
+        /**
+         * @brief Write the content of the series to a snapshot. Trivially copyable components are written
+         * together with the entity mask, in one copy; other components are written by `snapshot_hooks`.
+         * 
+         * @param w The snapshot writer.
+         */
+        void save(snapshot_writer & w) override
+        {
+            if constexpr (__is_trivially_copyable(ComponentType))
+                w.write(&_emask, _state_bytes());
+            else
+            {
+                w.write_value(_emask);
+                for (entity e = 0; e < Entities; e++)
+                {
+                    if (_emask.contains(e))
+                        snapshot_hooks<ComponentType>::save(w, _data[e]);
+                }
+            }
+        }
+
+
+        /**
+         * @brief Replace the content of the series with the one read from a snapshot.
+         * 
+         * @param r The snapshot reader.
+         */
+        void load(snapshot_reader & r) override
+        {
+            _notify_change();
+            if constexpr (__is_trivially_copyable(ComponentType))
+                r.read(&_emask, _state_bytes());
+            else
+            {
+                for (entity e = 0; e < Entities; e++)
+                {
+                    if (_emask.contains(e))
+                        _data[e].~ComponentType();
+                }
+                r.read_value(_emask);
+                for (entity e = 0; e < Entities; e++)
+                {
+                    if (_emask.contains(e))
+                    {
+                        ::new(static_cast<void*>(_data + e)) ComponentType();
+                        snapshot_hooks<ComponentType>::load(r, _data[e]);
+                    }
+                }
+            }
+#ifdef ESA_STATE_HASH
+            _hash.reset([this](entity x) { return _entry(x); });
+#endif
+        }
+
+
+        /**
+         * @brief Restore the component of an entity saved in a rollback log.
+         * 
+         * @param e The ID of the entity.
+         * @param owned True if the entity owned the component.
+         * @param data The bytes of the component.
+         */
+        void rewind(entity e, bool owned, const void * data) override
+        {
+            if constexpr (__is_trivially_copyable(ComponentType))
+            {
+                _notify_change();
+                _unhash(e);
+                if (owned)
+                    _emask.add(e);
+                else
+                    _emask.remove(e);
+                __builtin_memcpy(static_cast<void*>(_data + e), data, sizeof(ComponentType));
+            }
+        }
+
+
+#ifdef ESA_STATE_HASH
+        /**
+         * @brief Returns the hash of the components (of the entities owning them, and of their bytes).
+         * The cost depends on the number of components changed since the last call. (only with `ESA_STATE_HASH`)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t hash() override
+        {
+            return _hash.value([this](entity x) { return _entry(x); });
+        }
+#endif
+
+
+        /**
+         * @brief Remove the component from all the entities.
+         * 
+         */
+        void clear() override
+        {
+            for (entity e = 0; e < Entities; e++)
+            {
+                if (_emask.contains(e))
+                    remove(e);
+            }
+        }
+
+
         /**
          * @brief Remove a component from an entity.
          * 
@@ -50,6 +304,14 @@ namespace esa
          */
         void remove(entity e) override
         {
+            if (!_emask.contains(e))
+            {
+                ESA_ACCESS(_column, _where, access_kind::READ, 4);
+                return;
+            }
+            ESA_ACCESS(_column, _where, access_kind::WRITE, 4);
+            _touch(e);
+            _unhash(e);
             _emask.remove(e);
             _data[e].~ComponentType();
         }
@@ -64,8 +326,53 @@ namespace esa
          */
         [[nodiscard]] bool has(entity e) override
         {
+            ESA_ACCESS(_column, _where, access_kind::READ, 4);
             return _emask.contains(e);
         }
+
+
+        /**
+         * @brief Returns the number of entities owning this component.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t count() override
+        {
+            return _emask.count();
+        }
+
+
+        /**
+         * @brief Returns the maximum number of entities that can own this component. (`Entities`)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t capacity() override
+        {
+            return Entities;
+        }
+
+
+        /**
+         * @brief Returns the size of the series, in bytes.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t bytes() override
+        {
+            return sizeof(series<ComponentType, Entities>);
+        }
+
+
+        /**
+         * @brief Returns the size of the entity mask and of the components in a snapshot.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t state_bytes() override
+        {
+            return _state_bytes();
+        }
         
 
         /**
@@ -76,7 +383,26 @@ namespace esa
          */
         [[nodiscard]] ComponentType & get(entity e)
         {
-            assert(this->has(e) && "ESA ERROR: entity does not own the requested component!");
+            assert(_emask.contains(e) && "ESA ERROR: entity does not own the requested component!");
+            ESA_ACCESS(_column, _where, access_kind::MODIFY, sizeof(ComponentType));
+            _touch(e);
+            _unhash(e);
+            return _data[e];
+        }
+
+
+        /**
+         * @brief Returns a constant reference to the component for an entity.
+         * Same as `get`, but not treated as a change by the rollback log and the state hash,
+         * and reported as a read when `ESA_INSTRUMENT` is defined.
+         * 
+         * @param e The ID of the entity.
+         * @return const ComponentType& 
+         */
+        [[nodiscard]] const ComponentType & read(entity e)
+        {
+            assert(_emask.contains(e) && "ESA ERROR: entity does not own the requested component!");
+            ESA_ACCESS(_column, _where, access_kind::READ, sizeof(ComponentType));
             return _data[e];
         }
 
@@ -90,6 +416,9 @@ namespace esa
         [[nodiscard]] ComponentType & operator[](uint32_t i)
         {
             assert(i < Entities && "ECSA ERROR: series index out of range!");
+            ESA_ACCESS(_column, _where, access_kind::MODIFY, sizeof(ComponentType));
+            _touch(i);
+            _unhash(i);
             return _data[i];
         }
 
@@ -0,0 +1,479 @@
+#ifndef ESA_SLICED_UPDATER_H
+#define ESA_SLICED_UPDATER_H
+
+#include <cassert>
+
+#include "esa.h"
+#include "esa_iupdater.h"
+
+
+namespace esa
+{
+
+    class isliced_updater : public isubscribable_updater
+    {
+        /**
+         * @brief Maximum number of entities processed per frame. (`0` = no limit)
+         * 
+         */
+        uint32_t _budget;
+
+
+        /**
+         * @brief Clock used for the time budget. (`nullptr` = no time budget)
+         * 
+         */
+        clock_fn _clock;
+
+
+        /**
+         * @brief Maximum time spent per frame, in clock units.
+         * 
+         */
+        uint32_t _time_budget;
+
+
+#ifdef ESA_ROLLBACK
+        /**
+         * @brief The rollback epoch in which the position was last saved. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        uint32_t _position_saved = 0;
+#endif
+
+
+        protected:
+
+
+        /**
+         * @brief Save the position in the sweep in the rollback log of the table, before it changes for the first time
+         * in a frame: a few bytes, instead of the whole subscriber list. Does nothing unless `ESA_ROLLBACK` is defined.
+         * 
+         * @param cursor The position of the next entity to process.
+         * @param sweeps The number of completed sweeps.
+         */
+        void _touch_position(uint32_t cursor, uint32_t sweeps)
+        {
+#ifdef ESA_ROLLBACK
+            rollback_log * log = _rollback_log();
+            if (log != nullptr && log->first(_position_saved))
+                log->record(rollback_kind::SLICE, rollback_slice { tag(), cursor, sweeps });
+#endif
+        }
+
+
+        /**
+         * @brief Tells if the budget for the current frame is exhausted.
+         * 
+         * @param processed The number of entities processed in the current frame.
+         * @param start The clock value at the beginning of the frame.
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool exhausted(uint32_t processed, uint32_t start)
+        {
+            if (_budget > 0 && processed >= _budget)
+                return true;
+            return _clock != nullptr && (*_clock)() - start >= _time_budget;
+        }
+
+
+        /**
+         * @brief Returns the current clock value (`0` if there is no time budget).
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t now()
+        {
+            return _clock != nullptr ? (*_clock)() : 0;
+        }
+
+
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         * @param tag The unique tag for the updater.
+         */
+        isliced_updater(tag_t tag)
+            : isubscribable_updater(tag)
+        {
+            _budget = 0;
+            _clock = nullptr;
+            _time_budget = 0;
+        }
+
+
+        /**
+         * @brief Set the maximum number of entities processed per frame.
+         * 
+         * @param entities The number of entities. (`0` = no limit)
+         */
+        void set_budget(uint32_t entities)
+        {
+            _budget = entities;
+        }
+
+
+        /**
+         * @brief Set the maximum time spent per frame. The budget is checked after
+         * each entity, so at least one entity is always processed.
+         * 
+         * @param clock A function returning the current time. (a GBA timer, `clock_gettime`, ...)
+         * @param budget The time budget, in clock units. 
+         */
+        void set_time_budget(clock_fn clock, uint32_t budget)
+        {
+            _clock = clock;
+            _time_budget = budget;
+        }
+
+
+        /**
+         * @brief Returns the maximum number of entities processed per frame.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t budget()
+        {
+            return _budget;
+        }
+
+
+        /**
+         * @brief Tells that this updater processes its entities across frames.
+         * 
+         */
+        bool sliced() override
+        {
+            return true;
+        }
+
+
+        /**
+         * @brief Restore the position in the sweep saved in a rollback log.
+         * 
+         * @param cursor The position of the next entity to process.
+         * @param sweeps The number of completed sweeps.
+         */
+        virtual void rewind_position(uint32_t cursor, uint32_t sweeps) = 0;
+
+
+        virtual ~isliced_updater() = default;
+    };
+
+
+
+    template<uint32_t Entities>
+    class sliced_updater : public isliced_updater
+    {
+        /**
+         * @brief The IDs of the entities subscribed to the updater.
+         * 
+         */
+        vector<entity, Entities> _entities;
+
+
+        /**
+         * @brief Position of the next entity to process in `_entities`.
+         * 
+         */
+        uint32_t _cursor;
+
+
+        /**
+         * @brief The number of completed sweeps.
+         * 
+         */
+        uint32_t _sweeps;
+
+
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         * @param tag The unique tag for the updater.
+         */
+        sliced_updater(tag_t tag) : isliced_updater(tag)
+        {
+            _cursor = 0;
+            _sweeps = 0;
+        }
+
+
+        /**
+         * @brief Filter entities processed by this udpater based on their components.
+         * 
+         */
+        virtual bool select(entity e)
+        {
+            return false;
+        }
+
+
+        /**
+         * @brief Called before the first entity of a sweep is processed.
+         * 
+         */
+        virtual void begin_sweep()
+        {
+
+        }
+
+
+        /**
+         * @brief Process one entity.
+         * 
+         * @param e The ID of the entity.
+         */
+        virtual void process(entity e) = 0;
+
+
+        /**
+         * @brief Called after the last entity of a sweep is processed.
+         * 
+         */
+        virtual void end_sweep()
+        {
+
+        }
+
+
+        /**
+         * @brief Process entities from the stored cursor, until either the budget for
+         * the frame is exhausted or the sweep is completed.
+         * 
+         */
+        void update() override
+        {
+            if (_entities.empty())
+                return;
+            _touch_position(_cursor, _sweeps);
+            if (_cursor == 0)
+                begin_sweep();
+            uint32_t start = now();
+            uint32_t processed = 0;
+            while (_cursor < _entities.size())
+            {
+                // move the cursor first, so that `process` can unsubscribe the entity
+                entity e = _entities[_cursor];
+                _cursor++;
+                ESA_ACCESS(instrument::SUBSCRIBERS, ram::EWRAM, access_kind::READ, sizeof(entity));
+                if (!enabled(e))
+                    continue;
+                process(e);
+                processed++;
+                if (exhausted(processed, start))
+                    break;
+            }
+            if (_cursor >= _entities.size())
+            {
+                _cursor = 0;
+                _sweeps++;
+                end_sweep();
+            }
+        }
+
+
+        /**
+         * @brief Subscribe an entity to the udpater. The entity is processed
+         * in the current sweep, if it is still in progress.
+         * 
+         */
+        void subscribe(entity e) override
+        {
+            for (auto ent : _entities)
+            {
+                if (ent == e)
+                    return;
+            }
+            if (select(e))
+            {
+                _touch();
+                _hash_subscription(e);
+                _entities.push_back(e);
+            }
+        }
+
+
+        /**
+         * @brief Subscribe several entities to the updater. The subscribed entities are checked for duplicates
+         * once for the whole batch.
+         * 
+         * @param entities The IDs of the entities.
+         * @param count The number of entities.
+         */
+        void subscribe(const entity * entities, uint32_t count) override
+        {
+            bool batched = for_each_new(_entities, entities, count, [this](entity e)
+            {
+                if (select(e))
+                {
+                    _touch();
+                    _hash_subscription(e);
+                    _entities.push_back(e);
+                }
+            });
+            if (!batched)
+            {
+                for (uint32_t i = 0; i < count; i++)
+                    subscribe(entities[i]);
+            }
+        }
+
+
+        /**
+         * @brief Unsubscribe an entity from the udpater. The cursor is kept
+         * on the next entity to process.
+         * 
+         */
+        void unsubscribe(entity e) override
+        {
+            for (uint32_t i = 0; i < _entities.size(); i++)
+            {
+                if (_entities[i] == e)
+                {
+                    _touch();
+                    _hash_subscription(e);
+                    _entities.erase(i);
+                    if (i < _cursor)
+                        _cursor--;
+                    break;
+                }
+            }
+        }
+
+
+        void unsubscribe(entity e, bool destroy) override
+        {
+            unsubscribe(e);
+        }
+
+
+        /**
+         * @brief Restore the position in the sweep saved in a rollback log.
+         * 
+         * @param cursor The position of the next entity to process.
+         * @param sweeps The number of completed sweeps.
+         */
+        void rewind_position(uint32_t cursor, uint32_t sweeps) override
+        {
+            _cursor = cursor;
+            _sweeps = sweeps;
+        }
+
+
+        /**
+         * @brief Returns the position of the next entity to process in the subscription list.
+         * (`0` if a new sweep starts at the next frame)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t cursor()
+        {
+            return _cursor;
+        }
+
+
+        /**
+         * @brief Returns the number of sweeps completed so far.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t sweeps()
+        {
+            return _sweeps;
+        }
+
+
+        /**
+         * @brief Returns a vector with the IDs of the entities currently subscribed to the updater.
+         * Entities disabled in the table are skipped.
+         * 
+         * @return vector<entity, Entities> 
+         */
+        [[nodiscard]] vector<entity, Entities> subscribed()
+        {
+            if (!filtering())
+            {
+                ESA_COPY(sizeof(_entities));
+                return _entities;
+            }
+            ESA_COPY(_entities.size() * sizeof(entity));
+            vector<entity, Entities> ids;
+            for (auto e : _entities)
+            {
+                if (enabled(e))
+                    ids.push_back(e);
+            }
+            return ids;
+        }
+
+
+        /**
+         * @brief Returns the number of entities subscribed to the updater. (including disabled ones)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t count() override
+        {
+            return _entities.size();
+        }
+
+
+        /**
+         * @brief Returns the maximum number of entities that can be subscribed to the updater. (`Entities`)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t capacity() override
+        {
+            return Entities;
+        }
+
+
+        /**
+         * @brief Write the subscribed entities and the position in the sweep to a snapshot.
+         * 
+         * @param w The snapshot writer.
+         */
+        void save(snapshot_writer & w) override
+        {
+            w.write_vector(_entities);
+            w.write_value(_cursor);
+            w.write_value(_sweeps);
+        }
+
+
+        /**
+         * @brief Replace the subscribed entities and the position in the sweep with the ones read from a snapshot.
+         * 
+         * @param r The snapshot reader.
+         */
+        void load(snapshot_reader & r) override
+        {
+            r.read_vector(_entities);
+            _reset_subscription_hash();
+            for (entity e : _entities)
+                _hash_subscription(e);
+            r.read_value(_cursor);
+            r.read_value(_sweeps);
+        }
+
+
+        /**
+         * @brief Virtual destructor.
+         * 
+         */
+        virtual ~sliced_updater() = default;
+
+    };
+
+}
+
+
+#endif
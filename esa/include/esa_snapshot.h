@@ -0,0 +1,303 @@
+#ifndef ESA_SNAPSHOT_H
+#define ESA_SNAPSHOT_H
+
+#include <cassert>
+
+#include "esa.h"
+
+
+namespace esa
+{
+    /**
+     * @brief The header of a table snapshot. All the fields are checked by `restore()` before
+     * anything is changed in the table.
+     * 
+     */
+    struct snapshot_header
+    {
+        /**
+         * @brief Identifies a table snapshot ("ESAS").
+         * 
+         */
+        static constexpr uint32_t MAGIC = 0x53415345;
+
+
+        /**
+         * @brief The version of the format.
+         * 
+         */
+        static constexpr uint32_t VERSION = 5;
+
+
+        uint32_t magic;
+        uint32_t version;
+
+
+        /**
+         * @brief The size of the snapshot, in bytes (header included).
+         * 
+         */
+        uint32_t bytes;
+
+
+        /**
+         * @brief The template parameters of the table (`Entities`, `Components`), and the number of updaters,
+         * cached queries and cached apply objects attached to it.
+         * 
+         */
+        uint32_t entities;
+        uint32_t components;
+        uint32_t updaters;
+        uint32_t queries;
+        uint32_t applys;
+
+
+        /**
+         * @brief A checksum of the layout of the table: the size of the content of each column and the tag of each updater.
+         * 
+         */
+        uint32_t layout;
+
+
+        /**
+         * @brief `1` if the snapshot contains the columns, `0` if it only contains the rest of the table.
+         * 
+         */
+        uint32_t columns;
+    };
+
+
+    /**
+     * @brief Writes a snapshot to a buffer. Without a buffer, it only counts the bytes.
+     * 
+     */
+    class snapshot_writer
+    {
+        /**
+         * @brief The buffer. (`nullptr` = count only)
+         * 
+         */
+        unsigned char * _buffer;
+
+
+        /**
+         * @brief The size of the buffer.
+         * 
+         */
+        uint32_t _capacity;
+
+
+        /**
+         * @brief The number of bytes written (or counted).
+         * 
+         */
+        uint32_t _size;
+
+
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         * @param buffer The buffer. (`nullptr` to only count the bytes)
+         * @param bytes The size of the buffer.
+         */
+        snapshot_writer(void * buffer, uint32_t bytes)
+        {
+            _buffer = static_cast<unsigned char *>(buffer);
+            _capacity = bytes;
+            _size = 0;
+        }
+
+
+        /**
+         * @brief Write some bytes. Nothing is written past the end of the buffer.
+         * 
+         * @param data The bytes.
+         * @param bytes The number of bytes.
+         */
+        void write(const void * data, uint32_t bytes)
+        {
+            if (_buffer != nullptr && _size + bytes <= _capacity)
+                __builtin_memcpy(_buffer + _size, data, bytes);
+            _size += bytes;
+        }
+
+
+        /**
+         * @brief Write a value of any trivially copyable type.
+         * 
+         * @param value The value.
+         */
+        template<typename Type>
+        void write_value(const Type & value)
+        {
+            static_assert(__is_trivially_copyable(Type), "ESA ERROR: the type is not trivially copyable!");
+            write(&value, sizeof(Type));
+        }
+
+
+        /**
+         * @brief Write the size of a vector of trivially copyable elements, then its elements.
+         * 
+         * @param v The vector.
+         */
+        template<typename Type, uint32_t MaxSize>
+        void write_vector(vector<Type, MaxSize> & v)
+        {
+            static_assert(__is_trivially_copyable(Type), "ESA ERROR: the type is not trivially copyable!");
+            write_value(v.size());
+            write(v.begin(), v.size() * uint32_t(sizeof(Type)));
+        }
+
+
+        /**
+         * @brief Returns the number of bytes written (or counted).
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t size()
+        {
+            return _size;
+        }
+
+
+        /**
+         * @brief Tells if the bytes did not fit in the buffer.
+         * 
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool overflow()
+        {
+            return _size > _capacity;
+        }
+    };
+
+
+    /**
+     * @brief Reads a snapshot from a buffer.
+     * 
+     */
+    class snapshot_reader
+    {
+        /**
+         * @brief The buffer.
+         * 
+         */
+        const unsigned char * _buffer;
+
+
+        /**
+         * @brief The size of the buffer.
+         * 
+         */
+        uint32_t _capacity;
+
+
+        /**
+         * @brief The number of bytes read.
+         * 
+         */
+        uint32_t _position;
+
+
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         * @param buffer The buffer.
+         * @param bytes The size of the buffer.
+         */
+        snapshot_reader(const void * buffer, uint32_t bytes)
+        {
+            _buffer = static_cast<const unsigned char *>(buffer);
+            _capacity = bytes;
+            _position = 0;
+        }
+
+
+        /**
+         * @brief Read some bytes.
+         * 
+         * @param data Where to copy the bytes.
+         * @param bytes The number of bytes.
+         */
+        void read(void * data, uint32_t bytes)
+        {
+            assert(_position + bytes <= _capacity && "ESA ERROR: snapshot is truncated!");
+            __builtin_memcpy(data, _buffer + _position, bytes);
+            _position += bytes;
+        }
+
+
+        /**
+         * @brief Read a value of any trivially copyable type.
+         * 
+         * @param value The value.
+         */
+        template<typename Type>
+        void read_value(Type & value)
+        {
+            static_assert(__is_trivially_copyable(Type), "ESA ERROR: the type is not trivially copyable!");
+            read(&value, sizeof(Type));
+        }
+
+
+        /**
+         * @brief Replace the elements of a vector with the ones written by `snapshot_writer::write_vector`.
+         * 
+         * @param v The vector.
+         */
+        template<typename Type, uint32_t MaxSize>
+        void read_vector(vector<Type, MaxSize> & v)
+        {
+            static_assert(__is_trivially_copyable(Type), "ESA ERROR: the type is not trivially copyable!");
+            uint32_t size;
+            read_value(size);
+            assert(size <= MaxSize && "ESA ERROR: snapshot vector is too large!");
+            v.resize(size);
+            read(v.begin(), size * uint32_t(sizeof(Type)));
+        }
+
+
+        /**
+         * @brief Returns the number of bytes read.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t position()
+        {
+            return _position;
+        }
+    };
+
+
+    /**
+     * @brief How the components of a type that is not trivially copyable are saved and restored in snapshots.
+     * Specialize it for each such type that is stored in a table; trivially copyable components are copied
+     * with one `memcpy` per column, and do not need it. When restoring, the component is default constructed
+     * first, then passed to `load`. Without a specialization, taking a snapshot of such a column fails an assertion.
+     * 
+     * @tparam ComponentType The type of the component.
+     */
+    template<typename ComponentType>
+    struct snapshot_hooks
+    {
+        static void save(snapshot_writer & w, const ComponentType & c)
+        {
+            assert(1 == 2 && "ESA ERROR: specialize esa::snapshot_hooks to snapshot components that are not trivially copyable!");
+        }
+
+
+        static void load(snapshot_reader & r, ComponentType & c)
+        {
+            assert(1 == 2 && "ESA ERROR: specialize esa::snapshot_hooks to snapshot components that are not trivially copyable!");
+        }
+    };
+}
+
+#endif
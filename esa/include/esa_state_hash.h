@@ -0,0 +1,152 @@
+#ifndef ESA_STATE_HASH_H
+#define ESA_STATE_HASH_H
+
+#include <cassert>
+
+#include "esa.h"
+
+
+namespace esa
+{
+    /**
+     * @brief Mix the bits of a hash, so that close values give unrelated hashes.
+     * 
+     * @param h The hash.
+     * @return uint32_t 
+     */
+    [[nodiscard]] inline uint32_t hash_mix(uint32_t h)
+    {
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+        return h;
+    }
+
+
+    /**
+     * @brief Combine a value with a hash. The order of the values matters.
+     * 
+     * @param h The hash.
+     * @param value The value.
+     * @return uint32_t 
+     */
+    [[nodiscard]] inline uint32_t hash_combine(uint32_t h, uint32_t value)
+    {
+        return hash_mix(h ^ (value + 0x9e3779b9u + (h << 6) + (h >> 2)));
+    }
+
+
+    /**
+     * @brief Returns the hash of an entry (an entity, and some bytes such as its component).
+     * Entries are combined with `^`, so that they can be added and removed in any order.
+     * 
+     * @param e The ID of the entity.
+     * @param data The bytes. (`nullptr` = none)
+     * @param bytes The number of bytes.
+     * @return uint32_t 
+     */
+    [[nodiscard]] inline uint32_t hash_entry(entity e, const void * data, uint32_t bytes)
+    {
+        uint32_t h = 2166136261u ^ e;
+        const unsigned char * p = static_cast<const unsigned char *>(data);
+        for (uint32_t i = 0; i < bytes; i++)
+            h = (h ^ p[i]) * 16777619u;
+        return hash_mix(h + e);
+    }
+
+
+    /**
+     * @brief A hash of a set of entries, one per entity, updated as the entries change.
+     * Before an entry is changed, `change` removes it from the hash and remembers the entity;
+     * `value` adds the current entries of the changed entities back. The cost depends on the
+     * number of entities changed since the last call to `value`, not on the number of entities.
+     * 
+     * @tparam Entities The maximum number of entities.
+     */
+    template<uint32_t Entities>
+    class running_hash
+    {
+        /**
+         * @brief The entities changed since the last call to `value`.
+         * 
+         */
+        entity_mask<Entities> _changed;
+
+
+        /**
+         * @brief The list of the entities changed since the last call to `value`.
+         * 
+         */
+        vector<entity, Entities> _pending;
+
+
+        /**
+         * @brief The hash of the entries of the entities not changed.
+         * 
+         */
+        uint32_t _hash = 0;
+
+
+        public:
+
+
+        /**
+         * @brief Call before the entry of an entity changes.
+         * 
+         * @tparam Function The type of the function returning the entry of an entity. (`0` = none)
+         * @param e The ID of the entity.
+         * @param entry The function.
+         */
+        template<typename Function>
+        void change(entity e, Function && entry)
+        {
+            if (_changed.contains(e))
+                return;
+            _hash ^= entry(e);
+            _changed.add(e);
+            _pending.push_back(e);
+        }
+
+
+        /**
+         * @brief Returns the hash of the entries.
+         * 
+         * @tparam Function The type of the function returning the entry of an entity. (`0` = none)
+         * @param entry The function.
+         * @return uint32_t 
+         */
+        template<typename Function>
+        [[nodiscard]] uint32_t value(Function && entry)
+        {
+            for (entity e : _pending)
+            {
+                _hash ^= entry(e);
+                _changed.remove(e);
+            }
+            _pending.clear();
+            return _hash;
+        }
+
+
+        /**
+         * @brief Compute the hash again from all the entries (e.g. after restoring a snapshot).
+         * 
+         * @tparam Function The type of the function returning the entry of an entity. (`0` = none)
+         * @param entry The function.
+         */
+        template<typename Function>
+        void reset(Function && entry)
+        {
+            for (entity e : _pending)
+                _changed.remove(e);
+            _pending.clear();
+            _hash = 0;
+            for (uint32_t e = 0; e < Entities; e++)
+                _hash ^= entry(entity(e));
+        }
+    };
+}
+
+#endif
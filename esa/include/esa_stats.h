@@ -0,0 +1,175 @@
+#ifndef ESA_STATS_H
+#define ESA_STATS_H
+
+#include "esa.h"
+
+
+namespace esa
+{
+    /**
+     * @brief How much of a fixed-size container is in use (a column, the subscriber list of an updater, ...).
+     * 
+     */
+    struct usage
+    {
+        /**
+         * @brief The number of elements in use.
+         * 
+         */
+        uint32_t count;
+
+
+        /**
+         * @brief The maximum number of elements. (`0` if unbounded or unknown)
+         * 
+         */
+        uint32_t capacity;
+
+
+        /**
+         * @brief Returns the percentage of the capacity in use. (`0` if the capacity is unknown)
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t percent() const
+        {
+            return capacity == 0 ? 0 : count * 100 / capacity;
+        }
+    };
+
+
+    /**
+     * @brief Structural operations counted by a table.
+     * 
+     */
+    struct churn
+    {
+        /**
+         * @brief Entities created.
+         * 
+         */
+        uint32_t created;
+
+
+        /**
+         * @brief Entities destroyed.
+         * 
+         */
+        uint32_t destroyed;
+
+
+        /**
+         * @brief Calls to `entity_table::subscribe()`.
+         * 
+         */
+        uint32_t subscribed;
+    };
+
+
+    /**
+     * @brief Occupancy, fragmentation and churn of a table, as returned by `entity_table::stats()`.
+     * 
+     */
+    struct table_stats
+    {
+        /**
+         * @brief The number of entities in the table. (`entity_table::size()`)
+         * 
+         */
+        uint32_t entities;
+
+
+        /**
+         * @brief The maximum number of entities. (`Entities`)
+         * 
+         */
+        uint32_t capacity;
+
+
+        /**
+         * @brief The number of rows used. (`entity_table::used()`: rows scanned by `update()`, `clear()` and function queries)
+         * 
+         */
+        uint32_t used;
+
+
+        /**
+         * @brief Rows below `used` whose entity was destroyed.
+         * 
+         */
+        uint32_t holes;
+
+
+        /**
+         * @brief Entity IDs waiting to be reused.
+         * 
+         */
+        uint32_t pooled;
+
+
+        /**
+         * @brief Disabled entities.
+         * 
+         */
+        uint32_t disabled;
+
+
+        /**
+         * @brief The largest number of entities since the table was created (or since `entity_table::reset_stats()`).
+         * 
+         */
+        uint32_t peak_entities;
+
+
+        /**
+         * @brief The largest number of rows used since the table was created (or since `entity_table::reset_stats()`).
+         * 
+         */
+        uint32_t peak_used;
+
+
+        /**
+         * @brief The number of frames counted in `total`.
+         * 
+         */
+        uint32_t frames;
+
+
+        /**
+         * @brief Structural operations during the last frame.
+         * 
+         */
+        churn last;
+
+
+        /**
+         * @brief Structural operations since the table was created (or since `entity_table::reset_stats()`).
+         * 
+         */
+        churn total;
+
+
+        /**
+         * @brief Returns the percentage of the used rows that are holes.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t hole_percent() const
+        {
+            return used == 0 ? 0 : holes * 100 / used;
+        }
+
+
+        /**
+         * @brief Returns the percentage of the entity IDs in use.
+         * 
+         * @return uint32_t
+         */
+        [[nodiscard]] uint32_t fill_percent() const
+        {
+            return capacity == 0 ? 0 : entities * 100 / capacity;
+        }
+    };
+}
+
+#endif
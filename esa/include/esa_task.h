@@ -0,0 +1,832 @@
+#ifndef ESA_TASK_H
+#define ESA_TASK_H
+
+#include <cassert>
+#include <cstddef>
+#include <coroutine>
+
+#include "esa.h"
+#include "esa_iupdater.h"
+
+
+namespace esa
+{
+
+    template<uint32_t FrameSize, uint32_t Frames>
+    class task_pool
+    {
+        /**
+         * @brief Storage for the coroutine frames.
+         * 
+         */
+        alignas(8) inline static unsigned char _frames [ Frames ][ FrameSize ];
+
+
+        /**
+         * @brief Tells which frames are currently in use.
+         * 
+         */
+        inline static bool _used [ Frames ];
+
+
+        public:
+
+
+        /**
+         * @brief Obtain a free frame from the pool.
+         * 
+         * @param size The size of the coroutine frame requested by the compiler.
+         * @return void* A pointer to the frame, or `nullptr` if no frame is available.
+         */
+        [[nodiscard]] static void * allocate(std::size_t size)
+        {
+            assert(size <= FrameSize && "ESA ERROR: task frame is larger than the FrameSize of the pool!");
+            if (size > FrameSize)
+                return nullptr;
+            for (uint32_t i = 0; i < Frames; i++)
+            {
+                if (!_used[i])
+                {
+                    _used[i] = true;
+                    return _frames[i];
+                }
+            }
+            assert(1 == 2 && "ESA ERROR: task pool is full!");
+            return nullptr;
+        }
+
+
+        /**
+         * @brief Give a frame back to the pool.
+         * 
+         * @param p A pointer to the frame.
+         */
+        static void release(void * p)
+        {
+            for (uint32_t i = 0; i < Frames; i++)
+            {
+                if (_frames[i] == p)
+                {
+                    _used[i] = false;
+                    return;
+                }
+            }
+        }
+
+
+        /**
+         * @brief Returns the number of frames currently in use.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] static uint32_t used()
+        {
+            uint32_t n = 0;
+            for (uint32_t i = 0; i < Frames; i++)
+            {
+                if (_used[i])
+                    n++;
+            }
+            return n;
+        }
+
+    };
+
+
+
+    class task_state
+    {
+        public:
+
+
+        /**
+         * @brief What the task is waiting for.
+         * 
+         */
+        enum class wait
+        {
+            NONE,
+            FRAME,
+            CHANGE
+        };
+
+
+        /**
+         * @brief Handle of the coroutine.
+         * 
+         */
+        std::coroutine_handle<> handle;
+
+
+        /**
+         * @brief The scheduler running the task.
+         * 
+         */
+        itask_updater * scheduler = nullptr;
+
+
+        /**
+         * @brief The entity owning the task.
+         * 
+         */
+        entity owner = 0;
+
+
+        /**
+         * @brief Current wait condition.
+         * 
+         */
+        wait waiting = wait::NONE;
+
+
+        /**
+         * @brief Number of frames to wait, or frame on which the task wakes up.
+         * 
+         */
+        uint32_t frame = 0;
+
+
+        /**
+         * @brief Tag of the awaited component.
+         * 
+         */
+        tag_t tag = 0;
+
+
+        /**
+         * @brief Entity owning the awaited component.
+         * 
+         */
+        entity target = 0;
+
+
+        /**
+         * @brief True if the task was cancelled while its updater was resuming tasks:
+         * its frame is destroyed by the updater once it is safe to do so.
+         * 
+         */
+        bool cancelled = false;
+
+    };
+
+
+
+    template<uint32_t FrameSize, uint32_t Frames>
+    class task
+    {
+        public:
+
+
+        /**
+         * @brief Coroutine promise. Frames are allocated from a `task_pool`, never on the heap.
+         * 
+         */
+        class promise_type : public task_state
+        {
+            public:
+
+
+            static void * operator new(std::size_t size) noexcept
+            {
+                return task_pool<FrameSize, Frames>::allocate(size);
+            }
+
+
+            static void operator delete(void * p)
+            {
+                task_pool<FrameSize, Frames>::release(p);
+            }
+
+
+            static task get_return_object_on_allocation_failure()
+            {
+                return task(nullptr);
+            }
+
+
+            task get_return_object()
+            {
+                handle = std::coroutine_handle<promise_type>::from_promise(*this);
+                return task(this);
+            }
+
+
+            std::suspend_always initial_suspend() noexcept
+            {
+                return {};
+            }
+
+
+            std::suspend_always final_suspend() noexcept
+            {
+                return {};
+            }
+
+
+            void return_void()
+            {
+
+            }
+
+
+            void unhandled_exception()
+            {
+                assert(1 == 2 && "ESA ERROR: unhandled exception inside a task!");
+            }
+
+        };
+
+
+        private:
+
+
+        /**
+         * @brief State of the coroutine (`nullptr` if the frame could not be allocated).
+         * 
+         */
+        task_state * _state;
+
+
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         * @param state The state of the coroutine.
+         */
+        explicit task(task_state * state)
+        {
+            _state = state;
+        }
+
+
+        task(const task &) = delete;
+        task & operator=(const task &) = delete;
+
+
+        /**
+         * @brief Move constructor: the coroutine now belongs to this task.
+         * 
+         * @param other The task.
+         */
+        task(task && other)
+        {
+            _state = other._state;
+            other._state = nullptr;
+        }
+
+
+        /**
+         * @brief Destructor. If the task was never spawned, its coroutine frame is given back to the `task_pool`.
+         * 
+         */
+        ~task()
+        {
+            if (_state != nullptr)
+                _state->handle.destroy();
+        }
+
+
+        /**
+         * @brief Give the coroutine to a task updater (called by `task_updater::spawn`).
+         * 
+         * @return task_state* The state of the coroutine.
+         */
+        [[nodiscard]] task_state * release()
+        {
+            task_state * s = _state;
+            _state = nullptr;
+            return s;
+        }
+
+
+        /**
+         * @brief Returns the state of the coroutine.
+         * 
+         * @return task_state* 
+         */
+        [[nodiscard]] task_state * state()
+        {
+            return _state;
+        }
+
+
+        /**
+         * @brief Tells if the coroutine frame was allocated.
+         * 
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool valid()
+        {
+            return _state != nullptr;
+        }
+
+    };
+
+
+
+    /**
+     * @brief Awaitable: suspend the task for a number of frames.
+     * 
+     */
+    class wait_frames
+    {
+        /**
+         * @brief The number of frames.
+         * 
+         */
+        uint32_t _frames;
+
+
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         * @param n The number of frames to wait.
+         */
+        wait_frames(uint32_t n)
+        {
+            _frames = n;
+        }
+
+
+        bool await_ready() noexcept
+        {
+            return _frames == 0;
+        }
+
+
+        template<typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> h) noexcept
+        {
+            task_state & s = h.promise();
+            s.waiting = task_state::wait::FRAME;
+            s.frame = _frames;
+        }
+
+
+        void await_resume() noexcept
+        {
+
+        }
+
+    };
+
+
+
+    /**
+     * @brief Awaitable: suspend the task until a component of an entity is reported as changed.
+     * 
+     */
+    class wait_change
+    {
+        /**
+         * @brief The tag of the component.
+         * 
+         */
+        tag_t _tag;
+
+
+        /**
+         * @brief The entity owning the component.
+         * 
+         */
+        entity _entity;
+
+
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         * @param tag The tag of the component.
+         * @param e The ID of the entity.
+         */
+        wait_change(tag_t tag, entity e)
+        {
+            _tag = tag;
+            _entity = e;
+        }
+
+
+        bool await_ready() noexcept
+        {
+            return false;
+        }
+
+
+        template<typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> h) noexcept
+        {
+            task_state & s = h.promise();
+            s.waiting = task_state::wait::CHANGE;
+            s.tag = _tag;
+            s.target = _entity;
+        }
+
+
+        void await_resume() noexcept
+        {
+
+        }
+
+    };
+
+
+    /**
+     * @brief Suspend the task until the next frame.
+     * 
+     * @return wait_frames 
+     */
+    [[nodiscard]] inline wait_frames next_frame()
+    {
+        return wait_frames(1);
+    }
+
+
+    /**
+     * @brief Suspend the task for `n` frames.
+     * 
+     * @param n The number of frames.
+     * @return wait_frames 
+     */
+    [[nodiscard]] inline wait_frames frames(uint32_t n)
+    {
+        return wait_frames(n);
+    }
+
+
+    /**
+     * @brief Suspend the task until the component with tag `Tag` of entity `e` is reported 
+     * as changed with `task_updater::changed<Tag>(e)`.
+     * 
+     * @tparam Tag The unique tag of the component.
+     * @param e The ID of the entity.
+     * @return wait_change 
+     */
+    template<tag_t Tag>
+    [[nodiscard]] wait_change component_changed(entity e)
+    {
+        return wait_change(Tag, e);
+    }
+
+
+
+    class itask_updater : public isubscribable_updater
+    {
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         * @param tag The unique tag for the updater.
+         */
+        itask_updater(tag_t tag)
+            : isubscribable_updater(tag)
+        {
+
+        }
+
+
+        virtual ~itask_updater() = default;
+    };
+
+
+
+    template<uint32_t Tasks>
+    class task_updater : public itask_updater
+    {
+        /**
+         * @brief Tasks to resume at the next update.
+         * 
+         */
+        vector<task_state *, Tasks> _ready;
+
+
+        /**
+         * @brief Tasks waiting for a frame, sorted by decreasing wake-up frame.
+         * 
+         */
+        vector<task_state *, Tasks> _sleeping;
+
+
+        /**
+         * @brief Tasks waiting for a component change.
+         * 
+         */
+        vector<task_state *, Tasks> _waiting;
+
+
+        /**
+         * @brief Tasks that could run, but are owned by entities disabled in the table.
+         * 
+         */
+        vector<task_state *, Tasks> _frozen;
+
+
+        /**
+         * @brief The number of updates processed.
+         * 
+         */
+        uint32_t _frame;
+
+
+        /**
+         * @brief The number of running tasks.
+         * 
+         */
+        uint32_t _running;
+
+
+        /**
+         * @brief The tasks being resumed by `update()`.
+         * 
+         */
+        vector<task_state *, Tasks> _resumed;
+
+
+        /**
+         * @brief The index in `_resumed` of the task being resumed.
+         * 
+         */
+        uint32_t _current;
+
+
+        /**
+         * @brief Put a task in the list matching its wait condition, or destroy it if it completed.
+         * 
+         * @param s The state of the task.
+         */
+        void _park(task_state * s)
+        {
+            if (s->handle.done())
+            {
+                s->handle.destroy();
+                _running--;
+                return;
+            }
+            if (s->waiting == task_state::wait::CHANGE)
+            {
+                _waiting.push_back(s);
+                return;
+            }
+            s->frame += _frame;
+            uint32_t i = _sleeping.size();
+            while (i > 0 && _sleeping[i - 1]->frame < s->frame)
+                i--;
+            _sleeping.insert(i, s);
+        }
+
+
+        /**
+         * @brief Remove all the tasks owned by an entity from a list, destroying them.
+         * 
+         * @param list The list of tasks.
+         * @param e The ID of the entity.
+         */
+        void _cancel(vector<task_state *, Tasks> & list, entity e)
+        {
+            for (uint32_t i = list.size(); i > 0; i--)
+            {
+                task_state * s = list[i - 1];
+                if (s->owner == e)
+                {
+                    list.erase(i - 1);
+                    s->handle.destroy();
+                    _running--;
+                }
+            }
+        }
+
+
+        public:
+
+
+        /**
+         * @brief Constructor.
+         * 
+         * @param tag The unique tag for the updater.
+         */
+        task_updater(tag_t tag) : itask_updater(tag)
+        {
+            _frame = 0;
+            _running = 0;
+            _current = 0;
+        }
+
+
+        /**
+         * @brief Start a task owned by an entity. The task starts running at the next update,
+         * and it is destroyed when the entity is destroyed or unsubscribed.
+         * 
+         * @tparam FrameSize The frame size of the task pool.
+         * @tparam Frames The number of frames of the task pool.
+         * @param t The task.
+         * @param e The ID of the entity owning the task.
+         * @return true if the task was started.
+         * @return false if no coroutine frame was available.
+         */
+        template<uint32_t FrameSize, uint32_t Frames>
+        bool spawn(task<FrameSize, Frames> t, entity e)
+        {
+            if (!t.valid())
+                return false;
+            assert(_running < Tasks && "ESA ERROR: too many tasks for the task updater!");
+            task_state * s = t.release();
+            s->scheduler = this;
+            s->owner = e;
+            s->waiting = task_state::wait::FRAME;
+            _ready.push_back(s);
+            _running++;
+            return true;
+        }
+
+
+        /**
+         * @brief Report that a component of an entity changed, waking up the tasks
+         * waiting for it. They are resumed at the next update.
+         * 
+         * @tparam Tag The unique tag of the component.
+         * @param e The ID of the entity.
+         */
+        template<tag_t Tag>
+        void changed(entity e)
+        {
+            for (uint32_t i = 0; i < _waiting.size(); )
+            {
+                task_state * s = _waiting[i];
+                if (s->tag == Tag && s->target == e)
+                {
+                    _waiting.erase(i);
+                    _ready.push_back(s);
+                }
+                else
+                    i++;
+            }
+        }
+
+
+        /**
+         * @brief Resume the tasks whose wait condition is satisfied. Tasks waiting
+         * for a later frame or for a component change are not touched. Tasks owned by
+         * entities disabled in the table are frozen, and resumed at the first update
+         * after the entity is enabled again.
+         * 
+         */
+        void update() override
+        {
+            _frame++;
+            while (!_sleeping.empty() && _sleeping.back()->frame <= _frame)
+            {
+                _ready.push_back(_sleeping.back());
+                _sleeping.pop_back();
+            }
+            _resumed = _ready;
+            _ready.clear();
+            for (_current = 0; _current < _resumed.size(); _current++)
+            {
+                // tasks cancelled by a task resumed before them (e.g. by unsubscribing their entity)
+                task_state * s = _resumed[_current];
+                if (s->cancelled)
+                {
+                    s->handle.destroy();
+                    continue;
+                }
+                // tasks owned by disabled entities are frozen
+                if (!enabled(s->owner))
+                {
+                    _frozen.push_back(s);
+                    continue;
+                }
+                s->handle.resume();
+                if (s->cancelled)
+                    s->handle.destroy();
+                else
+                    _park(s);
+            }
+            _resumed.clear();
+        }
+
+
+        /**
+         * @brief Move the frozen tasks of an entity back to the tasks to resume at the next update.
+         * 
+         * @param e The ID of the entity.
+         */
+        void reenabled(entity e) override
+        {
+            for (uint32_t i = 0; i < _frozen.size(); )
+            {
+                task_state * s = _frozen[i];
+                if (s->owner == e)
+                {
+                    _frozen.erase(i);
+                    _ready.push_back(s);
+                }
+                else
+                    i++;
+            }
+        }
+
+
+        /**
+         * @brief Tasks are spawned explicitly with `spawn`.
+         * 
+         */
+        void subscribe(entity e) override
+        {
+
+        }
+
+
+        /**
+         * @brief Destroy all the tasks owned by an entity. If it is called by a task while the updater
+         * is resuming tasks, the tasks not resumed yet (and the calling task) are destroyed by `update()`.
+         * 
+         */
+        void unsubscribe(entity e) override
+        {
+            _cancel(_ready, e);
+            _cancel(_sleeping, e);
+            _cancel(_waiting, e);
+            _cancel(_frozen, e);
+            // the task being resumed, and the ones not resumed yet, are destroyed by `update()`
+            for (uint32_t i = _current; i < _resumed.size(); i++)
+            {
+                task_state * s = _resumed[i];
+                if (s->owner == e && !s->cancelled)
+                {
+                    s->cancelled = true;
+                    _running--;
+                }
+            }
+        }
+
+
+        void unsubscribe(entity e, bool destroy) override
+        {
+            unsubscribe(e);
+        }
+
+
+        /**
+         * @brief Returns the number of running tasks.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t running()
+        {
+            return _running;
+        }
+
+
+        /**
+         * @brief Returns the number of running tasks.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t count() override
+        {
+            return _running;
+        }
+
+
+        /**
+         * @brief Returns the maximum number of tasks running at the same time. (`Tasks`)
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t capacity() override
+        {
+            return Tasks;
+        }
+
+
+        /**
+         * @brief Virtual destructor. Destroys all the running tasks.
+         * 
+         */
+        virtual ~task_updater()
+        {
+            for (task_state * s : _ready)
+                s->handle.destroy();
+            for (task_state * s : _sleeping)
+                s->handle.destroy();
+            for (task_state * s : _waiting)
+                s->handle.destroy();
+            for (task_state * s : _frozen)
+                s->handle.destroy();
+        }
+
+    };
+
+}
+
+
+#endif
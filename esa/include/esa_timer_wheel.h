@@ -0,0 +1,773 @@
+#ifndef ESA_TIMER_WHEEL_H
+#define ESA_TIMER_WHEEL_H
+
+#include <cassert>
+
+#include "esa.h"
+
+
+namespace esa
+{
+    template<uint32_t Entities, uint32_t Timers>
+    class timer_wheel
+    {
+        /**
+         * @brief Number of bits used by each level of the wheel.
+         * 
+         */
+        static constexpr uint32_t _bits = 6;
+
+
+        /**
+         * @brief Number of slots in each level of the wheel.
+         * 
+         */
+        static constexpr uint32_t _slots = 1 << _bits;
+
+
+        /**
+         * @brief Number of levels of the wheel.
+         * 
+         */
+        static constexpr uint32_t _levels = 3;
+
+
+        /**
+         * @brief The slot holding the parked timers (expired, but waiting for their entity or their target).
+         * 
+         */
+        static constexpr uint32_t _parked = _levels * _slots;
+
+
+        /**
+         * @brief Marks the end of a list of timers.
+         * 
+         */
+        static constexpr unsigned short _nil = 0xffff;
+
+
+#ifdef ESA_ROLLBACK
+        /**
+         * @brief The rollback log of the table. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        rollback_log * _rollback = nullptr;
+
+
+        /**
+         * @brief The timers saved in the rollback log in the current epoch. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        entity_mask<Timers> _touched_timers;
+
+
+        /**
+         * @brief The entities whose first timer was saved in the rollback log in the current epoch. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        entity_mask<Entities> _touched_first;
+
+
+        /**
+         * @brief The slots whose first timer was saved in the rollback log in the current epoch. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        entity_mask<_parked + 1> _touched_heads;
+
+
+        /**
+         * @brief The rollback epoch of the masks above. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        uint32_t _touched_epoch = 0;
+
+
+        /**
+         * @brief The rollback epoch in which the counters were last saved. (only with `ESA_ROLLBACK`)
+         * 
+         */
+        uint32_t _state_saved = 0;
+#endif
+
+
+        /**
+         * @brief The current frame of the wheel.
+         * 
+         */
+        uint32_t _now;
+
+
+        /**
+         * @brief The number of pending timers.
+         * 
+         */
+        uint32_t _size;
+
+
+        /**
+         * @brief First timer of each slot, for each level, then first parked timer.
+         * 
+         */
+        unsigned short _heads [ _parked + 1 ];
+
+
+        /**
+         * @brief First timer of each entity.
+         * 
+         */
+        unsigned short _first [ Entities ];
+
+
+        /**
+         * @brief Next timer in the same slot (or in the free list).
+         * 
+         */
+        unsigned short _next [ Timers ];
+
+
+        /**
+         * @brief Previous timer in the same slot.
+         * 
+         */
+        unsigned short _prev [ Timers ];
+
+
+        /**
+         * @brief Next timer of the same entity.
+         * 
+         */
+        unsigned short _sibling [ Timers ];
+
+
+        /**
+         * @brief Slot (level * slots + slot) containing each timer.
+         * 
+         */
+        unsigned short _slot [ Timers ];
+
+
+        /**
+         * @brief Entity owning each timer.
+         * 
+         */
+        entity _entity [ Timers ];
+
+
+        /**
+         * @brief Target of each timer (an updater tag, or `DESTROY`).
+         * 
+         */
+        tag_t _target [ Timers ];
+
+
+        /**
+         * @brief Frame on which each timer expires.
+         * 
+         */
+        uint32_t _expiry [ Timers ];
+
+
+        /**
+         * @brief First free timer.
+         * 
+         */
+        unsigned short _free;
+
+
+#ifdef ESA_STATE_HASH
+        /**
+         * @brief The hash of the pending timers. (only with `ESA_STATE_HASH`)
+         * 
+         */
+        uint32_t _hash = 0;
+#endif
+
+
+#ifdef ESA_ROLLBACK
+        /**
+         * @brief Tells if changes are being recorded, and forgets what was saved in a previous epoch. (only with `ESA_ROLLBACK`)
+         * 
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool _recording()
+        {
+            if (_rollback == nullptr || !_rollback->recording())
+                return false;
+            if (_touched_epoch != _rollback->epoch())
+            {
+                _touched_timers = entity_mask<Timers>();
+                _touched_first = entity_mask<Entities>();
+                _touched_heads = entity_mask<_parked + 1>();
+                _touched_epoch = _rollback->epoch();
+            }
+            return true;
+        }
+#endif
+
+
+        /**
+         * @brief Add a timer to the hash of the pending timers when it is scheduled, or remove it when it expires
+         * or is cancelled. Does nothing unless `ESA_STATE_HASH` is defined.
+         * 
+         * @param t The timer.
+         */
+        void _hash_timer(unsigned short t)
+        {
+#ifdef ESA_STATE_HASH
+            uint32_t timer [ 2 ] = { _target[t], _expiry[t] };
+            _hash ^= hash_entry(_entity[t], timer, sizeof(timer));
+#endif
+        }
+
+
+        /**
+         * @brief Save a timer in the rollback log, before it is changed for the first time in a frame.
+         * Does nothing unless `ESA_ROLLBACK` is defined.
+         * 
+         * @param t The timer.
+         */
+        void _save_timer(unsigned short t)
+        {
+#ifdef ESA_ROLLBACK
+            if (!_recording() || _touched_timers.contains(t))
+                return;
+            _touched_timers.add(t);
+            _rollback->record(rollback_kind::TIMER, rollback_timer { t, _next[t], _prev[t], _sibling[t], _slot[t], _entity[t], _target[t], _expiry[t] });
+#endif
+        }
+
+
+        /**
+         * @brief Save the first timer of an entity in the rollback log, before it is changed for the first time in a frame.
+         * Does nothing unless `ESA_ROLLBACK` is defined.
+         * 
+         * @param e The ID of the entity.
+         */
+        void _save_first(entity e)
+        {
+#ifdef ESA_ROLLBACK
+            if (!_recording() || _touched_first.contains(e))
+                return;
+            _touched_first.add(e);
+            _rollback->record(rollback_kind::TIMER_FIRST, rollback_link { e, _first[e] });
+#endif
+        }
+
+
+        /**
+         * @brief Save the first timer of a slot in the rollback log, before it is changed for the first time in a frame.
+         * Does nothing unless `ESA_ROLLBACK` is defined.
+         * 
+         * @param s The slot.
+         */
+        void _save_head(uint32_t s)
+        {
+#ifdef ESA_ROLLBACK
+            if (!_recording() || _touched_heads.contains(s))
+                return;
+            _touched_heads.add(s);
+            _rollback->record(rollback_kind::TIMER_HEAD, rollback_link { (unsigned short) s, _heads[s] });
+#endif
+        }
+
+
+        /**
+         * @brief Save the counters in the rollback log, before they are changed for the first time in a frame.
+         * Does nothing unless `ESA_ROLLBACK` is defined.
+         * 
+         */
+        void _save_state()
+        {
+#ifdef ESA_ROLLBACK
+            if (_rollback != nullptr && _rollback->first(_state_saved))
+                _rollback->record(rollback_kind::TIMER_STATE, rollback_wheel { _now, _size, _free, hash() });
+#endif
+        }
+
+
+        /**
+         * @brief Returns the size of the state of the wheel, which is contiguous, starting at `_now`
+         * (without the padding at the end of the wheel, which depends on the platform).
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t _state_bytes()
+        {
+#ifdef ESA_STATE_HASH
+            return uint32_t(reinterpret_cast<unsigned char *>(&_hash + 1) - reinterpret_cast<unsigned char *>(&_now));
+#else
+            return uint32_t(reinterpret_cast<unsigned char *>(&_free + 1) - reinterpret_cast<unsigned char *>(&_now));
+#endif
+        }
+
+
+        /**
+         * @brief Insert a timer in the slot matching its expiry.
+         * 
+         * @param t The timer.
+         */
+        void _place(unsigned short t)
+        {
+            uint32_t delta = _expiry[t] - _now;
+            uint32_t s;
+            if (delta < _slots)
+                s = _expiry[t] & (_slots - 1);
+            else if (delta < (1 << (2 * _bits)))
+                s = _slots + ((_expiry[t] >> _bits) & (_slots - 1));
+            else if (delta < (1 << (3 * _bits)))
+                s = 2 * _slots + ((_expiry[t] >> (2 * _bits)) & (_slots - 1));
+            else
+                s = 2 * _slots + (((_now + (1 << (3 * _bits)) - 1) >> (2 * _bits)) & (_slots - 1));
+            _link(t, s);
+        }
+
+
+        /**
+         * @brief Insert a timer at the beginning of a slot.
+         * 
+         * @param t The timer.
+         * @param s The slot.
+         */
+        void _link(unsigned short t, uint32_t s)
+        {
+            _save_timer(t);
+            _save_head(s);
+            if (_heads[s] != _nil)
+                _save_timer(_heads[s]);
+            _slot[t] = s;
+            _prev[t] = _nil;
+            _next[t] = _heads[s];
+            if (_heads[s] != _nil)
+                _prev[_heads[s]] = t;
+            _heads[s] = t;
+        }
+
+
+        /**
+         * @brief Remove a timer from its slot.
+         * 
+         * @param t The timer.
+         */
+        void _unlink(unsigned short t)
+        {
+            if (_prev[t] != _nil)
+            {
+                _save_timer(_prev[t]);
+                _next[_prev[t]] = _next[t];
+            }
+            else
+            {
+                _save_head(_slot[t]);
+                _heads[_slot[t]] = _next[t];
+            }
+            if (_next[t] != _nil)
+            {
+                _save_timer(_next[t]);
+                _prev[_next[t]] = _prev[t];
+            }
+        }
+
+
+        /**
+         * @brief Remove a timer from the list of its entity.
+         * 
+         * @param t The timer.
+         */
+        void _detach(unsigned short t)
+        {
+            entity e = _entity[t];
+            if (_first[e] == t)
+            {
+                _save_first(e);
+                _first[e] = _sibling[t];
+                return;
+            }
+            for (unsigned short s = _first[e]; s != _nil; s = _sibling[s])
+            {
+                if (_sibling[s] == t)
+                {
+                    _save_timer(s);
+                    _sibling[s] = _sibling[t];
+                    return;
+                }
+            }
+        }
+
+
+        /**
+         * @brief Give a timer back to the free list.
+         * 
+         * @param t The timer.
+         */
+        void _release(unsigned short t)
+        {
+            _save_timer(t);
+            _save_state();
+            _hash_timer(t);
+            _next[t] = _free;
+            _free = t;
+            _size--;
+        }
+
+
+        /**
+         * @brief Move all the timers of a slot to the lower levels.
+         * 
+         * @param s The slot.
+         */
+        void _cascade(uint32_t s)
+        {
+            unsigned short t = _heads[s];
+            _save_head(s);
+            _heads[s] = _nil;
+            while (t != _nil)
+            {
+                unsigned short next = _next[t];
+                _place(t);
+                t = next;
+            }
+        }
+
+
+        /**
+         * @brief Move a parked timer back to the wheel, to expire at the next call to `tick`.
+         * 
+         * @param t The timer.
+         */
+        void _resume(unsigned short t)
+        {
+            _unlink(t);
+            _save_timer(t);
+            _hash_timer(t);
+            _expiry[t] = _now + 1;
+            _hash_timer(t);
+            _place(t);
+        }
+
+
+        public:
+
+
+        /**
+         * @brief Target of the timers that destroy their entity.
+         * 
+         */
+        static constexpr tag_t DESTROY = 0xffff;
+
+
+        /**
+         * @brief Constructor.
+         * 
+         */
+        timer_wheel()
+        {
+            static_assert(Timers < _nil, "ESA ERROR: too many timers for a timer wheel!");
+            _now = 0;
+            _size = 0;
+            for (uint32_t s = 0; s <= _parked; s++)
+                _heads[s] = _nil;
+            for (uint32_t e = 0; e < Entities; e++)
+                _first[e] = _nil;
+            for (uint32_t t = 0; t < Timers; t++)
+                _next[t] = t + 1 < Timers ? t + 1 : _nil;
+            _free = 0;
+        }
+
+
+        /**
+         * @brief Start a timer for an entity.
+         * 
+         * @param e The ID of the entity.
+         * @param target The target of the timer (an updater tag, or `DESTROY`).
+         * @param frames The number of calls to `tick` after which the timer expires. (at least `1`)
+         * @return true if the timer was started, false if all the `Timers` timers are pending.
+         */
+        bool schedule(entity e, tag_t target, uint32_t frames)
+        {
+            assert(e < Entities && "ESA ERROR: entity index is out of range!");
+            if (_free == _nil)
+                return false;
+            unsigned short t = _free;
+            _save_state();
+            _save_timer(t);
+            _save_first(e);
+            _free = _next[t];
+            _size++;
+            _entity[t] = e;
+            _target[t] = target;
+            _expiry[t] = _now + (frames > 0 ? frames : 1);
+            _sibling[t] = _first[e];
+            _first[e] = t;
+            _hash_timer(t);
+            _place(t);
+            return true;
+        }
+
+
+        /**
+         * @brief Cancel all the timers of an entity.
+         * 
+         * @param e The ID of the entity.
+         */
+        void cancel(entity e)
+        {
+            unsigned short t = _first[e];
+            _save_first(e);
+            _first[e] = _nil;
+            while (t != _nil)
+            {
+                unsigned short next = _sibling[t];
+                _unlink(t);
+                _release(t);
+                t = next;
+            }
+        }
+
+
+        /**
+         * @brief Cancel the timers of an entity with a certain target.
+         * 
+         * @param e The ID of the entity.
+         * @param target The target of the timers.
+         */
+        void cancel(entity e, tag_t target)
+        {
+            unsigned short t = _first[e];
+            while (t != _nil)
+            {
+                unsigned short next = _sibling[t];
+                if (_target[t] == target)
+                {
+                    _detach(t);
+                    _unlink(t);
+                    _release(t);
+                }
+                t = next;
+            }
+        }
+
+
+        /**
+         * @brief Tells if an entity has pending timers.
+         * 
+         * @param e The ID of the entity.
+         * @return true 
+         * @return false 
+         */
+        [[nodiscard]] bool pending(entity e)
+        {
+            return _first[e] != _nil;
+        }
+
+
+        /**
+         * @brief Make the parked timers of an entity expire at the next call to `tick`.
+         * 
+         * @param e The ID of the entity.
+         */
+        void resume_entity(entity e)
+        {
+            for (unsigned short t = _first[e]; t != _nil; t = _sibling[t])
+            {
+                if (_slot[t] == _parked)
+                    _resume(t);
+            }
+        }
+
+
+        /**
+         * @brief Make the parked timers with a certain target expire at the next call to `tick`.
+         * 
+         * @param target The target of the timers.
+         */
+        void resume_target(tag_t target)
+        {
+            unsigned short t = _heads[_parked];
+            while (t != _nil)
+            {
+                unsigned short next = _next[t];
+                if (_target[t] == target)
+                    _resume(t);
+                t = next;
+            }
+        }
+
+
+        /**
+         * @brief Returns the number of parked timers (expired, but waiting for their entity to be enabled
+         * or their target to be activated).
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t parked()
+        {
+            uint32_t n = 0;
+            for (unsigned short t = _heads[_parked]; t != _nil; t = _next[t])
+                n++;
+            return n;
+        }
+
+
+        /**
+         * @brief Advance the wheel by one frame, and call `f(e, target)` for each expired timer.
+         * The cost depends on the number of expired timers, not on the number of pending ones.
+         * Timers can be scheduled again from inside `f`. An expired timer for which `ready(e, target)`
+         * is false is parked instead: it stays pending, but is not checked again until `resume_entity`
+         * or `resume_target` is called.
+         * 
+         * @tparam Ready The type of the function telling if a timer can be delivered.
+         * @tparam Function The type of the function to call.
+         * @param ready The function telling if a timer can be delivered.
+         * @param f The function to call.
+         */
+        template<typename Ready, typename Function>
+        void tick(Ready && ready, Function && f)
+        {
+            _save_state();
+            _now++;
+            if ((_now & ((1 << (2 * _bits)) - 1)) == 0)
+                _cascade(2 * _slots + ((_now >> (2 * _bits)) & (_slots - 1)));
+            if ((_now & (_slots - 1)) == 0)
+                _cascade(_slots + ((_now >> _bits) & (_slots - 1)));
+            uint32_t s = _now & (_slots - 1);
+            while (_heads[s] != _nil)
+            {
+                unsigned short t = _heads[s];
+                entity e = _entity[t];
+                tag_t target = _target[t];
+                _unlink(t);
+                if (!ready(e, target))
+                {
+                    _link(t, _parked);
+                    continue;
+                }
+                _detach(t);
+                _release(t);
+                f(e, target);
+            }
+        }
+
+
+        /**
+         * @brief Returns the number of pending timers.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t size()
+        {
+            return _size;
+        }
+
+
+        /**
+         * @brief Returns the number of calls to `tick` so far.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t now()
+        {
+            return _now;
+        }
+
+
+        /**
+         * @brief Returns the hash of the pending timers (their entities, targets and expiry frames),
+         * or `0` unless `ESA_STATE_HASH` is defined.
+         * 
+         * @return uint32_t 
+         */
+        [[nodiscard]] uint32_t hash()
+        {
+#ifdef ESA_STATE_HASH
+            return _hash;
+#else
+            return 0;
+#endif
+        }
+
+
+        /**
+         * @brief Write the timers to a snapshot.
+         * 
+         * @param w The snapshot writer.
+         */
+        void save(snapshot_writer & w)
+        {
+            w.write(&_now, _state_bytes());
+        }
+
+
+        /**
+         * @brief Replace the timers with the ones read from a snapshot.
+         * 
+         * @param r The snapshot reader.
+         */
+        void load(snapshot_reader & r)
+        {
+            r.read(&_now, _state_bytes());
+        }
+
+
+        /**
+         * @brief Record the changes to the timers in a rollback log when `ESA_ROLLBACK` is defined.
+         * Called by the table when the timers are allocated or restored.
+         * 
+         * @param log The rollback log.
+         */
+        void track(rollback_log * log)
+        {
+#ifdef ESA_ROLLBACK
+            _rollback = log;
+            _touched_epoch = 0;
+            _state_saved = 0;
+#endif
+        }
+
+
+        /**
+         * @brief Restore a timer, the first timer of an entity or of a slot, or the counters, saved in a rollback log.
+         * 
+         * @param kind The kind of record.
+         * @param data The bytes of the record.
+         */
+        void rewind(rollback_kind kind, const void * data)
+        {
+            if (kind == rollback_kind::TIMER)
+            {
+                rollback_timer r;
+                __builtin_memcpy(&r, data, sizeof(r));
+                _next[r.timer] = r.next;
+                _prev[r.timer] = r.prev;
+                _sibling[r.timer] = r.sibling;
+                _slot[r.timer] = r.slot;
+                _entity[r.timer] = r.e;
+                _target[r.timer] = r.target;
+                _expiry[r.timer] = r.expiry;
+            }
+            else if (kind == rollback_kind::TIMER_FIRST || kind == rollback_kind::TIMER_HEAD)
+            {
+                rollback_link r;
+                __builtin_memcpy(&r, data, sizeof(r));
+                if (kind == rollback_kind::TIMER_FIRST)
+                    _first[r.position] = r.timer;
+                else
+                    _heads[r.position] = r.timer;
+            }
+            else if (kind == rollback_kind::TIMER_STATE)
+            {
+                rollback_wheel r;
+                __builtin_memcpy(&r, data, sizeof(r));
+                _now = r.now;
+                _size = r.size;
+                _free = r.free;
+#ifdef ESA_STATE_HASH
+                _hash = r.hash;
+#endif
+            }
+        }
+
+    };
+}
+
+#endif
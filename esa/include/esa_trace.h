@@ -0,0 +1,480 @@
+#ifndef ESA_TRACE_H
+#define ESA_TRACE_H
+
+#include <cassert>
+
+#include "esa.h"
+
+
+/**
+ * @brief The number of events kept by the trace buffer of each table (only used with `ESA_TRACE`).
+ * 
+ */
+#ifndef ESA_TRACE_EVENTS
+    #define ESA_TRACE_EVENTS 1024
+#endif
+
+
+/**
+ * @brief Record a begin event, and the matching end event when the current scope ends.
+ * Expands to nothing unless `ESA_TRACE` is defined.
+ * 
+ */
+#ifdef ESA_TRACE
+    #define ESA_TRACE_SCOPE(buffer, kind, id) esa::trace_scope<ESA_TRACE_EVENTS> _esa_trace_scope(buffer, kind, id)
+    #define ESA_TRACE_COUNT(buffer, kind) buffer.count(kind)
+#else
+    #define ESA_TRACE_SCOPE(buffer, kind, id)
+    #define ESA_TRACE_COUNT(buffer, kind)
+#endif
+
+
+namespace esa
+{
+    /**
+     * @brief What a trace event refers to.
+     * 
+     */
+    enum class trace_kind : unsigned char
+    {
+        FRAME,
+        UPDATER,
+        QUERY,
+        APPLY,
+        DESTRUCTION,
+        CREATES,
+        DESTROYS
+    };
+
+
+    /**
+     * @brief A trace event. (8 bytes)
+     * 
+     */
+    struct trace_event
+    {
+        /**
+         * @brief Tag used for queries and apply operations based on a function.
+         * 
+         */
+        static constexpr tag_t NO_TAG = 0xffff;
+
+
+        /**
+         * @brief Begin event.
+         * 
+         */
+        static constexpr unsigned char BEGIN = 'B';
+
+
+        /**
+         * @brief End event.
+         * 
+         */
+        static constexpr unsigned char END = 'E';
+
+
+        /**
+         * @brief Counter event. (`id` is the value of the counter)
+         * 
+         */
+        static constexpr unsigned char COUNTER = 'C';
+
+
+        /**
+         * @brief The time of the event, in clock ticks.
+         * 
+         */
+        uint32_t time;
+
+
+        /**
+         * @brief The tag of the updater, query or apply object, or the value of a counter.
+         * 
+         */
+        tag_t id;
+
+
+        /**
+         * @brief What the event refers to. (a `trace_kind`)
+         * 
+         */
+        unsigned char kind;
+
+
+        /**
+         * @brief `BEGIN`, `END` or `COUNTER`.
+         * 
+         */
+        unsigned char type;
+    };
+
+
+    /**
+     * @brief Header of a trace buffer. It is stored right before the events,
+     * so that a trace can be found in a memory dump by looking for `magic`.
+     * 
+     */
+    struct trace_header
+    {
+        /**
+         * @brief The value of `magic`: the characters "ESAT" in a little-endian word.
+         * 
+         */
+        static constexpr uint32_t MAGIC = 0x54415345;
+
+
+        /**
+         * @brief The version of the trace format.
+         * 
+         */
+        static constexpr uint32_t VERSION = 1;
+
+
+        /**
+         * @brief `MAGIC`.
+         * 
+         */
+        uint32_t magic;
+
+
+        /**
+         * @brief `VERSION`.
+         * 
+         */
+        uint32_t version;
+
+
+        /**
+         * @brief The maximum number of events (`Events`).
+         * 
+         */
+        uint32_t capacity;
+
+
+        /**
+         * @brief Position of the next event in the ring buffer.
+         * 
+         */
+        uint32_t next;
+
+
+        /**
+         * @brief The number of events recorded.
+         * 
+         */
+        uint32_t size;
+
+
+        /**
+         * @brief The number of clock ticks in a millisecond.
+         * 
+         */
+        uint32_t ticks_per_ms;
+
+
+        /**
+         * @brief The number of events overwritten.
+         * 
+         */
+        uint32_t dropped;
+
+
+        /**
+         * @brief Unused, always `0`.
+         * 
+         */
+        uint32_t reserved;
+    };
+
+
+    static_assert(sizeof(trace_event) == 8 && sizeof(trace_header) == 32, "ESA ERROR: unexpected trace layout!");
+
+
+    template<uint32_t Events>
+    class trace_buffer
+    {
+        /**
+         * @brief The header. (must be the first member)
+         * 
+         */
+        trace_header _header;
+
+
+        /**
+         * @brief Ring buffer of the last `Events` events.
+         * 
+         */
+        trace_event _events [ Events ];
+
+
+        /**
+         * @brief The clock used to timestamp the events.
+         * 
+         */
+        clock_fn _clock;
+
+
+        /**
+         * @brief Entities created since the last frame ended.
+         * 
+         */
+        uint32_t _creates;
+
+
+        /**
+         * @brief Entities destroyed since the last frame ended.
+         * 
+         */
+        uint32_t _destroys;
+
+
+        /**
+         * @brief Set to false to stop recording.
+         * 
+         */
+        bool _recording;
+
+
+        /**
+         * @brief Append an event to the ring buffer.
+         * 
+         */
+        void _push(trace_kind kind, unsigned char type, tag_t id, uint32_t time)
+        {
+            trace_event & ev = _events[_header.next];
+            ev.time = time;
+            ev.id = id;
+            ev.kind = (unsigned char) kind;
+            ev.type = type;
+            _header.next = _header.next + 1 == Events ? 0 : _header.next + 1;
+            if (_header.size < Events)
+                _header.size++;
+            else
+                _header.dropped++;
+        }
+
+
+        public:
+
+
+        /**
+         * @brief Constructor. No event is recorded until a clock is set.
+         * 
+         */
+        trace_buffer()
+        {
+            _header.magic = trace_header::MAGIC;
+            _header.version = trace_header::VERSION;
+            _header.capacity = Events;
+            _header.ticks_per_ms = 1000;
+            _header.reserved = 0;
+            _clock = nullptr;
+            _recording = true;
+            clear();
+        }
+
+
+        /**
+         * @brief Set the clock used to timestamp the events, and discard the events recorded so far.
+         * 
+         * @param clock A function returning the current time.
+         * @param ticks_per_ms The number of clock ticks in a millisecond (e.g. `16777` for GBA cycles, `1000000` for nanoseconds).
+         */
+        void set_clock(clock_fn clock, uint32_t ticks_per_ms)
+        {
+            _clock = clock;
+            _header.ticks_per_ms = ticks_per_ms;
+            clear();
+        }
+
+
+        /**
+         * @brief Start or stop recording. (e.g. stop right after a hitch, to keep the frames that caused it)
+         * 
+         */
+        void set_recording(bool recording)
+        {
+            _recording = recording;
+        }
+
+
+        /**
+         * @brief Tells if events are being recorded.
+         * 
+         */
+        [[nodiscard]] bool recording()
+        {
+            return _recording && _clock != nullptr;
+        }
+
+
+        /**
+         * @brief Discard all the events.
+         * 
+         */
+        void clear()
+        {
+            _header.next = 0;
+            _header.size = 0;
+            _header.dropped = 0;
+            _creates = 0;
+            _destroys = 0;
+        }
+
+
+        /**
+         * @brief Record a begin event.
+         * 
+         * @param kind What the event refers to.
+         * @param id The tag of the updater, query or apply object.
+         */
+        void begin(trace_kind kind, tag_t id)
+        {
+            if (recording())
+                _push(kind, trace_event::BEGIN, id, _clock());
+        }
+
+
+        /**
+         * @brief Record an end event. At the end of a frame, the numbers of entities
+         * created and destroyed during the frame are recorded as counters.
+         * 
+         * @param kind What the event refers to.
+         * @param id The tag of the updater, query or apply object.
+         */
+        void end(trace_kind kind, tag_t id)
+        {
+            if (!recording())
+                return;
+            uint32_t time = _clock();
+            if (kind == trace_kind::FRAME)
+            {
+                if (_creates != 0)
+                    _push(trace_kind::CREATES, trace_event::COUNTER, _creates > 0xffff ? 0xffff : _creates, time);
+                if (_destroys != 0)
+                    _push(trace_kind::DESTROYS, trace_event::COUNTER, _destroys > 0xffff ? 0xffff : _destroys, time);
+                _creates = 0;
+                _destroys = 0;
+            }
+            _push(kind, trace_event::END, id, time);
+        }
+
+
+        /**
+         * @brief Count a structural operation. (`CREATES` or `DESTROYS`)
+         * 
+         */
+        void count(trace_kind kind)
+        {
+            if (kind == trace_kind::CREATES)
+                _creates++;
+            else
+                _destroys++;
+        }
+
+
+        /**
+         * @brief Returns the number of events recorded. (at most `Events`)
+         * 
+         */
+        [[nodiscard]] uint32_t size()
+        {
+            return _header.size;
+        }
+
+
+        /**
+         * @brief Returns the number of events overwritten since the last `clear()`.
+         * 
+         */
+        [[nodiscard]] uint32_t dropped()
+        {
+            return _header.dropped;
+        }
+
+
+        /**
+         * @brief Returns an event, from the oldest (`0`) to the most recent (`size() - 1`).
+         * 
+         */
+        [[nodiscard]] trace_event & operator[](uint32_t i)
+        {
+            assert(i < _header.size && "ESA ERROR: trace event index out of range!");
+            uint32_t first = _header.size < Events ? 0 : _header.next;
+            uint32_t j = first + i;
+            return _events[j >= Events ? j - Events : j];
+        }
+
+
+        /**
+         * @brief Returns the raw trace (header followed by the events), to be saved
+         * or dumped and converted with `esa_trace2json`.
+         * 
+         */
+        [[nodiscard]] const void * data()
+        {
+            return &_header;
+        }
+
+
+        /**
+         * @brief Returns the size of the raw trace, in bytes.
+         * 
+         */
+        [[nodiscard]] static constexpr uint32_t bytes()
+        {
+            return sizeof(trace_header) + Events * sizeof(trace_event);
+        }
+    };
+
+
+    template<uint32_t Events>
+    class trace_scope
+    {
+        /**
+         * @brief The trace buffer.
+         * 
+         */
+        trace_buffer<Events> & _buffer;
+
+
+        /**
+         * @brief What the scope refers to.
+         * 
+         */
+        trace_kind _kind;
+
+
+        /**
+         * @brief The tag of the updater, query or apply object.
+         * 
+         */
+        tag_t _id;
+
+
+        public:
+
+
+        /**
+         * @brief Constructor: record the begin event.
+         * 
+         */
+        trace_scope(trace_buffer<Events> & buffer, trace_kind kind, tag_t id)
+            : _buffer(buffer), _kind(kind), _id(id)
+        {
+            _buffer.begin(kind, id);
+        }
+
+        /**
+         * @brief Destructor: record the end event.
+         * 
+         */
+        ~trace_scope()
+        {
+            _buffer.end(_kind, _id);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef ESA_TRACE_JSON_H
+#define ESA_TRACE_JSON_H
+
+#include <cstdio>
+#include <cstring>
+
+#include "esa.h"
+
+
+/**
+ * @brief Export of trace buffers as Chrome trace-event JSON, which can be opened with
+ * `chrome://tracing` or https://ui.perfetto.dev. Host builds only (uses the C standard library).
+ * 
+ */
+namespace esa
+{
+    /**
+     * @brief A function returning the name to display for an updater, query or apply object,
+     * or `nullptr` to use the default name (e.g. "updater 3").
+     * 
+     */
+    using trace_name_fn = const char * (*)(trace_kind kind, tag_t id);
+
+
+    /**
+     * @brief Write a raw trace (as returned by `trace_buffer::data()`, or read from a memory dump)
+     * as Chrome trace-event JSON.
+     * 
+     * @param out The output file.
+     * @param data The raw trace: a `trace_header` followed by the events.
+     * @param bytes The number of bytes available at `data`.
+     * @param name Optional function giving the names of updaters, queries and apply objects.
+     * @return true The trace was written.
+     * @return false The data is not a valid trace.
+     */
+    inline bool write_trace_json(std::FILE * out, const void * data, unsigned long bytes, trace_name_fn name = nullptr)
+    {
+        const unsigned char * raw = static_cast<const unsigned char *>(data);
+        trace_header header;
+        if (bytes < sizeof(trace_header))
+            return false;
+        std::memcpy(&header, raw, sizeof(trace_header));
+        if (header.magic != trace_header::MAGIC || header.version != trace_header::VERSION
+            || header.size > header.capacity || header.next >= header.capacity || header.ticks_per_ms == 0
+            || bytes < sizeof(trace_header) + (unsigned long) header.capacity * sizeof(trace_event))
+            return false;
+
+        // open events, to skip the end events whose begin event was overwritten
+        // and to close the events still open when the trace was taken
+        constexpr uint32_t depth = 32;
+        trace_event open [ depth ];
+        uint32_t opened = 0;
+
+        unsigned long long ticks = 0;
+        uint32_t previous = 0;
+        uint32_t first = header.size < header.capacity ? 0 : header.next;
+        bool comma = false;
+
+        auto label = [&](const trace_event & ev, char * buffer, unsigned long size) -> const char *
+        {
+            trace_kind kind = trace_kind(ev.kind);
+            bool tagged = kind == trace_kind::UPDATER || kind == trace_kind::QUERY || kind == trace_kind::APPLY;
+            const char * n = name != nullptr && tagged && ev.id != trace_event::NO_TAG ? name(kind, ev.id) : nullptr;
+            if (n != nullptr)
+                return n;
+            switch (kind)
+            {
+                case trace_kind::FRAME:
+                    return "frame";
+                case trace_kind::DESTRUCTION:
+                    return "destruction";
+                case trace_kind::CREATES:
+                    return "entities created";
+                case trace_kind::DESTROYS:
+                    return "entities destroyed";
+                case trace_kind::UPDATER:
+                    std::snprintf(buffer, size, "updater %u", ev.id);
+                    return buffer;
+                case trace_kind::QUERY:
+                    if (ev.id == trace_event::NO_TAG)
+                        return "function query";
+                    std::snprintf(buffer, size, "query %u", ev.id);
+                    return buffer;
+                case trace_kind::APPLY:
+                    if (ev.id == trace_event::NO_TAG)
+                        return "function apply";
+                    std::snprintf(buffer, size, "apply %u", ev.id);
+                    return buffer;
+            }
+            return "unknown";
+        };
+
+        auto emit = [&](const trace_event & ev, unsigned char type, unsigned long long at)
+        {
+            char buffer[32];
+            double us = double(at) * 1000.0 / header.ticks_per_ms;
+            std::fprintf(out, "%s\n    { \"name\": \"%s\", \"cat\": \"esa\", \"ph\": \"%c\", \"ts\": %.3f, \"pid\": 1, \"tid\": 1",
+                comma ? "," : "", label(ev, buffer, sizeof(buffer)), type, us);
+            if (type == trace_event::COUNTER)
+                std::fprintf(out, ", \"args\": { \"count\": %u }", ev.id);
+            std::fprintf(out, " }");
+            comma = true;
+        };
+
+        std::fprintf(out, "{\n  \"displayTimeUnit\": \"ms\",\n  \"otherData\": { \"dropped\": %u },\n  \"traceEvents\": [",
+            header.dropped);
+        for (uint32_t i = 0; i < header.size; i++)
+        {
+            uint32_t j = first + i;
+            trace_event ev;
+            std::memcpy(&ev, raw + sizeof(trace_header) + (j >= header.capacity ? j - header.capacity : j) * sizeof(trace_event),
+                sizeof(trace_event));
+            if (i != 0)
+                ticks += uint32_t(ev.time - previous); // the clock may wrap around
+            previous = ev.time;
+            if (ev.kind > (unsigned char) trace_kind::DESTROYS)
+                continue;
+            if (ev.type == trace_event::BEGIN)
+            {
+                if (opened < depth)
+                    open[opened] = ev;
+                opened++;
+                emit(ev, ev.type, ticks);
+            }
+            else if (ev.type == trace_event::END)
+            {
+                if (opened == 0)
+                    continue;
+                opened--;
+                emit(ev, ev.type, ticks);
+            }
+            else if (ev.type == trace_event::COUNTER)
+                emit(ev, ev.type, ticks);
+        }
+        while (opened > 0)
+        {
+            opened--;
+            if (opened < depth)
+                emit(open[opened], trace_event::END, ticks);
+        }
+        std::fprintf(out, "\n  ]\n}\n");
+        return true;
+    }
+
+
+    /**
+     * @brief Write the events of a trace buffer as Chrome trace-event JSON.
+     * 
+     * @param out The output file.
+     * @param trace The trace buffer. (e.g. `table.trace()`)
+     * @param name Optional function giving the names of updaters, queries and apply objects.
+     */
+    template<uint32_t Events>
+    void write_trace_json(std::FILE * out, trace_buffer<Events> & trace, trace_name_fn name = nullptr)
+    {
+        write_trace_json(out, trace.data(), trace.bytes(), name);
+    }
+}
+
+#endif
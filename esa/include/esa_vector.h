@@ -39,6 +39,16 @@ namespace esa
         }
 
 
+        /**
+         * @brief Constructor keeping the size and the elements already in memory (see `reattach_t`).
+         * 
+         */
+        vector(reattach_t)
+        {
+
+        }
+
+
         /**
          * @brief Tells if the vector is full.
          * 
@@ -151,6 +161,19 @@ namespace esa
         }
 
 
+        /**
+         * @brief Change the number of elements. The elements added are not initialized (e.g. they are copied over
+         * right after, from a snapshot).
+         * 
+         * @param size The number of elements.
+         */
+        void resize(uint32_t size)
+        {
+            assert(size <= MaxSize && "ESA ERROR: vector size exceeded!");
+            _size = size;
+        }
+
+
         /**
          * @brief Beginning of vector (iterator).
          * 
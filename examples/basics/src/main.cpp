@@ -103,7 +103,7 @@ class u_movement : public entity_updater
 // implements a query that finds all the entities moving towards the right
 bool find_entities_moving_right(entity_table & table, entity e)
 {
-    velocity & vel = table.get<velocity, VELOCITY>(e);
+    const velocity & vel = table.read<velocity, VELOCITY>(e);
     if (vel.x > 0)
         return true;
     return false;
@@ -53,8 +53,6 @@ namespace cs
             ANIM_FIRST_SZ = 2,
             ANIM_LAST = 4,
             ANIM_LAST_SZ = 2,
-            ANIM_TIMER = 6,
-            ANIM_TIMER_SZ = 4,
 
             // updaters
             MOVEMENT = 0,
@@ -10,6 +10,8 @@ namespace cs
     /**
      * @brief This updater takes care of udpating
      * the animation for entities with ANIM_SET component.
+     * It is woken up by the table's timers every 11 frames
+     * (10 frames of countdown, plus the frame of the change).
      * 
      */
     class u_animation : public esa::entity_updater<64>
@@ -22,6 +24,7 @@ namespace cs
         bool select(entity e) override;
         void init() override;
         void update() override;
+        void expired(entity e) override;
     };
 }
 
@@ -59,5 +59,7 @@ void cs::entities::flashing_square(entity_table& table)
     anim.set<tags::ANIM_CURR, tags::ANIM_CURR_SZ>(0);
     anim.set<tags::ANIM_FIRST, tags::ANIM_FIRST_SZ>(0);
     anim.set<tags::ANIM_LAST, tags::ANIM_LAST_SZ>(2);
-    anim.set<tags::ANIM_TIMER, tags::ANIM_TIMER_SZ>(10);
+
+    // the animation updater will be woken up in 11 frames (10 frames of countdown, plus the frame of the change)
+    table.schedule<tags::ANIMATION>(e, 11);
 }
\ No newline at end of file
@@ -3,7 +3,7 @@
 
 bool cs::functions::find_red_squares(entity_table& table, entity e)
 {
-    color & col = table.get<color, tags::COLOR>(e);
+    const color & col = table.read<color, tags::COLOR>(e);
     if (col == color::RED)
         return true;
     return false;
@@ -12,8 +12,8 @@ bool cs::functions::find_red_squares(entity_table& table, entity e)
 
 bool cs::functions::find_yellow_squares_within(entity_table& table, entity e, x_boundaries& boundaries)
 {
-    color & col = table.get<color, tags::COLOR>(e);
-    position & pos = table.get<position, tags::POSITION>(e);
+    const color & col = table.read<color, tags::COLOR>(e);
+    const position & pos = table.read<position, tags::POSITION>(e);
 
     if (col == color::YELLOW && pos.x < boundaries.max && pos.x > boundaries.min)
         return true;
@@ -24,7 +24,7 @@ bool cs::functions::find_yellow_squares_within(entity_table& table, entity e, x_
 
 bool cs::functions::destroy_first_blue_square(entity_table& table, entity e)
 {
-    color & col = table.get<color, tags::COLOR>(e);
+    const color & col = table.read<color, tags::COLOR>(e);
     if (col == color::BLUE)
     {
         table.get<sprite, tags::SPRITE>(e).reset(); // deallocate sprite resources
@@ -37,7 +37,7 @@ bool cs::functions::destroy_first_blue_square(entity_table& table, entity e)
 
 bool cs::functions::incr_blue_squares_velocity(entity_table& table, entity e)
 {
-    color & col = table.get<color, tags::COLOR>(e);
+    const color & col = table.read<color, tags::COLOR>(e);
 
     if (col == color::BLUE)
     {
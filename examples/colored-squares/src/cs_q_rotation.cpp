@@ -19,7 +19,7 @@ void cs::q_rotation::init()
 
 bool cs::q_rotation::where(entity e)
 {
-    if (table.get<int, tags::ANGLE>(e) > 180)
+    if (table.read<int, tags::ANGLE>(e) > 180)
         return true;
     return false;
 }
\ No newline at end of file
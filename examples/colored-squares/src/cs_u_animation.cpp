@@ -23,36 +23,34 @@ void cs::u_animation::init()
 
 void cs::u_animation::update()
 {
-    for (entity e : this->subscribed())
-    {
-        // get the components for the entity
-        sprite & spr    = table.get<sprite, tags::SPRITE>(e);
-        uint_set & anim = table.get<uint_set, tags::ANIM_SET>(e);
-
-        // get the values contained in the uint_set
-        uint32_t curr = anim.get<tags::ANIM_CURR, tags::ANIM_CURR_SZ>();
-        uint32_t first = anim.get<tags::ANIM_FIRST, tags::ANIM_FIRST_SZ>();
-        uint32_t last = anim.get<tags::ANIM_LAST, tags::ANIM_LAST_SZ>();
-        uint32_t timer = anim.get<tags::ANIM_TIMER, tags::ANIM_TIMER_SZ>();
-
-        // update animation timer and current animation index
-        if (timer > 0)
-            timer--;
-        else
-        {
-            if (curr < last)
-                curr++;
-            else
-                curr = first;
-            timer = 10;
-        }
-
-        // apply the correct animation to the sprite
-        if (timer == 0 && spr.has_value())
-            spr.value().set_tiles(bn::sprite_items::squares.tiles_item(), curr);
-        
-        // update the animation information in the uintn_set compoennt
-        anim.set<tags::ANIM_CURR, tags::ANIM_CURR_SZ>(curr);
-        anim.set<tags::ANIM_TIMER, tags::ANIM_TIMER_SZ>(timer);
-    }
+    // nothing to do at every frame: the animation is advanced
+    // only when the entity's timer expires (see `expired`)
+}
+
+void cs::u_animation::expired(entity e)
+{
+    // get the components for the entity
+    sprite & spr    = table.get<sprite, tags::SPRITE>(e);
+    uint_set & anim = table.get<uint_set, tags::ANIM_SET>(e);
+
+    // get the values contained in the uint_set
+    uint32_t curr = anim.get<tags::ANIM_CURR, tags::ANIM_CURR_SZ>();
+    uint32_t first = anim.get<tags::ANIM_FIRST, tags::ANIM_FIRST_SZ>();
+    uint32_t last = anim.get<tags::ANIM_LAST, tags::ANIM_LAST_SZ>();
+
+    // update the current animation index
+    if (curr < last)
+        curr++;
+    else
+        curr = first;
+
+    // apply the correct animation to the sprite
+    if (spr.has_value())
+        spr.value().set_tiles(bn::sprite_items::squares.tiles_item(), curr);
+    
+    // update the animation information in the uintn_set compoennt
+    anim.set<tags::ANIM_CURR, tags::ANIM_CURR_SZ>(curr);
+
+    // wake up again in 11 frames
+    table.schedule<tags::ANIMATION>(e, 11);
 }
\ No newline at end of file
@@ -37,7 +37,7 @@ void cs::u_visibility::update()
             }
             else
             {
-                position & pos = table.get<position, tags::POSITION>(e);
+                const position & pos = table.read<position, tags::POSITION>(e);
                 spr = bn::sprite_items::squares.create_sprite(pos.x, pos.y);
                 spr.value().set_tiles(bn::sprite_items::squares.tiles_item(), 1);
                 visible = true;
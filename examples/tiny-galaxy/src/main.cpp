@@ -37,6 +37,11 @@ int main()
     table.add_updater(new tg::u_scenegraph(table));
     table.add_updater(new tg::u_background());
 
+    // the background does not need to move at every frame:
+    // update it every other frame, after the simulation
+    table.set_updater_phase<tg::tags::BACKGROUND>(esa::phase::POST);
+    table.set_updater_rate<tg::tags::BACKGROUND>(2, 1);
+
     // initialize the updaters
     table.init();
 
@@ -59,7 +59,7 @@ void tg::entities::planet(entity_table & table, bn::fixed angle, entity parent,
     table.subscribe(e);
 
     // assign sprite scale based on parent's scale
-    bn::fixed scale = table.get<sprite, tags::SPRITE>(parent).value().vertical_scale();
+    bn::fixed scale = table.read<sprite, tags::SPRITE>(parent).value().vertical_scale();
     table.get<sprite, tags::SPRITE>(e).value().set_scale(scale);
 
     // create a moon for some planets
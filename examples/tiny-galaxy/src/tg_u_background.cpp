@@ -17,7 +17,7 @@ void tg::u_background::init()
 
 void tg::u_background::update()
 {
-    // move the background
-    bg.set_x(bg.x() - 0.025);
-    bg.set_y(bg.y() + 0.05);
+    // move the background (runs every other frame)
+    bg.set_x(bg.x() - 0.05);
+    bg.set_y(bg.y() + 0.1);
 }
\ No newline at end of file
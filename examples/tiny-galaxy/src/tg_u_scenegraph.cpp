@@ -24,9 +24,9 @@ void tg::u_scenegraph::update()
     for (entity e : this->subscribed())
     {
         // entity components
-        position & pos = table.get<position, tags::POSITION>(e);
+        const position & pos = table.read<position, tags::POSITION>(e);
         bn::sprite_ptr & spr = table.get<sprite, tags::SPRITE>(e).value();
-        entity parent = table.get<entity, tags::PARENT>(e);
+        entity parent = table.read<entity, tags::PARENT>(e);
 
         // resolve the scengraph to get the absolute position of each entity
         bn::fixed abs_x = pos.x;
@@ -35,14 +35,14 @@ void tg::u_scenegraph::update()
         while (true)
         {
             // add the parent's relative position
-            position & parent_pos = table.get<position, tags::POSITION>(parent);
+            const position & parent_pos = table.read<position, tags::POSITION>(parent);
             abs_x += parent_pos.x;
             abs_y += parent_pos.y;
 
             // if the parent does not have a parent, break
             if (!table.has<tags::PARENT>(parent))
                 break;
-            parent = table.get<entity, tags::PARENT>(parent);
+            parent = table.read<entity, tags::PARENT>(parent);
             if (!table.has<tags::PARENT>(parent))
                 break;
         }
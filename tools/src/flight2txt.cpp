@@ -0,0 +1,170 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "esa.h"
+
+
+/**
+ * @brief Decodes a flight recorder dump (saved by the dump callback, or found in a GBA save
+ * file or emulator memory dump) into a text report: one line per frame, with the time of
+ * each updater and the structural operations of the frame.
+ * 
+ */
+namespace
+{
+    std::map<esa::tag_t, std::string> names;
+
+    uint32_t word(const unsigned char * p)
+    {
+        uint32_t w;
+        std::memcpy(&w, p, sizeof(w));
+        return w;
+    }
+
+    uint32_t half(const unsigned char * p)
+    {
+        unsigned short h;
+        std::memcpy(&h, p, sizeof(h));
+        return h;
+    }
+
+    /**
+     * @brief Print the report of the dump at `data`, or return false if it is not a valid dump.
+     * 
+     */
+    bool report(std::FILE * out, const unsigned char * data, size_t bytes)
+    {
+        esa::flight_header h;
+        if (bytes < sizeof(h))
+            return false;
+        std::memcpy(&h, data, sizeof(h));
+        if (h.magic != esa::flight_header::MAGIC || h.version != esa::flight_header::VERSION || h.updaters == 0
+            || h.updaters > 65536 || h.used > h.updaters || h.capacity == 0 || h.size > h.capacity || h.next >= h.capacity || h.ticks_per_ms == 0)
+            return false;
+        size_t tags_bytes = sizeof(esa::tag_t) * ((h.updaters + 1) & ~1u);
+        size_t frame_bytes = 24 + 4 * size_t(h.updaters);
+        if (bytes < sizeof(h) + tags_bytes + frame_bytes * h.capacity)
+            return false;
+        const unsigned char * tags = data + sizeof(h);
+        const unsigned char * frames = tags + tags_bytes;
+        double ms = 1.0 / h.ticks_per_ms;
+
+        std::vector<std::string> labels;
+        for (uint32_t u = 0; u < h.updaters; u++)
+        {
+            esa::tag_t tag = esa::tag_t(half(tags + 2 * u));
+            auto it = names.find(tag);
+            labels.push_back(it != names.end() ? it->second : "updater " + std::to_string(tag));
+        }
+
+        std::fprintf(out, "%u frames recorded, triggered at frame %u", h.size, h.trigger_frame);
+        if (h.threshold != 0)
+            std::fprintf(out, " (threshold: %.3f ms)", h.threshold * ms);
+        std::fprintf(out, "\n\n%8s %9s %9s %8s %7s %8s %10s %7s  %s\n", "frame", "ms", "destroy", "entities", "created",
+            "destroyed", "subscribed", "queries", "slowest updater");
+
+        std::vector<double> totals(h.updaters, 0);
+        uint32_t first = h.size < h.capacity ? 0 : h.next;
+        for (uint32_t i = 0; i < h.size; i++)
+        {
+            uint32_t j = (first + i) % h.capacity;
+            const unsigned char * f = frames + frame_bytes * j;
+            uint32_t slowest = 0;
+            for (uint32_t u = 0; u < h.used; u++)
+            {
+                totals[u] += word(f + 24 + 4 * u);
+                if (word(f + 24 + 4 * u) > word(f + 24 + 4 * slowest))
+                    slowest = u;
+            }
+            uint32_t frame = word(f);
+            std::fprintf(out, "%8u %9.3f %9.3f %8u %7u %8u %10u %7u  %s (%.3f ms)%s\n", frame, word(f + 4) * ms,
+                word(f + 8) * ms, half(f + 12), half(f + 14), half(f + 16), half(f + 18), half(f + 20),
+                labels[slowest].c_str(), word(f + 24 + 4 * slowest) * ms, frame == h.trigger_frame ? "  <- trigger" : "");
+        }
+
+        std::fprintf(out, "\nupdaters (average ms per frame):\n");
+        for (uint32_t u = 0; u < h.used; u++)
+            std::fprintf(out, "  %-24s %9.3f\n", labels[u].c_str(), h.size ? totals[u] * ms / h.size : 0.0);
+        return true;
+    }
+
+    int usage()
+    {
+        std::fprintf(stderr, "usage: esa_flight2txt [--offset N] [--name TAG=NAME ...] [--out FILE] DUMP\n");
+        return 1;
+    }
+}
+
+
+int main(int argc, char ** argv)
+{
+    const char * input = nullptr;
+    const char * output = nullptr;
+    long offset = -1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--offset") == 0 && i + 1 < argc)
+            offset = std::strtol(argv[++i], nullptr, 0);
+        else if (std::strcmp(argv[i], "--name") == 0 && i + 1 < argc)
+        {
+            const char * option = argv[++i];
+            const char * equal = std::strchr(option, '=');
+            if (equal == nullptr)
+                return usage();
+            names[esa::tag_t(std::strtoul(option, nullptr, 10))] = equal + 1;
+        }
+        else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            output = argv[++i];
+        else if (input == nullptr && argv[i][0] != '-')
+            input = argv[i];
+        else
+            return usage();
+    }
+    if (input == nullptr)
+        return usage();
+
+    std::FILE * in = std::fopen(input, "rb");
+    if (in == nullptr)
+    {
+        std::fprintf(stderr, "cannot open %s\n", input);
+        return 1;
+    }
+    std::vector<unsigned char> dump;
+    unsigned char chunk[65536];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), in)) > 0)
+        dump.insert(dump.end(), chunk, chunk + read);
+    std::fclose(in);
+
+    std::FILE * out = output != nullptr ? std::fopen(output, "w") : stdout;
+    if (out == nullptr)
+    {
+        std::fprintf(stderr, "cannot open %s\n", output);
+        return 1;
+    }
+
+    // without an explicit offset, look for the first valid dump (dumps are word-aligned)
+    bool found = false;
+    for (size_t at = offset >= 0 ? size_t(offset) : 0; at + sizeof(esa::flight_header) <= dump.size(); at += 4)
+    {
+        if (word(dump.data() + at) == esa::flight_header::MAGIC && report(out, dump.data() + at, dump.size() - at))
+        {
+            found = true;
+            break;
+        }
+        if (offset >= 0)
+            break;
+    }
+    if (output != nullptr)
+        std::fclose(out);
+    if (!found)
+    {
+        std::fprintf(stderr, "no valid flight recorder dump found in %s\n", input);
+        return 1;
+    }
+    return 0;
+}
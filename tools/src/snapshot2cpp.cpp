@@ -0,0 +1,118 @@
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "esa.h"
+
+
+/**
+ * @brief Converts a table snapshot (written on the host with `table.snapshot()`) into a C++ header
+ * holding it as a `const` array, which the GBA linker places in ROM. At level start, the table is
+ * restored from the array with a few copies, instead of being built entity by entity.
+ * 
+ */
+namespace
+{
+    int usage()
+    {
+        std::fprintf(stderr, "usage: esa_snapshot2cpp [--name NAME] [--out FILE] SNAPSHOT\n");
+        return 1;
+    }
+
+    /**
+     * @brief Returns the name of the array for a file: its name without the extension, as an identifier.
+     * 
+     */
+    std::string identifier(const char * path)
+    {
+        const char * slash = std::strrchr(path, '/');
+        std::string name = slash != nullptr ? slash + 1 : path;
+        size_t dot = name.find('.');
+        if (dot != std::string::npos)
+            name.resize(dot);
+        for (char & c : name)
+        {
+            if (!std::isalnum((unsigned char) c))
+                c = '_';
+        }
+        if (name.empty() || std::isdigit((unsigned char) name[0]))
+            name = "image_" + name;
+        return name;
+    }
+}
+
+
+int main(int argc, char ** argv)
+{
+    const char * input = nullptr;
+    const char * output = nullptr;
+    std::string name;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--name") == 0 && i + 1 < argc)
+            name = argv[++i];
+        else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            output = argv[++i];
+        else if (input == nullptr && argv[i][0] != '-')
+            input = argv[i];
+        else
+            return usage();
+    }
+    if (input == nullptr)
+        return usage();
+    if (name.empty())
+        name = identifier(input);
+
+    std::FILE * in = std::fopen(input, "rb");
+    if (in == nullptr)
+    {
+        std::fprintf(stderr, "cannot open %s\n", input);
+        return 1;
+    }
+    std::vector<unsigned char> image;
+    unsigned char chunk[65536];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), in)) > 0)
+        image.insert(image.end(), chunk, chunk + read);
+    std::fclose(in);
+
+    esa::snapshot_header h;
+    uint32_t size = 0;
+    if (image.size() >= sizeof(h) + sizeof(size))
+    {
+        std::memcpy(&h, image.data(), sizeof(h));
+        std::memcpy(&size, image.data() + sizeof(h), sizeof(size));
+    }
+    if (image.size() < sizeof(h) + sizeof(size) || h.magic != esa::snapshot_header::MAGIC
+        || h.version != esa::snapshot_header::VERSION || h.bytes > image.size() || h.columns != 1)
+    {
+        std::fprintf(stderr, "%s is not a table snapshot with columns (version %u)\n", input, esa::snapshot_header::VERSION);
+        return 1;
+    }
+    image.resize(h.bytes);
+
+    std::FILE * out = output != nullptr ? std::fopen(output, "w") : stdout;
+    if (out == nullptr)
+    {
+        std::fprintf(stderr, "cannot open %s\n", output);
+        return 1;
+    }
+
+    std::string guard = name;
+    for (char & c : guard)
+        c = char(std::toupper((unsigned char) c));
+    std::fprintf(out, "// Table image generated by esa_snapshot2cpp: %u entities in a table of %u entities and %u components,\n"
+        "// with %u updaters, %u cached queries and %u cached apply objects. Restore it with `table.restore(%s)`.\n\n",
+        size, h.entities, h.components, h.updaters, h.queries, h.applys, name.c_str());
+    std::fprintf(out, "#ifndef ESA_IMAGE_%s_H\n#define ESA_IMAGE_%s_H\n\n", guard.c_str(), guard.c_str());
+    std::fprintf(out, "alignas(4) inline constexpr unsigned char %s [ %zu ] =\n{", name.c_str(), image.size());
+    for (size_t i = 0; i < image.size(); i++)
+        std::fprintf(out, "%s0x%02x,", i % 16 == 0 ? "\n    " : " ", image[i]);
+    std::fprintf(out, "\n};\n\n#endif\n");
+    if (output != nullptr)
+        std::fclose(out);
+    return 0;
+}
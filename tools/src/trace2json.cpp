@@ -0,0 +1,124 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "esa.h"
+#include "esa_trace_json.h"
+
+
+/**
+ * @brief Converts a raw ESA trace (saved from a host build, or found in a GBA save file
+ * or emulator memory dump) to Chrome trace-event JSON.
+ * 
+ */
+namespace
+{
+    std::map<std::pair<int, esa::tag_t>, std::string> names;
+
+    const char * name(esa::trace_kind kind, esa::tag_t id)
+    {
+        auto it = names.find({ int(kind), id });
+        return it == names.end() ? nullptr : it->second.c_str();
+    }
+
+    bool add_name(const char * option)
+    {
+        // KIND:TAG=NAME, e.g. updater:0=movement
+        static const char * kinds[] = { "updater", "query", "apply" };
+        static const esa::trace_kind values[] = { esa::trace_kind::UPDATER, esa::trace_kind::QUERY, esa::trace_kind::APPLY };
+        const char * colon = std::strchr(option, ':');
+        const char * equal = std::strchr(option, '=');
+        if (colon == nullptr || equal == nullptr || equal < colon)
+            return false;
+        for (int k = 0; k < 3; k++)
+        {
+            if (std::string(option, colon) == kinds[k])
+            {
+                names[{ int(values[k]), esa::tag_t(std::strtoul(colon + 1, nullptr, 10)) }] = equal + 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    int usage()
+    {
+        std::fprintf(stderr, "usage: esa_trace2json [--offset N] [--name KIND:TAG=NAME ...] [--out FILE] DUMP\n"
+            "  KIND is updater, query or apply\n");
+        return 1;
+    }
+}
+
+
+int main(int argc, char ** argv)
+{
+    const char * input = nullptr;
+    const char * output = nullptr;
+    long offset = -1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--offset") == 0 && i + 1 < argc)
+            offset = std::strtol(argv[++i], nullptr, 0);
+        else if (std::strcmp(argv[i], "--name") == 0 && i + 1 < argc)
+        {
+            if (!add_name(argv[++i]))
+                return usage();
+        }
+        else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            output = argv[++i];
+        else if (input == nullptr && argv[i][0] != '-')
+            input = argv[i];
+        else
+            return usage();
+    }
+    if (input == nullptr)
+        return usage();
+
+    std::FILE * in = std::fopen(input, "rb");
+    if (in == nullptr)
+    {
+        std::fprintf(stderr, "cannot open %s\n", input);
+        return 1;
+    }
+    std::vector<unsigned char> dump;
+    unsigned char chunk[65536];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), in)) > 0)
+        dump.insert(dump.end(), chunk, chunk + read);
+    std::fclose(in);
+
+    std::FILE * out = output != nullptr ? std::fopen(output, "w") : stdout;
+    if (out == nullptr)
+    {
+        std::fprintf(stderr, "cannot open %s\n", output);
+        return 1;
+    }
+
+    // without an explicit offset, look for the first valid trace (traces are word-aligned)
+    bool found = false;
+    for (size_t at = offset >= 0 ? size_t(offset) : 0; at + sizeof(esa::trace_header) <= dump.size(); at += 4)
+    {
+        uint32_t magic;
+        std::memcpy(&magic, dump.data() + at, sizeof(magic));
+        if (magic == esa::trace_header::MAGIC
+            && esa::write_trace_json(out, dump.data() + at, dump.size() - at, &name))
+        {
+            std::fprintf(stderr, "trace found at offset 0x%zx\n", at);
+            found = true;
+            break;
+        }
+        if (offset >= 0)
+            break;
+    }
+    if (output != nullptr)
+        std::fclose(out);
+    if (!found)
+    {
+        std::fprintf(stderr, "no valid trace found in %s\n", input);
+        return 1;
+    }
+    return 0;
+}